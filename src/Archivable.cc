@@ -29,146 +29,118 @@ THE SOFTWARE.
 */
 
 #include "Archivable.h"
+#include "SQLiteBackend.h"
 #include <sqlite3/sqlite3.h>
 #include <string>
 #include <vector>
+#include <sstream>
 
 using namespace SubcloneSeeker;
 
 bool Archivable::createTableInDB(sqlite3 *database) {
-	sqlite3_stmt *stmt;
+	SQLiteBackend backend(database);
+	return backend.createTable(tableSchema());
+}
 
-	std::string id_str = "id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT";
-	std::string stmt_str = "CREATE TABLE " + getTableName() + " ( " + id_str + createTableStatementStr() + ");";
+bool Archivable::tableExistsInDB(sqlite3 *database) {
+	SQLiteBackend backend(database);
+	return tableExists(backend);
+}
 
-	int rc = sqlite3_prepare_v2(database, stmt_str.c_str(), -1, &stmt, 0);
-	if(rc != SQLITE_OK) {
-		sqlite3_finalize(stmt);
-		return false;
-	}
+sqlite3_int64 Archivable::archiveObjectToDB(sqlite3 *database) {
+	SQLiteBackend backend(database);
+	return archiveObject(backend);
+}
 
-	rc = sqlite3_step(stmt);
-	sqlite3_finalize(stmt);
+bool Archivable::unarchiveObjectFromDB(sqlite3 *database, sqlite3_int64 id) {
+	SQLiteBackend backend(database);
+	return unarchiveObject(backend, id);
+}
 
-	if(rc != SQLITE_DONE) {
-		return false;
-	}
+std::vector<sqlite3_int64> Archivable::vecAllObjectsID(sqlite3 *database) {
+	SQLiteBackend backend(database);
+	return vecAllObjectsID(backend);
+}
 
-	return true;
+bool Archivable::tableExists(StorageBackend& backend) {
+	return backend.tableExists(tableSchema());
 }
 
-sqlite3_int64 Archivable::archiveObjectToDB(sqlite3 *database) {
-	sqlite3_stmt *statement;
-	int rc;
-	int bind_loc;
+sqlite3_int64 Archivable::archiveObject(StorageBackend& backend) {
+	const TableSchema& schema = tableSchema();
 
 	// check if table exist
-	std::string table_check_str = "SELECT name FROM sqlite_master WHERE type='table' AND name='"+getTableName()+"';";
-	rc = sqlite3_prepare_v2(database, table_check_str.c_str(), -1, &statement, 0);
-	if(rc != SQLITE_OK) {
-		sqlite3_finalize(statement);
-		return -1;
-	}
-	rc = sqlite3_step(statement);
-	sqlite3_finalize(statement);
-	if(rc != SQLITE_ROW) {
+	if(!backend.tableExists(schema)) {
 		// Table does not exist, create table
-		createTableInDB(database);
-	}
-
-	// First, determines if the record already exist
-	std::string select_str = "SELECT id FROM " + getTableName() + " WHERE id=?;";
-	rc = sqlite3_prepare_v2(database, select_str.c_str(), -1, &statement, 0);
-	if(rc != SQLITE_OK) {
-		sqlite3_finalize(statement);
-		return -2;
+		backend.createTable(schema);
 	}
 
-	sqlite3_bind_int64(statement, 1, id);
-	rc = sqlite3_step(statement);
-	sqlite3_finalize(statement);
+	ArchiveRecord record;
+	encodeObject(record);
 
-	if(rc == SQLITE_ROW) {
+	// an object never archived has no id, so there is nothing to look up
+	if(id > 0 && backend.recordExists(schema, id)) {
 		// record exist, update mode
-		rc = sqlite3_prepare_v2(database, updateObjectStatementStr().c_str(), -1, &statement, 0);
-		if(rc != SQLITE_OK) {
-			sqlite3_finalize(statement);
-			return -3;
-		}
-
-		int bind_pos = bindObjectToStatement(statement);
-		sqlite3_bind_int64(statement, bind_pos, id);
-
-		rc = sqlite3_step(statement);
-		sqlite3_finalize(statement);
-		if(rc != SQLITE_DONE) {
+		if(!backend.updateRecord(schema, id, record))
 			return -4;
-		}
-
 		return id;
 	}
 	else {
 		// record does not exist, insert mode
-		rc = sqlite3_prepare_v2(database, createObjectStatementStr().c_str(), -1, &statement, 0);
-		if(rc != SQLITE_OK) {
-			sqlite3_finalize(statement);
-			return -5;
-		}
-		
-		int bind_pos = bindObjectToStatement(statement);
-
-		rc = sqlite3_step(statement);
-		sqlite3_finalize(statement);
-		if(rc != SQLITE_DONE) {
-			return -6;
-		}
-
-		id = sqlite3_last_insert_rowid(database);
+		sqlite3_int64 newID = backend.insertRecord(schema, record);
+		if(newID < 0)
+			return newID;
+		id = newID;
 		return id;
 	}
 }
 
-bool Archivable::unarchiveObjectFromDB(sqlite3 *database, sqlite3_int64 id) {
-	sqlite3_stmt* statement;
-	int rc;
-	std::string select_str = "SELECT " + selectObjectColumnListStr() + " FROM " + getTableName() + " WHERE id=?;";
-	rc = sqlite3_prepare_v2(database, select_str.c_str(), -1, &statement, 0);
-	if(rc != SQLITE_OK) {
-		sqlite3_finalize(statement);
+bool Archivable::unarchiveObject(StorageBackend& backend, sqlite3_int64 id) {
+	ArchiveRecord record;
+	if(!backend.fetchRecord(tableSchema(), id, record))
 		return false;
-	}
-
-	sqlite3_bind_int64(statement, 1, id);
-	rc = sqlite3_step(statement);
-	if(rc != SQLITE_ROW) {
-		sqlite3_finalize(statement);
-		return false;
-	}
 
 	this->id = id;
+	decodeObject(record);
+	return true;
+}
 
-	updateObjectFromStatement(statement);
+DBObjectID_vec Archivable::vecAllObjectsID(StorageBackend& backend) {
+	return backend.allRecordIDs(tableSchema());
+}
 
-	sqlite3_finalize(statement);
-	return true;
+DBObjectID_vec Archivable::recordIDsReferringTo(StorageBackend& backend, const std::string& column, sqlite3_int64 id) {
+	return backend.recordIDsReferringTo(tableSchema(), column, id);
 }
 
-std::vector<sqlite3_int64> Archivable::vecAllObjectsID(sqlite3 *database) {
-	std::string query_str = "SELECT id FROM " + getTableName() + ";";
-	sqlite3_stmt* statement;
-	int rc;
+int Archivable::bindObjectToStatement(sqlite3_stmt *statement, ArchiveRecord& record) {
+	record.clear();
+	encodeObject(record);
+	return record.bindToStatement(statement);
+}
 
-	std::vector<sqlite3_int64> ret;
+void Archivable::updateObjectFromStatement(sqlite3_stmt *statement, int numColumns) {
+	ArchiveRecord record;
+	record.readFromStatement(statement, numColumns);
+	decodeObject(record);
+}
 
-	rc = sqlite3_prepare_v2(database, query_str.c_str(), -1, &statement, 0);
-	if(rc != SQLITE_OK) {
-		sqlite3_finalize(statement);
-		return ret;
-	}
+std::string Archivable::batchSelectStatementStr(const std::string& whereClause, const std::string& orderClause) {
+	const TableSchema& schema = tableSchema();
+	return "SELECT " + schema.selectColumnsSQL + ", id FROM " + schema.name + " WHERE " + whereClause + " ORDER BY " + orderClause + ";";
+}
 
-	while((rc = sqlite3_step(statement)) == SQLITE_ROW) 
-		ret.push_back(sqlite3_column_int64(statement, 0));
+void Archivable::updateObjectFromBatchStatement(sqlite3_stmt *statement) {
+	updateObjectFromStatement(statement, sqlite3_column_count(statement) - 1);
+	id = sqlite3_column_int64(statement, sqlite3_column_count(statement) - 1);
+}
 
-	sqlite3_finalize(statement);
-	return ret;
+std::string Archivable::idListStr(DBObjectID_vec::const_iterator first, DBObjectID_vec::const_iterator last) {
+	std::ostringstream list;
+	for(DBObjectID_vec::const_iterator it = first; it != last; it++) {
+		if(it != first)
+			list<<",";
+		list<<*it;
+	}
+	return list.str();
 }
@@ -33,7 +33,11 @@ THE SOFTWARE.
 
 #include <string>
 #include <vector>
+#include <sstream>
 #include <sqlite3/sqlite3.h>
+#include "ArchiveRecord.h"
+#include "TableSchema.h"
+#include "ObjectArena.h"
 
 
 namespace SubcloneSeeker {
@@ -43,6 +47,10 @@ namespace SubcloneSeeker {
 	 */
 	typedef std::vector<sqlite3_int64> DBObjectID_vec;
 
+	// forward declaration, so that references can be made
+	class StorageBackend;
+	template <class T> class ArchiveCursor;
+
 	/**
 	 * @interface Archivable
 	 * @brief Abstract class that defines the interface to handle archiving objects into sqlite3 database
@@ -59,65 +67,125 @@ namespace SubcloneSeeker {
 	 * unarchiving. This would require that an SERIAL column exists in the table.
 	 */
 	class Archivable {
+		template <class T> friend class ArchiveCursor;
+
 		protected:
 
 			sqlite3_int64 id;  /**< the database identifier for a specific record */
 
 		protected:
 
+			/**
+			 * Describe the table in which all objects of a specific class are stored
+			 *
+			 * Implementations build the schema once, from a static ArchiveField array,
+			 * and return the same instance on every call:
+			 *
+			 *     static const ArchiveField Fields[] = {{"fraction", "REAL NOT NULL", false}, ...};
+			 *     static const TableSchema schema("Clusters", Fields);
+			 *     return schema;
+			 *
+			 * @return the table schema
+			 */
+			virtual const TableSchema& tableSchema() = 0;
+
 			/**
 			 * returns the name of the table in which all object of a specific class are stored
 			 * @return Table name
 			 */
-			virtual std::string getTableName() = 0;
+			inline const std::string& getTableName() {return tableSchema().name;}
 
 			/**
-			 * return the table definition when creating the table in a sqlite3 database
+			 * Encode archivable properties into a storage neutral record
 			 *
-			 * Imagine a generic SQL create statement: CREATE TABLE <tableName> (id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT <other-columns>);
-			 * Notice that the returned string must be prefixed with a comma ",", to separate any custom columns from the id column
+			 * The fields must be appended in the order of the columns of tableSchema,
+			 * which is also the order of the parameters of the insert and update statements
 			 *
-			 * @return The extra column definitions, prefixed with ","
+			 * @param record An empty record to be filled
 			 */
-			virtual std::string createTableStatementStr() = 0;
+			virtual void encodeObject(ArchiveRecord& record) = 0;
 
 			/**
-			 * return the unbound statement for record creation
-			 * @return unbound statement for record creation
+			 * Populate archivable properties from a record during unarchiving
+			 *
+			 * @param record A record holding the columns of tableSchema, in order
 			 */
-			virtual std::string createObjectStatementStr() = 0;
+			virtual void decodeObject(const ArchiveRecord& record) = 0;
 
 			/**
-			 * return the unbound statement for record update
-			 * @return unbound statement for record update
+			 * Bind archivable properties to a prepared, unbound sqlite3 statement
+			 *
+			 * @param statement A prepared, unbound sqlite3 statement instance
+			 * @param record Receives the encoded properties, which must stay alive until the statement is stepped
+			 * @return How many parameters are bound to the statement + 1
 			 */
-			virtual std::string updateObjectStatementStr() = 0;
+			int bindObjectToStatement(sqlite3_stmt *statement, ArchiveRecord& record);
 
 			/**
-			 * return the list of columns to be used in select statement 
-			 * for getting data from the database
-			 *
-			 * Imagine the generic SQL select statement: SELECT <col1>, <col2>, ... FROM <tableName> WHERE id=?;
-			 * The method should return the <col1>,<col2>,... part
+			 * Populate archivable properties from a prepared statement during unarchiving
 			 *
-			 * @return the list of columns as string
+			 * @param statement A prepared statement contains the retrieved row
+			 * @param numColumns The number of leading columns holding the properties
 			 */
-			virtual std::string selectObjectColumnListStr() = 0;
+			void updateObjectFromStatement(sqlite3_stmt *statement, int numColumns);
 
 			/**
-			 * Bind archivable properties to a prepared, unbound sqlite3 statement
+			 * return the select statement used by batch unarchiving
 			 *
-			 * @param statement A prepared, unbound sqlite3 statement instance
-			 * @return How many parameters are bound to the statement + 1
+			 * The statement has the form: SELECT <col1>, <col2>, ..., id FROM <tableName> WHERE <whereClause> ORDER BY <orderClause>;
+			 * The id column is placed last, so that updateObjectFromStatement can be reused unchanged
+			 *
+			 * @param whereClause The condition selecting the records to be unarchived
+			 * @param orderClause The ordering of the returned records
+			 * @return the select statement as string
 			 */
-			virtual int bindObjectToStatement(sqlite3_stmt *statement) = 0;
+			std::string batchSelectStatementStr(const std::string& whereClause, const std::string& orderClause = "id");
 
 			/**
-			 * Populate archivable properties from a prepared statement during unarchiving
+			 * Populate archivable properties, including the id, from a row returned
+			 * by a statement built with batchSelectStatementStr
 			 *
 			 * @param statement A prepared statement contains the retrieved row
 			 */
-			virtual void updateObjectFromStatement(sqlite3_stmt *statement) = 0;
+			void updateObjectFromBatchStatement(sqlite3_stmt *statement);
+
+			/**
+			 * Build a comma separated list of ids, suitable for an IN (...) clause
+			 *
+			 * @param first The first id to be included
+			 * @param last One past the last id to be included
+			 * @return the id list as string
+			 */
+			static std::string idListStr(DBObjectID_vec::const_iterator first, DBObjectID_vec::const_iterator last);
+
+			/**
+			 * Unarchive all records of class T matching a given condition with a single query
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @param whereClause The condition selecting the records to be unarchived
+			 * @param result The vector to which the newly allocated objects are appended
+			 * @param orderClause The ordering of the appended objects, by id if not given
+			 * @param arena The arena the objects are made in, NULL to allocate them on the heap
+			 * @return Whether the query is successful or not
+			 */
+			template <class T>
+			static bool unarchiveObjectsFromDBWhere(sqlite3 *database, const std::string& whereClause, std::vector<T *>& result, const std::string& orderClause = "id", ObjectArena *arena = NULL);
+
+			/**
+			 * Query a backend for the records of the current object's class referring to another record
+			 *
+			 * @param backend The storage backend
+			 * @param column The column holding the reference
+			 * @param id The referred id; 0 selects the records referring to nothing
+			 * @return the ids of the referring records, in increasing order
+			 */
+			DBObjectID_vec recordIDsReferringTo(StorageBackend& backend, const std::string& column, sqlite3_int64 id);
+
+		public:
+			/**
+			 * The maximum number of ids put into the IN (...) list of a single batch query
+			 */
+			static const size_t BatchSize = 500;
 
 		public:
 			/**
@@ -125,6 +193,12 @@ namespace SubcloneSeeker {
 			 */
 			Archivable() : id(0) {;}
 
+			/**
+			 * Virtual destructor, so that objects can be deleted through any of their
+			 * archivable bases, e.g. events through SomaticEvent pointers
+			 */
+			virtual ~Archivable() {}
+
 			/**
 			 * get access function of id
 			 * @return the database identifier of the object
@@ -145,6 +219,13 @@ namespace SubcloneSeeker {
 			 */
 			bool createTableInDB(sqlite3 *database);
 
+			/**
+			 * Check whether the storage table exists in the database
+			 * @param database An open sqlite3 database connection handle
+			 * @return Whether the table exists or not
+			 */
+			bool tableExistsInDB(sqlite3 *database);
+
 			/**
 			 * Archive the object into the database
 			 * @param database An open sqlite3 database connection handle
@@ -163,11 +244,241 @@ namespace SubcloneSeeker {
 			/**
 			 * Return a std::vector of all ids of records of the current object's class
 			 *
+			 * To visit every object of a large table, an ArchiveCursor streams the
+			 * objects themselves with a single query instead.
+			 *
 			 * @return A vector of sqlite3_int64, describing all records with the same class
 			 */
 			DBObjectID_vec vecAllObjectsID(sqlite3 *database);
 
+			/**
+			 * Check whether the storage table exists in a backend
+			 * @param backend The storage backend
+			 * @return Whether the table exists or not
+			 */
+			bool tableExists(StorageBackend& backend);
+
+			/**
+			 * Archive the object into a backend, creating the table if needed
+			 *
+			 * An object with an id already present in the backend is updated, otherwise
+			 * it is inserted and given a new id
+			 *
+			 * @param backend The storage backend
+			 * @return The id of the archived object, if successful; or a negative number if error occurred
+			 */
+			sqlite3_int64 archiveObject(StorageBackend& backend);
+
+			/**
+			 * Unarchive an object from a backend
+			 * @param backend The storage backend
+			 * @param id The identifier with which the correct record is to be found
+			 * @return Whether the operation is successful or not
+			 */
+			bool unarchiveObject(StorageBackend& backend, sqlite3_int64 id);
+
+			/**
+			 * Return a std::vector of all ids of records of the current object's class in a backend
+			 *
+			 * @param backend The storage backend
+			 * @return A vector of sqlite3_int64, describing all records with the same class
+			 */
+			DBObjectID_vec vecAllObjectsID(StorageBackend& backend);
+
+			/**
+			 * Unarchive many objects of class T with as few queries as possible
+			 *
+			 * The ids are sent to the database in batches of BatchSize through an
+			 * IN (...) list, instead of one query per object. Ids not found in the
+			 * database are silently skipped.
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @param ids The identifiers of the records to be unarchived
+			 * @param arena The arena the objects are made in, NULL to allocate them on the heap
+			 * @return A vector of newly allocated objects, ordered by id
+			 */
+			template <class T>
+			static std::vector<T *> unarchiveObjectsFromDB(sqlite3 *database, const DBObjectID_vec& ids, ObjectArena *arena = NULL);
+
+			/**
+			 * Unarchive all objects of class T whose ids fall into a given range, with a single query
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @param firstID The smallest id to be unarchived
+			 * @param lastID The largest id to be unarchived
+			 * @return A vector of newly allocated objects, ordered by id
+			 */
+			template <class T>
+			static std::vector<T *> unarchiveObjectsFromDB(sqlite3 *database, sqlite3_int64 firstID, sqlite3_int64 lastID);
+
+			/**
+			 * Find the objects of class T referring to another record in a backend
+			 *
+			 * @param backend The storage backend
+			 * @param column The column of T's table holding the reference, e.g. "ofClusterID"
+			 * @param id The referred id; 0 selects the objects referring to nothing
+			 * @return the ids of the referring objects, in increasing order
+			 */
+			template <class T>
+			static DBObjectID_vec objectIDsReferringTo(StorageBackend& backend, const std::string& column, sqlite3_int64 id);
+
+			/**
+			 * Unarchive the objects of class T referring to another record in a backend
+			 *
+			 * @param backend The storage backend
+			 * @param column The column of T's table holding the reference, e.g. "ofClusterID"
+			 * @param id The referred id; 0 selects the objects referring to nothing
+			 * @param arena The arena the objects are made in, NULL to allocate them on the heap
+			 * @return A vector of newly allocated objects, ordered by id
+			 */
+			template <class T>
+			static std::vector<T *> unarchiveObjectsReferringTo(StorageBackend& backend, const std::string& column, sqlite3_int64 id, ObjectArena *arena = NULL);
+
 	};
+
+	/**
+	 * @brief Streams the archived objects of class T out of a single open statement
+	 *
+	 * Instead of collecting all ids first and unarchiving each object with its own
+	 * query, a cursor steps through one SELECT and materializes one object per row,
+	 * so that only the objects the caller keeps are held in memory:
+	 *
+	 *     ArchiveCursor<Subclone> cursor(database, "parentId IS NULL");
+	 *     for(Subclone *root = cursor.next(); root != NULL; root = cursor.next()) {...}
+	 *
+	 * Other statements may be run on the same connection while the cursor is open.
+	 */
+	template <class T>
+	class ArchiveCursor {
+		protected:
+			sqlite3_stmt *_statement; /**< the open select statement, NULL if it could not be prepared */
+			int _rc; /**< the result of the last prepare or step */
+
+		public:
+			/**
+			 * Open a cursor
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @param whereClause The condition selecting the records, all of them by default
+			 * @param orderClause The ordering of the records, by id by default
+			 */
+			ArchiveCursor(sqlite3 *database, const std::string& whereClause = "1", const std::string& orderClause = "id") {
+				T prototype;
+				Archivable *archivablePrototype = &prototype;
+				std::string select_str = archivablePrototype->batchSelectStatementStr(whereClause, orderClause);
+
+				_rc = sqlite3_prepare_v2(database, select_str.c_str(), -1, &_statement, 0);
+				if(_rc != SQLITE_OK) {
+					sqlite3_finalize(_statement);
+					_statement = NULL;
+				}
+			}
+
+			/**
+			 * Close the cursor
+			 */
+			~ArchiveCursor() {
+				sqlite3_finalize(_statement);
+			}
+
+			/**
+			 * Read the next record into an existing object
+			 *
+			 * @param object The object to be populated, including its id
+			 * @return false once all records have been read, or on error
+			 */
+			bool next(T& object) {
+				if(_statement == NULL || _rc == SQLITE_DONE)
+					return false;
+
+				_rc = sqlite3_step(_statement);
+				if(_rc != SQLITE_ROW)
+					return false;
+
+				Archivable *archivableObject = &object;
+				archivableObject->updateObjectFromBatchStatement(_statement);
+				return true;
+			}
+
+			/**
+			 * Read the next record into a new object
+			 *
+			 * @param arena The arena the object is made in, NULL to allocate it on the heap
+			 * @return a newly allocated object, NULL once all records have been read, or on error
+			 */
+			T *next(ObjectArena *arena = NULL) {
+				if(_statement == NULL || _rc == SQLITE_DONE)
+					return NULL;
+
+				// step first, so that no object is made past the last record
+				_rc = sqlite3_step(_statement);
+				if(_rc != SQLITE_ROW)
+					return NULL;
+
+				T *newObject = ObjectArena::create<T>(arena);
+				Archivable *archivableObject = newObject;
+				archivableObject->updateObjectFromBatchStatement(_statement);
+				return newObject;
+			}
+
+			/**
+			 * Whether the statement could not be prepared, or a step failed
+			 *
+			 * @return false as long as the records are read without error
+			 */
+			inline bool failed() const {return _rc != SQLITE_OK && _rc != SQLITE_ROW && _rc != SQLITE_DONE;}
+	};
+
+	template <class T>
+	bool Archivable::unarchiveObjectsFromDBWhere(sqlite3 *database, const std::string& whereClause, std::vector<T *>& result, const std::string& orderClause, ObjectArena *arena) {
+		ArchiveCursor<T> cursor(database, whereClause, orderClause);
+		for(T *newObject = cursor.next(arena); newObject != NULL; newObject = cursor.next(arena))
+			result.push_back(newObject);
+		return !cursor.failed();
+	}
+
+	template <class T>
+	std::vector<T *> Archivable::unarchiveObjectsFromDB(sqlite3 *database, const DBObjectID_vec& ids, ObjectArena *arena) {
+		std::vector<T *> result;
+		for(size_t offset = 0; offset < ids.size(); offset += BatchSize) {
+			size_t end = offset + BatchSize < ids.size() ? offset + BatchSize : ids.size();
+			std::string whereClause = "id IN (" + idListStr(ids.begin() + offset, ids.begin() + end) + ")";
+			if(!unarchiveObjectsFromDBWhere(database, whereClause, result, "id", arena))
+				break;
+		}
+		return result;
+	}
+
+	template <class T>
+	std::vector<T *> Archivable::unarchiveObjectsFromDB(sqlite3 *database, sqlite3_int64 firstID, sqlite3_int64 lastID) {
+		std::vector<T *> result;
+		std::ostringstream whereClause;
+		whereClause<<"id BETWEEN "<<firstID<<" AND "<<lastID;
+		unarchiveObjectsFromDBWhere(database, whereClause.str(), result);
+		return result;
+	}
+
+	template <class T>
+	DBObjectID_vec Archivable::objectIDsReferringTo(StorageBackend& backend, const std::string& column, sqlite3_int64 id) {
+		T prototype;
+		Archivable *archivablePrototype = &prototype;
+		return archivablePrototype->recordIDsReferringTo(backend, column, id);
+	}
+
+	template <class T>
+	std::vector<T *> Archivable::unarchiveObjectsReferringTo(StorageBackend& backend, const std::string& column, sqlite3_int64 id, ObjectArena *arena) {
+		std::vector<T *> result;
+		DBObjectID_vec ids = objectIDsReferringTo<T>(backend, column, id);
+		for(size_t i=0; i<ids.size(); i++) {
+			T *newObject = ObjectArena::create<T>(arena);
+			Archivable *archivableObject = newObject;
+			if(archivableObject->unarchiveObject(backend, ids[i]))
+				result.push_back(newObject);
+			else if(arena == NULL)
+				delete newObject;
+		}
+		return result;
+	}
 }
 
 #endif
@@ -0,0 +1,135 @@
+/**
+ * @file ArchiveRecord.cc
+ * Implementation of class ArchiveRecord
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "ArchiveRecord.h"
+
+using namespace SubcloneSeeker;
+
+void ArchiveRecord::appendNull() {
+	_values.push_back(ArchiveValue());
+}
+
+void ArchiveRecord::appendInteger(sqlite3_int64 value) {
+	_values.push_back(ArchiveValue());
+	_values.back().type = ArchiveValue::TYPE_INTEGER;
+	_values.back().integer = value;
+}
+
+void ArchiveRecord::appendReal(double value) {
+	_values.push_back(ArchiveValue());
+	_values.back().type = ArchiveValue::TYPE_REAL;
+	_values.back().real = value;
+}
+
+void ArchiveRecord::appendBlob(const void *data, size_t bytes) {
+	_values.push_back(ArchiveValue());
+	_values.back().type = ArchiveValue::TYPE_BLOB;
+	if(bytes > 0)
+		_values.back().blob.assign((const char *)data, bytes);
+}
+
+void ArchiveRecord::appendValue(const ArchiveValue& value) {
+	_values.push_back(value);
+}
+
+sqlite3_int64 ArchiveRecord::integerAt(size_t pos) const {
+	if(isNullAt(pos))
+		return 0;
+	if(_values[pos].type == ArchiveValue::TYPE_REAL)
+		return (sqlite3_int64)_values[pos].real;
+	return _values[pos].integer;
+}
+
+double ArchiveRecord::realAt(size_t pos) const {
+	if(isNullAt(pos))
+		return 0;
+	if(_values[pos].type == ArchiveValue::TYPE_INTEGER)
+		return (double)_values[pos].integer;
+	return _values[pos].real;
+}
+
+const std::string& ArchiveRecord::blobAt(size_t pos) const {
+	static const std::string empty;
+	if(pos >= _values.size() || _values[pos].type != ArchiveValue::TYPE_BLOB)
+		return empty;
+	return _values[pos].blob;
+}
+
+int ArchiveRecord::bindToStatement(sqlite3_stmt *statement) const {
+	int bind_loc = 1;
+	for(size_t i=0; i<_values.size(); i++, bind_loc++) {
+		const ArchiveValue& value = _values[i];
+		switch(value.type) {
+			case ArchiveValue::TYPE_INTEGER:
+				sqlite3_bind_int64(statement, bind_loc, value.integer);
+				break;
+			case ArchiveValue::TYPE_REAL:
+				sqlite3_bind_double(statement, bind_loc, value.real);
+				break;
+			case ArchiveValue::TYPE_BLOB:
+				if(value.blob.size() > 0)
+					sqlite3_bind_blob(statement, bind_loc, value.blob.data(), value.blob.size(), SQLITE_STATIC);
+				else
+					sqlite3_bind_zeroblob(statement, bind_loc, 0);
+				break;
+			default:
+				sqlite3_bind_null(statement, bind_loc);
+				break;
+		}
+	}
+	return bind_loc;
+}
+
+void ArchiveRecord::readFromStatement(sqlite3_stmt *statement, int numColumns) {
+	_values.resize(numColumns);
+	for(int col=0; col<numColumns; col++) {
+		ArchiveValue& value = _values[col];
+		value = ArchiveValue();
+		switch(sqlite3_column_type(statement, col)) {
+			case SQLITE_INTEGER:
+				value.type = ArchiveValue::TYPE_INTEGER;
+				value.integer = sqlite3_column_int64(statement, col);
+				break;
+			case SQLITE_FLOAT:
+				value.type = ArchiveValue::TYPE_REAL;
+				value.real = sqlite3_column_double(statement, col);
+				break;
+			case SQLITE_BLOB:
+			case SQLITE_TEXT:
+				value.type = ArchiveValue::TYPE_BLOB;
+				if(sqlite3_column_bytes(statement, col) > 0)
+					value.blob.assign((const char *)sqlite3_column_blob(statement, col), sqlite3_column_bytes(statement, col));
+				break;
+			default:
+				value.type = ArchiveValue::TYPE_NULL;
+				break;
+		}
+	}
+}
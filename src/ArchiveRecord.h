@@ -0,0 +1,135 @@
+#ifndef ARCHIVE_RECORD_H
+#define ARCHIVE_RECORD_H
+
+/**
+ * @file ArchiveRecord.h
+ * Interface description of the storage neutral record ArchiveRecord
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <sqlite3/sqlite3.h>
+#include <string>
+#include <vector>
+#include <cstring>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @brief A single field of an ArchiveRecord
+	 */
+	struct ArchiveValue {
+		/** The storage class of a value, mirroring the sqlite3 ones that are used */
+		enum Type {
+			TYPE_NULL = 0,
+			TYPE_INTEGER,
+			TYPE_REAL,
+			TYPE_BLOB
+		};
+
+		Type type; /**< which of the members below holds the value */
+		sqlite3_int64 integer; /**< value of an integer field */
+		double real; /**< value of a real field */
+		std::string blob; /**< bytes of a blob field */
+
+		ArchiveValue() : type(TYPE_NULL), integer(0), real(0) {;}
+	};
+
+	/**
+	 * @brief The fields of an archived object, in column order, independent of any storage
+	 *
+	 * Archivable objects encode themselves into a record, and decode themselves from
+	 * one; a StorageBackend then stores the record. The accessors convert between
+	 * integer and real values the way sqlite3 does, and read a NULL as 0.
+	 */
+	class ArchiveRecord {
+		protected:
+			std::vector<ArchiveValue> _values; /**< the fields */
+
+		public:
+			inline void clear() {_values.clear();} /**< remove all fields */
+			inline size_t size() const {return _values.size();} /**< number of fields */
+			inline const ArchiveValue& operator[](size_t pos) const {return _values[pos];} /**< field at a position */
+
+			void appendNull(); /**< append a NULL field */
+			void appendInteger(sqlite3_int64 value); /**< append an integer field */
+			void appendReal(double value); /**< append a real field */
+			void appendBlob(const void *data, size_t bytes); /**< append a blob field */
+			void appendValue(const ArchiveValue& value); /**< append a field of any type */
+
+			/**
+			 * Append a reference to another record, stored as NULL if not set
+			 *
+			 * @param id The database id of the referred record, 0 or less if none
+			 */
+			inline void appendIDOrNull(sqlite3_int64 id) {if(id > 0) appendInteger(id); else appendNull();}
+
+			/**
+			 * Append a vector of fixed width elements as a blob, in host byte order
+			 *
+			 * @param vec The elements to be stored
+			 */
+			template <class T>
+			inline void appendVector(const std::vector<T>& vec) {appendBlob(vec.size() > 0 ? &vec[0] : NULL, vec.size() * sizeof(T));}
+
+			inline bool isNullAt(size_t pos) const {return pos >= _values.size() || _values[pos].type == ArchiveValue::TYPE_NULL;} /**< whether a field is NULL or missing */
+			sqlite3_int64 integerAt(size_t pos) const; /**< a field as integer */
+			double realAt(size_t pos) const; /**< a field as real */
+			const std::string& blobAt(size_t pos) const; /**< the bytes of a blob field, empty for other types */
+
+			/**
+			 * Copy a blob field appended by appendVector back into a vector
+			 *
+			 * @param pos The position of the field
+			 * @param vec Receives the elements, replacing its content
+			 */
+			template <class T>
+			inline void vectorAt(size_t pos, std::vector<T>& vec) const {
+				const std::string& blob = blobAt(pos);
+				vec.resize(blob.size() / sizeof(T));
+				if(vec.size() > 0)
+					memcpy(&vec[0], blob.data(), vec.size() * sizeof(T));
+			}
+
+			/**
+			 * Bind all fields to a prepared statement, starting at parameter 1
+			 *
+			 * @param statement A prepared, unbound sqlite3 statement
+			 * @return the position of the next unbound parameter
+			 */
+			int bindToStatement(sqlite3_stmt *statement) const;
+
+			/**
+			 * Replace the fields by the columns of the current row of a statement
+			 *
+			 * @param statement A statement that has just returned a row
+			 * @param numColumns The number of leading columns to be read
+			 */
+			void readFromStatement(sqlite3_stmt *statement, int numColumns);
+	};
+}
+
+#endif
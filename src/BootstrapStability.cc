@@ -0,0 +1,176 @@
+/**
+ * @file BootstrapStability.cc
+ * Implementation of the helper class BootstrapStability
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "BootstrapStability.h"
+#include "SomaticEvent.h"
+#include "SegmentalMutation.h"
+#include "Dendrogram.h"
+#include "EventVisitor.h"
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+
+using namespace SubcloneSeeker;
+
+BootstrapStability::BootstrapStability(const std::vector<EventCluster *>& clusters, double threshold, EventCluster::ClusteringEngine engine):
+	_numClusters(clusters.size()), _threshold(threshold), _clusterCount(0), _engine(engine), _resampling(RESAMPLE_EVENTS),
+	_noise(0), _threads(0), _seed(0), _replicates(0),
+	_together(clusters.size() * clusters.size(), 0), _pairs(clusters.size() * clusters.size(), 0) {
+	for(size_t i=0; i<clusters.size(); i++) {
+		for(EventCluster::member_iterator it = clusters[i]->beginMembers(); it != clusters[i]->endMembers(); it++) {
+			_frequencies.push_back((*it)->frequency);
+			_weights.push_back(eventWeight(*it));
+			_reference.push_back(i);
+		}
+	}
+}
+
+/**
+ * @brief What each worker thread allocates once and reuses from replicate to replicate
+ */
+struct BootstrapScratch {
+	std::vector<CNV> events; /**< the replicate; only frequency and length are set */
+	std::vector<SomaticEvent *> pointers; /**< pointers to the events above */
+	std::vector<size_t> origins; /**< the event each replicate event was drawn from */
+	std::vector<int> labels; /**< the replicate cluster of each event, -1 if not drawn */
+	std::vector<uint64_t> counts; /**< events of each (reference, replicate) cluster pair */
+	std::vector<uint64_t> together; /**< the thread's share of BootstrapStability::_together */
+	std::vector<uint64_t> pairs; /**< the thread's share of BootstrapStability::_pairs */
+};
+
+void BootstrapStability::run(size_t replicates) {
+	size_t n = _frequencies.size();
+	size_t k = _numClusters;
+	if(n == 0 || replicates == 0)
+		return;
+
+	size_t numThreads = _threads > 0 ? _threads : std::thread::hardware_concurrency();
+	numThreads = std::max((size_t)1, std::min(numThreads, replicates));
+	std::vector<BootstrapScratch> scratches(numThreads);
+
+	std::atomic<size_t> nextReplicate(0);
+	auto worker = [&](BootstrapScratch *scratch) {
+		scratch->events.resize(n);
+		scratch->pointers.resize(n);
+		scratch->origins.resize(n);
+		scratch->labels.resize(n);
+		scratch->together.assign(k * k, 0);
+		scratch->pairs.assign(k * k, 0);
+		for(size_t i=0; i<n; i++)
+			scratch->pointers[i] = &scratch->events[i];
+		Dendrogram dendrogram;
+
+		for(size_t replicate = nextReplicate++; replicate < replicates; replicate = nextReplicate++) {
+			std::mt19937 generator(_seed + _replicates + replicate);
+			std::uniform_int_distribution<size_t> draw(0, n - 1);
+			std::normal_distribution<double> noise(0, _noise > 0 ? _noise : 1);
+
+			for(size_t i=0; i<n; i++) {
+				size_t origin = _resampling == RESAMPLE_EVENTS ? draw(generator) : i;
+				CNV& event = scratch->events[i];
+				event.frequency = _frequencies[origin];
+				if(_resampling == PERTURB_FREQUENCIES && _noise > 0)
+					event.frequency += noise(generator);
+				event.range.length = (unsigned long)_weights[origin];
+				scratch->origins[i] = origin;
+			}
+
+			std::vector<EventCluster *> clusters;
+			if(_clusterCount > 0) {
+				dendrogram.build(scratch->pointers);
+				clusters = dendrogram.cutToCount(_clusterCount);
+			}
+			else
+				clusters = EventCluster::clustering(scratch->pointers, _threshold, _engine);
+
+			// an event drawn more than once keeps the cluster of its first draw
+			std::fill(scratch->labels.begin(), scratch->labels.end(), -1);
+			for(size_t c=0; c<clusters.size(); c++) {
+				for(EventCluster::member_iterator it = clusters[c]->beginMembers(); it != clusters[c]->endMembers(); it++) {
+					size_t origin = scratch->origins[static_cast<CNV *>(*it) - &scratch->events[0]];
+					if(scratch->labels[origin] < 0)
+						scratch->labels[origin] = c;
+				}
+				delete clusters[c];
+			}
+
+			// with m events of reference cluster a in replicate cluster c, the ordered
+			// pairs of distinct events of a and b clustered together sum up m(a,c) * m(b,c)
+			size_t numReplicateClusters = clusters.size();
+			scratch->counts.assign(k * numReplicateClusters, 0);
+			std::vector<uint64_t> present(k, 0);
+			for(size_t i=0; i<n; i++) {
+				if(scratch->labels[i] < 0)
+					continue;
+				scratch->counts[_reference[i] * numReplicateClusters + scratch->labels[i]]++;
+				present[_reference[i]]++;
+			}
+
+			for(size_t a=0; a<k; a++) {
+				for(size_t b=0; b<k; b++) {
+					uint64_t together = 0;
+					for(size_t c=0; c<numReplicateClusters; c++) {
+						uint64_t ma = scratch->counts[a * numReplicateClusters + c];
+						uint64_t mb = scratch->counts[b * numReplicateClusters + c];
+						together += a == b ? (ma > 0 ? ma * (ma - 1) : 0) : ma * mb;
+					}
+					scratch->together[a * k + b] += together;
+					scratch->pairs[a * k + b] += a == b ? (present[a] > 0 ? present[a] * (present[a] - 1) : 0) : present[a] * present[b];
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for(size_t t=1; t<numThreads; t++)
+		threads.push_back(std::thread(worker, &scratches[t]));
+	worker(&scratches[0]);
+	for(size_t t=0; t<threads.size(); t++)
+		threads[t].join();
+
+	for(size_t t=0; t<numThreads; t++) {
+		for(size_t i=0; i<k * k; i++) {
+			_together[i] += scratches[t].together[i];
+			_pairs[i] += scratches[t].pairs[i];
+		}
+	}
+	_replicates += replicates;
+}
+
+double BootstrapStability::coClustering(size_t a, size_t b) const {
+	if(a >= _numClusters || b >= _numClusters)
+		return 0;
+
+	size_t pos = a * _numClusters + b;
+	if(_pairs[pos] == 0)
+		return a == b ? 1 : 0;
+	return (double)_together[pos] / _pairs[pos];
+}
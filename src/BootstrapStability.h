@@ -0,0 +1,163 @@
+#ifndef BOOTSTRAP_STABILITY_H
+#define BOOTSTRAP_STABILITY_H
+
+/**
+ * @file BootstrapStability.h
+ * Interface description of the helper class BootstrapStability
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "EventCluster.h"
+#include <vector>
+#include <stdint.h>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @brief Bootstrap estimate of how well supported a clustering of events is
+	 *
+	 * The events of a reference clustering are clustered again, many times, after
+	 * either resampling them with replacement or adding gaussian noise to their
+	 * frequencies. For every two reference clusters a and b, the co-clustering
+	 * rate is the share of (event of a, event of b) pairs that land in the same
+	 * cluster, over all replicates; the support of a cluster is its rate with
+	 * itself, i.e. how often its members stay together.
+	 *
+	 * Only the frequency and the weight (segment length, or 1) of an event matter
+	 * to the clustering engines, so the replicates are built into per-thread
+	 * scratch events, allocated once, and the reference events are never modified.
+	 * Each replicate is seeded from its number only, so the result does not depend
+	 * on the number of threads.
+	 */
+	class BootstrapStability {
+		public:
+			/** How a replicate is drawn from the events */
+			enum Resampling {
+				RESAMPLE_EVENTS = 0, /**< draw as many events, with replacement */
+				PERTURB_FREQUENCIES /**< keep every event, adding noise to its frequency */
+			};
+
+		protected:
+			std::vector<double> _frequencies; /**< the frequency of each event */
+			std::vector<double> _weights; /**< the weight of each event */
+			std::vector<size_t> _reference; /**< the reference cluster of each event */
+			size_t _numClusters; /**< number of reference clusters */
+
+			double _threshold; /**< the clustering threshold */
+			size_t _clusterCount; /**< the number of clusters to cut each replicate into, 0 to cut at the threshold */
+			EventCluster::ClusteringEngine _engine; /**< the clustering engine */
+			Resampling _resampling; /**< how replicates are drawn */
+			double _noise; /**< standard deviation of the noise added by PERTURB_FREQUENCIES */
+			size_t _threads; /**< number of worker threads, 0 for one per core */
+			uint32_t _seed; /**< seed of the first replicate */
+
+			size_t _replicates; /**< number of replicates run */
+			std::vector<uint64_t> _together; /**< per pair of reference clusters, event pairs clustered together */
+			std::vector<uint64_t> _pairs; /**< per pair of reference clusters, event pairs present in a replicate */
+
+		public:
+			/**
+			 * Constructor
+			 *
+			 * @param clusters The reference clusters; their members are the events resampled
+			 * @param threshold The threshold to cluster the replicates with
+			 * @param engine The engine to cluster the replicates with
+			 */
+			BootstrapStability(const std::vector<EventCluster *>& clusters, double threshold,
+					EventCluster::ClusteringEngine engine = EventCluster::CLUSTERING_GREEDY);
+
+			/**
+			 * Choose how replicates are drawn
+			 *
+			 * @param resampling The resampling scheme
+			 * @param noise The standard deviation of the frequency noise, for PERTURB_FREQUENCIES
+			 */
+			inline void setResampling(Resampling resampling, double noise = 0) {_resampling = resampling; _noise = noise;}
+
+			/**
+			 * Cut each replicate into a number of clusters, as Dendrogram::cutToCount
+			 * does, instead of clustering it at the threshold with the engine
+			 *
+			 * @param count The number of clusters, 0 (the default) to cluster at the threshold
+			 */
+			inline void setClusterCount(size_t count) {_clusterCount = count;}
+
+			/**
+			 * Set the number of worker threads
+			 *
+			 * @param threads The number of threads, 0 (the default) for one per core
+			 */
+			inline void setThreads(size_t threads) {_threads = threads;}
+
+			/**
+			 * Set the seed of the replicates
+			 *
+			 * @param seed The seed of the first replicate; replicate i uses seed + i
+			 */
+			inline void setSeed(uint32_t seed) {_seed = seed;}
+
+			/**
+			 * Cluster replicates, adding to the counts of previous runs
+			 *
+			 * @param replicates The number of replicates
+			 */
+			void run(size_t replicates);
+
+			/**
+			 * The number of reference clusters
+			 *
+			 * @return the cluster count
+			 */
+			inline size_t clusterCount() const {return _numClusters;}
+
+			/**
+			 * The number of replicates run so far
+			 *
+			 * @return the replicate count
+			 */
+			inline size_t replicates() const {return _replicates;}
+
+			/**
+			 * The share of event pairs of two reference clusters clustered together
+			 *
+			 * @param a The index of a reference cluster
+			 * @param b The index of another, or the same, reference cluster
+			 * @return the co-clustering rate, 1 for a cluster with itself if it never had two events
+			 */
+			double coClustering(size_t a, size_t b) const;
+
+			/**
+			 * The support of a reference cluster, i.e. its co-clustering rate with itself
+			 *
+			 * @param a The index of a reference cluster
+			 * @return the support, between 0 and 1
+			 */
+			inline double support(size_t a) const {return coClustering(a, a);}
+	};
+}
+
+#endif
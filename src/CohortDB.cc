@@ -0,0 +1,193 @@
+/**
+ * @file CohortDB.cc
+ * Implementation of the helper class CohortDB
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "CohortDB.h"
+#include <sstream>
+
+using namespace SubcloneSeeker;
+
+const char *CohortDB::SampleColumnDefinition = "sampleID INTEGER NOT NULL REFERENCES Samples(id)";
+
+/**
+ * Run a query returning the first column of each row as text
+ */
+static std::vector<std::string> queryStrings(sqlite3 *database, const std::string& query_str,
+		const std::string& value = "", int column = 0) {
+	sqlite3_stmt *statement;
+	std::vector<std::string> ret;
+
+	if(sqlite3_prepare_v2(database, query_str.c_str(), -1, &statement, 0) != SQLITE_OK) {
+		sqlite3_finalize(statement);
+		return ret;
+	}
+
+	if(!value.empty())
+		sqlite3_bind_text(statement, 1, value.c_str(), -1, SQLITE_TRANSIENT);
+
+	while(sqlite3_step(statement) == SQLITE_ROW) {
+		const unsigned char *text = sqlite3_column_text(statement, column);
+		ret.push_back(text == NULL ? "" : (const char *)text);
+	}
+
+	sqlite3_finalize(statement);
+	return ret;
+}
+
+/**
+ * Run a query returning a single integer, 0 if it returns no row or fails
+ */
+static sqlite3_int64 queryInteger(sqlite3 *database, const std::string& query_str, const std::string& value = "") {
+	sqlite3_stmt *statement;
+	sqlite3_int64 ret = 0;
+
+	if(sqlite3_prepare_v2(database, query_str.c_str(), -1, &statement, 0) == SQLITE_OK) {
+		if(!value.empty())
+			sqlite3_bind_text(statement, 1, value.c_str(), -1, SQLITE_TRANSIENT);
+		if(sqlite3_step(statement) == SQLITE_ROW)
+			ret = sqlite3_column_int64(statement, 0);
+	}
+
+	sqlite3_finalize(statement);
+	return ret;
+}
+
+/**
+ * The columns of a table of the main database, in order
+ */
+static std::vector<std::string> tableColumns(sqlite3 *database, const std::string& table) {
+	// PRAGMA table_info returns (cid, name, type, notnull, dflt_value, pk)
+	return queryStrings(database, "PRAGMA main.table_info(" + table + ");", "", 1);
+}
+
+bool CohortDB::isCohort(sqlite3 *database) {
+	return queryInteger(database, "SELECT COUNT(*) FROM main.sqlite_master WHERE type='table' AND name='Samples';") > 0;
+}
+
+bool CohortDB::enterSample(sqlite3 *database, const std::string& sample) {
+	if(!leaveSample(database))
+		return false;
+
+	bool readOnly = sqlite3_db_readonly(database, "main") == 1;
+
+	// only an empty database may be turned into a cohort database
+	if(!isCohort(database)) {
+		if(readOnly || queryInteger(database, "SELECT COUNT(*) FROM main.sqlite_master WHERE type='table';") > 0)
+			return false;
+		if(sqlite3_exec(database, "CREATE TABLE main.Samples (id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, name TEXT NOT NULL UNIQUE);", 0, 0, 0) != SQLITE_OK)
+			return false;
+	}
+
+	if(!readOnly) {
+		sqlite3_stmt *statement;
+		if(sqlite3_prepare_v2(database, "INSERT OR IGNORE INTO main.Samples (name) VALUES (?);", -1, &statement, 0) != SQLITE_OK) {
+			sqlite3_finalize(statement);
+			return false;
+		}
+		sqlite3_bind_text(statement, 1, sample.c_str(), -1, SQLITE_TRANSIENT);
+		int rc = sqlite3_step(statement);
+		sqlite3_finalize(statement);
+		if(rc != SQLITE_DONE)
+			return false;
+	}
+
+	sqlite3_int64 sampleID = queryInteger(database, "SELECT id FROM main.Samples WHERE name=?;", sample);
+	if(sampleID == 0)
+		return false;
+
+	std::ostringstream scope_str;
+	scope_str<<"CREATE TEMP TABLE CohortScope (sampleID INTEGER NOT NULL);"
+		<<"INSERT INTO temp.CohortScope (sampleID) VALUES ("<<sampleID<<");";
+	if(sqlite3_exec(database, scope_str.str().c_str(), 0, 0, 0) != SQLITE_OK)
+		return false;
+
+	// scope the tables of the cohort, i.e. all those with a sampleID column
+	std::vector<std::string> tables = queryStrings(database, "SELECT name FROM main.sqlite_master WHERE type='table';");
+	for(size_t i=0; i<tables.size(); i++) {
+		std::vector<std::string> columns = tableColumns(database, tables[i]);
+		for(size_t j=0; j<columns.size(); j++) {
+			if(columns[j] == "sampleID" && !scopeTable(database, tables[i]))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool CohortDB::leaveSample(sqlite3 *database) {
+	// the scoping views are the temporary views shadowing a table
+	std::vector<std::string> views = queryStrings(database,
+			"SELECT name FROM sqlite_temp_master WHERE type='view' AND name IN (SELECT name FROM main.sqlite_master WHERE type='table');");
+	for(size_t i=0; i<views.size(); i++) {
+		std::string stmt_str = "DROP VIEW temp." + views[i] + ";";
+		if(sqlite3_exec(database, stmt_str.c_str(), 0, 0, 0) != SQLITE_OK)
+			return false;
+	}
+
+	return sqlite3_exec(database, "DROP TABLE IF EXISTS temp.CohortScope;", 0, 0, 0) == SQLITE_OK;
+}
+
+sqlite3_int64 CohortDB::currentSample(sqlite3 *database) {
+	if(queryInteger(database, "SELECT COUNT(*) FROM sqlite_temp_master WHERE type='table' AND name='CohortScope';") == 0)
+		return 0;
+	return queryInteger(database, "SELECT sampleID FROM temp.CohortScope;");
+}
+
+bool CohortDB::scopeTable(sqlite3 *database, const std::string& table) {
+	sqlite3_int64 sampleID = currentSample(database);
+	if(sampleID == 0)
+		return false;
+
+	std::string columns_str;
+	std::vector<std::string> columns = tableColumns(database, table);
+	for(size_t i=0; i<columns.size(); i++) {
+		if(columns[i] != "sampleID")
+			columns_str += (columns_str.empty() ? "" : ", ") + columns[i];
+	}
+
+	std::ostringstream view_str;
+	view_str<<"CREATE TEMP VIEW "<<table<<" AS SELECT "<<columns_str<<" FROM main."<<table<<" WHERE sampleID="<<sampleID<<";";
+
+	std::string stmt_strs[] = {
+		"CREATE INDEX IF NOT EXISTS main." + table + "_sampleID ON " + table + " (sampleID);",
+		"DROP VIEW IF EXISTS temp." + table + ";",
+		view_str.str()
+	};
+
+	for(size_t i=0; i<sizeof(stmt_strs) / sizeof(stmt_strs[0]); i++) {
+		if(sqlite3_exec(database, stmt_strs[i].c_str(), 0, 0, 0) != SQLITE_OK)
+			return false;
+	}
+
+	return true;
+}
+
+std::vector<std::string> CohortDB::samples(sqlite3 *database) {
+	return queryStrings(database, "SELECT name FROM main.Samples ORDER BY id;");
+}
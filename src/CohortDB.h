@@ -0,0 +1,132 @@
+#ifndef COHORT_DB_H
+#define COHORT_DB_H
+
+/**
+ * @file CohortDB.h
+ * Interface description of the helper class CohortDB
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <sqlite3/sqlite3.h>
+#include <string>
+#include <vector>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @brief Many samples stored in one sqlite3 database, each seen through its own scope
+	 *
+	 * A cohort database has a Samples(id, name) table, and every table holding
+	 * archived objects gains a sampleID column, right after id, with an index on
+	 * it; the indices requested by the Archivable classes lead with sampleID too.
+	 * Ids stay unique across the whole database.
+	 *
+	 * A connection works on one sample at a time once enterSample has been
+	 * called. Each table then gets a temporary view of the same name, showing the
+	 * rows of the sample without the sampleID column. As temporary objects shadow
+	 * those of the main database, all code reading tables by name works on the
+	 * sample unchanged. Views cannot be written to, and sqlite3 triggers cannot
+	 * write to a table of the main database by its qualified name; the writers,
+	 * SQLiteBackend and Subclone::linkClusterInDB, thus write to the tables of
+	 * the main database directly, filling in sampleID, and create tables with the
+	 * cohort layout. Cohort-wide queries run on a connection that has not entered
+	 * a sample, e.g.
+	 *
+	 *   SELECT Samples.name, COUNT(*) FROM Trees JOIN Samples ON Samples.id = Trees.sampleID GROUP BY 1;
+	 *
+	 * Sample scopes are per connection, so a batch of jobs may share a cohort
+	 * database as long as a single one writes at a time. The event region index
+	 * (EventRegionIndex) is not supported in cohort databases.
+	 */
+	class CohortDB {
+		public:
+			/**
+			 * The definition of the column added to every table of a cohort database
+			 */
+			static const char *SampleColumnDefinition;
+
+			/**
+			 * Check whether a database has the cohort layout
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @return true if the database has a Samples table
+			 */
+			static bool isCohort(sqlite3 *database);
+
+			/**
+			 * Scope a connection to a sample, leaving the current sample if any
+			 *
+			 * On a writable connection, an empty database is given the cohort layout
+			 * and an unknown sample is added.
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @param sample The name of the sample
+			 * @return false if the database is not a cohort database, if the sample is
+			 * unknown to a read-only connection, or on database errors
+			 */
+			static bool enterSample(sqlite3 *database, const std::string& sample);
+
+			/**
+			 * Drop the sample scope of a connection, showing the tables of the whole cohort again
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @return false on database errors
+			 */
+			static bool leaveSample(sqlite3 *database);
+
+			/**
+			 * The sample a connection is scoped to
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @return the id of the sample, 0 if the connection is not scoped
+			 */
+			static sqlite3_int64 currentSample(sqlite3 *database);
+
+			/**
+			 * Create the view scoping a table of the main database to the current
+			 * sample, replacing an existing one
+			 *
+			 * To be called once a table with a sampleID column has been created in a
+			 * scoped connection.
+			 *
+			 * @param database An open sqlite3 database connection handle, scoped to a sample
+			 * @param table The name of the table
+			 * @return false on database errors
+			 */
+			static bool scopeTable(sqlite3 *database, const std::string& table);
+
+			/**
+			 * List the samples of a cohort database
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @return the sample names, in the order they were added
+			 */
+			static std::vector<std::string> samples(sqlite3 *database);
+	};
+}
+
+#endif
@@ -0,0 +1,153 @@
+/**
+ * @file CompactTree.cc
+ * Implementation of class CompactTree
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "CompactTree.h"
+#include "Subclone.h"
+#include "EventCluster.h"
+#include "ObjectArena.h"
+
+using namespace SubcloneSeeker;
+
+/**
+ * @brief A tree traverser that numbers the nodes in pre-order and records them into a CompactTree
+ */
+class CompactTreeEncodeTraverser : public TreeTraverseDelegate {
+	protected:
+		std::map<TreeNode *, int32_t> _nodeIndex; /**< index already given to each visited node */
+		std::vector<int32_t>& _parents;
+		std::vector<double>& _fractions;
+		std::vector<int32_t>& _clusterNodes;
+		std::vector<sqlite3_int64>& _clusterIDs;
+
+	public:
+		CompactTreeEncodeTraverser(std::vector<int32_t>& parents, std::vector<double>& fractions,
+				std::vector<int32_t>& clusterNodes, std::vector<sqlite3_int64>& clusterIDs):
+			_parents(parents), _fractions(fractions), _clusterNodes(clusterNodes), _clusterIDs(clusterIDs) {;}
+
+		virtual void processNode(TreeNode *node) {
+			Subclone *clone = dynamic_cast<Subclone *>(node);
+			int32_t index = _parents.size();
+			_nodeIndex[node] = index;
+
+			if(node->getParent() == NULL)
+				_parents.push_back(-1);
+			else
+				_parents.push_back(_nodeIndex[node->getParent()]);
+
+			_fractions.push_back(clone->fraction());
+			_fractions.push_back(clone->treeFraction());
+
+			for(size_t i=0; i<clone->vecEventCluster().size(); i++) {
+				_clusterNodes.push_back(index);
+				_clusterIDs.push_back(clone->vecEventCluster()[i]->getId());
+			}
+		}
+};
+
+void CompactTree::encodeTree(Subclone *root) {
+	_parents.clear();
+	_fractions.clear();
+	_clusterNodes.clear();
+	_clusterIDs.clear();
+
+	CompactTreeEncodeTraverser encoder(_parents, _fractions, _clusterNodes, _clusterIDs);
+	TreeNode::PreOrderTraverse(root, encoder);
+}
+
+Subclone *CompactTree::expandTree(const std::map<sqlite3_int64, EventCluster *>& clusters, ObjectArena *arena) {
+	if(_parents.size() == 0)
+		return NULL;
+
+	std::vector<Subclone *> nodes;
+	for(size_t i=0; i<_parents.size(); i++) {
+		Subclone *clone = ObjectArena::create<Subclone>(arena);
+		clone->setId(i+1);
+		clone->setFraction(_fractions[2*i]);
+		clone->setTreeFraction(_fractions[2*i+1]);
+
+		// pre-order guarantees the parent has already been created
+		if(_parents[i] >= 0 && (size_t)_parents[i] < i)
+			nodes[_parents[i]]->addChild(clone);
+
+		nodes.push_back(clone);
+	}
+
+	for(size_t i=0; i<_clusterIDs.size(); i++) {
+		std::map<sqlite3_int64, EventCluster *>::const_iterator it = clusters.find(_clusterIDs[i]);
+		if(it != clusters.end() && (size_t)_clusterNodes[i] < nodes.size())
+			nodes[_clusterNodes[i]]->addEventCluster(it->second);
+	}
+
+	return nodes[0];
+}
+
+Subclone *CompactTree::expandTree(sqlite3 *database, ObjectArena *arena) {
+	std::vector<EventCluster *> clusters = EventCluster::unarchiveClustersWithMembers(database, _clusterIDs, arena);
+
+	std::map<sqlite3_int64, EventCluster *> clusterOfID;
+	for(size_t i=0; i<clusters.size(); i++)
+		clusterOfID[clusters[i]->getId()] = clusters[i];
+
+	return expandTree(clusterOfID, arena);
+}
+
+/**********************************/
+/*  IMPLEMENTATION OF Archivable  */
+/**********************************/
+
+static const ArchiveField CompactTreeFields[] = {
+	{"nodeCount", "INTEGER NOT NULL", false},
+	{"parents", "BLOB NOT NULL", false},
+	{"fractions", "BLOB NOT NULL", false},
+	{"clusterNodes", "BLOB NOT NULL", false},
+	{"clusterIDs", "BLOB NOT NULL", false}
+};
+
+const TableSchema& CompactTree::tableSchema() {
+	static const TableSchema schema("CompactTrees", CompactTreeFields);
+	return schema;
+}
+
+void CompactTree::encodeObject(ArchiveRecord& record) {
+	record.appendInteger(_parents.size());
+	record.appendVector(_parents);
+	record.appendVector(_fractions);
+	record.appendVector(_clusterNodes);
+	record.appendVector(_clusterIDs);
+}
+
+void CompactTree::decodeObject(const ArchiveRecord& record) {
+	// the node count is implied by the parent vector
+	int col_pos = 1;
+	record.vectorAt(col_pos++, _parents);
+	record.vectorAt(col_pos++, _fractions);
+	record.vectorAt(col_pos++, _clusterNodes);
+	record.vectorAt(col_pos++, _clusterIDs);
+}
@@ -0,0 +1,132 @@
+#ifndef COMPACT_TREE_H
+#define COMPACT_TREE_H
+
+/**
+ * @file CompactTree.h
+ * Interface description of the data structure class CompactTree
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "Archivable.h"
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+namespace SubcloneSeeker {
+
+	// forward declaration, so that pointers can be made
+	class Subclone;
+	class EventCluster;
+	class ObjectArena;
+
+	/**
+	 * @brief A whole subclone tree packed into a single database record
+	 *
+	 * The nodes of the tree are numbered in pre-order, so the root is node 0 and
+	 * every node comes after its parent. The tree is then fully described by
+	 * . a parent vector, holding for each node the index of its parent (-1 for the root)
+	 * . the fraction and tree fraction of each node
+	 * . the (node index, cluster id) pairs placing the clusters on the nodes
+	 *
+	 * Each of these is stored as a blob in host byte order. Clusters are only referred
+	 * to by their database id, therefore they have to be archived, once, in the same
+	 * database (see the shared mode of SubcloneSaveTreeTraverser) before the tree is
+	 * encoded. expandTree turns the record back into Subclone objects on demand.
+	 */
+	class CompactTree : public Archivable {
+		protected:
+			std::vector<int32_t> _parents; /**< parent index of each node, -1 for the root */
+			std::vector<double> _fractions; /**< (fraction, tree fraction) of each node */
+			std::vector<int32_t> _clusterNodes; /**< the node index of each cluster placement */
+			std::vector<sqlite3_int64> _clusterIDs; /**< the cluster id of each cluster placement */
+
+		protected:
+			// Implements Archivable
+			virtual const TableSchema& tableSchema();
+
+			virtual void encodeObject(ArchiveRecord& record);
+			virtual void decodeObject(const ArchiveRecord& record);
+
+		public:
+			/**
+			 * Minimal constructor to reset all member variables
+			 */
+			CompactTree() : Archivable() {;}
+
+			/**
+			 * Encode a subclone tree, replacing any previous content
+			 *
+			 * @param root The root of the tree to be encoded. All clusters should have a database id
+			 */
+			void encodeTree(Subclone *root);
+
+			/**
+			 * Expand the record into Subclone objects, using already unarchived clusters
+			 *
+			 * The expanded nodes are not archived; their ids are set to their pre-order
+			 * index + 1, which is only meaningful within the tree.
+			 *
+			 * @param clusters The clusters referred to by the tree, keyed by their database id
+			 * @param arena In which arena are the nodes made, NULL for the heap
+			 * @return the root of a newly allocated tree
+			 */
+			Subclone *expandTree(const std::map<sqlite3_int64, EventCluster *>& clusters, ObjectArena *arena = NULL);
+
+			/**
+			 * Expand the record into Subclone objects, unarchiving the clusters and their
+			 * members from the given database
+			 *
+			 * @param database The database the tree and its clusters are stored in
+			 * @param arena In which arena are the nodes, clusters and events made, NULL for the heap
+			 * @return the root of a newly allocated tree
+			 */
+			Subclone *expandTree(sqlite3 *database, ObjectArena *arena = NULL);
+
+			/**
+			 * The number of nodes in the tree
+			 *
+			 * @return the node count, including the root
+			 */
+			inline size_t nodeCount() const {return _parents.size();}
+
+			/**
+			 * Retrieve the parent vector
+			 *
+			 * @return a reference to the parent index of each node, in pre-order
+			 */
+			inline const std::vector<int32_t>& parents() const {return _parents;}
+
+			/**
+			 * Retrieve the ids of all clusters referred to by the tree
+			 *
+			 * @return a reference to the cluster ids, one per placement
+			 */
+			inline const std::vector<sqlite3_int64>& clusterIDs() const {return _clusterIDs;}
+	};
+}
+
+#endif
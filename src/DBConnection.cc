@@ -0,0 +1,96 @@
+/**
+ * @file DBConnection.cc
+ * Implementation of class DBConnection
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "DBConnection.h"
+#include <cstring>
+#include <sstream>
+#include <string>
+
+using namespace SubcloneSeeker;
+
+bool DBConnection::profileFromName(const char *name, Profile& profile) {
+	if(strcmp(name, "default") == 0)
+		profile = PROFILE_DEFAULT;
+	else if(strcmp(name, "bulk-write") == 0)
+		profile = PROFILE_BULK_WRITE;
+	else if(strcmp(name, "read-analysis") == 0)
+		profile = PROFILE_READ_ANALYSIS;
+	else
+		return false;
+	return true;
+}
+
+/**
+ * Copy a database file into a new in-memory database
+ */
+static int openInMemoryCopy(const char *filename, sqlite3 **database) {
+	sqlite3 *fileDB;
+	int rc = sqlite3_open_v2(filename, &fileDB, SQLITE_OPEN_READONLY, NULL);
+	if(rc != SQLITE_OK) {
+		sqlite3_close(fileDB);
+		*database = NULL;
+		return rc;
+	}
+
+	rc = sqlite3_open(":memory:", database);
+	if(rc == SQLITE_OK) {
+		sqlite3_backup *backup = sqlite3_backup_init(*database, "main", fileDB, "main");
+		if(backup != NULL) {
+			sqlite3_backup_step(backup, -1);
+			sqlite3_backup_finish(backup);
+		}
+		rc = sqlite3_errcode(*database);
+	}
+
+	sqlite3_close(fileDB);
+	if(rc != SQLITE_OK) {
+		sqlite3_close(*database);
+		*database = NULL;
+	}
+	return rc;
+}
+
+int DBConnection::open(const char *filename, sqlite3 **database, int flags, Profile profile) {
+	bool readOnly = (flags & SQLITE_OPEN_READONLY) != 0;
+
+	if(profile == PROFILE_READ_ANALYSIS && readOnly)
+		return openInMemoryCopy(filename, database);
+
+	int rc = sqlite3_open_v2(filename, database, flags, NULL);
+	if(rc != SQLITE_OK || profile != PROFILE_BULK_WRITE)
+		return rc;
+
+	std::ostringstream pragmas;
+	pragmas<<"PRAGMA cache_size=-"<<BulkCacheSizeKB<<";";
+	if(!readOnly)
+		pragmas<<"PRAGMA locking_mode=EXCLUSIVE; PRAGMA journal_mode=OFF; PRAGMA synchronous=OFF; PRAGMA temp_store=MEMORY;";
+
+	return sqlite3_exec(*database, pragmas.str().c_str(), 0, 0, 0);
+}
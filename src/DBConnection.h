@@ -0,0 +1,88 @@
+#ifndef DB_CONNECTION_H
+#define DB_CONNECTION_H
+
+/**
+ * @file DBConnection.h
+ * Interface description of the helper class DBConnection
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <sqlite3/sqlite3.h>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @brief Opens sqlite3 connections tuned for a kind of workload
+	 *
+	 * . PROFILE_DEFAULT opens the database with the sqlite3 defaults.
+	 * . PROFILE_BULK_WRITE is meant for output databases that are written once and
+	 *   can be regenerated: the connection holds an exclusive lock, keeps no rollback
+	 *   journal, does not sync, and uses a large page cache. A crash while writing
+	 *   leaves the database unusable.
+	 * . PROFILE_READ_ANALYSIS copies the whole database into a private in-memory
+	 *   database through the backup API, and returns a connection to the copy. It
+	 *   only applies to read-only opens, as changes to the copy would be lost.
+	 *
+	 * A profile that does not fit the open flags falls back to the defaults, except
+	 * for the page cache size, so that a tool can apply one profile to all the
+	 * connections it opens.
+	 */
+	class DBConnection {
+		public:
+			/** Connection profiles */
+			enum Profile {
+				PROFILE_DEFAULT = 0, /**< sqlite3 defaults */
+				PROFILE_BULK_WRITE, /**< exclusive, unjournaled, unsynced writes */
+				PROFILE_READ_ANALYSIS /**< in-memory copy of a read-only database */
+			};
+
+			static const int BulkCacheSizeKB = 262144; /**< page cache size of the bulk-write profile */
+
+			/**
+			 * Find a profile by its name
+			 *
+			 * @param name One of "default", "bulk-write" or "read-analysis"
+			 * @param profile Receives the profile
+			 * @return false if the name is unknown
+			 */
+			static bool profileFromName(const char *name, Profile& profile);
+
+			/**
+			 * Open a database connection with the given profile
+			 *
+			 * @param filename The database file name
+			 * @param database Receives the connection handle, which has to be closed by sqlite3_close
+			 * @param flags The sqlite3_open_v2 flags, e.g. SQLITE_OPEN_READONLY
+			 * @param profile The profile to be applied
+			 * @return SQLITE_OK on success, a sqlite3 error code otherwise
+			 */
+			static int open(const char *filename, sqlite3 **database,
+					int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, Profile profile = PROFILE_DEFAULT);
+	};
+}
+
+#endif
@@ -0,0 +1,272 @@
+/**
+ * @file Dendrogram.cc
+ * Implementation of the data structure class Dendrogram
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "Dendrogram.h"
+#include "EventCluster.h"
+#include "SomaticEvent.h"
+#include "EventVisitor.h"
+#include <cmath>
+#include <algorithm>
+#include <queue>
+#include <map>
+
+using namespace SubcloneSeeker;
+
+/**
+ * @brief A cluster being built, spanning a range of leaves
+ */
+struct DendrogramBlock {
+	size_t first; /**< the first leaf */
+	size_t last; /**< the last leaf */
+	double weight; /**< the summed weight of the leaves */
+	double weightedSum; /**< the summed weight * frequency of the leaves */
+	size_t version; /**< incremented on every merge, to invalidate queued pairs */
+
+	inline double fraction() const {return weightedSum / weight;}
+};
+
+/**
+ * @brief A queued pair of neighbouring blocks, identified by their first leaves
+ */
+struct DendrogramPair {
+	double distance;
+	size_t left, right; /**< the first leaf of each block */
+	size_t leftVersion, rightVersion;
+
+	// the closest pair first, the leftmost one among equals
+	inline bool operator<(const DendrogramPair& another) const {
+		if(distance != another.distance)
+			return distance > another.distance;
+		return left > another.left;
+	}
+};
+
+void Dendrogram::build(const std::vector<SomaticEvent *>& events) {
+	size_t n = events.size();
+
+	// by frequency, keeping the input order among equals
+	std::vector<std::pair<double, size_t> > order(n);
+	for(size_t i=0; i<n; i++)
+		order[i] = std::make_pair(events[i]->frequency, i);
+	std::sort(order.begin(), order.end());
+
+	_leaves.resize(n);
+	_leafIDs.assign(n, 0);
+	_frequencies.resize(n);
+	_weights.resize(n);
+	for(size_t i=0; i<n; i++) {
+		SomaticEvent *event = events[order[i].second];
+		_leaves[i] = event;
+		_frequencies[i] = event->frequency;
+		_weights[i] = eventWeight(event);
+	}
+
+	_heights.assign(n > 0 ? n - 1 : 0, 0);
+	_steps.assign(n > 0 ? n - 1 : 0, 0);
+	if(n < 2)
+		return;
+
+	// blocks are indexed by their first leaf; the previous block of a block starting
+	// at i ends at i-1, so a block is found from either end
+	std::vector<DendrogramBlock> blocks(n);
+	std::vector<size_t> startOf(n);
+	std::priority_queue<DendrogramPair> pairs;
+	for(size_t i=0; i<n; i++) {
+		DendrogramBlock block = {i, i, _weights[i], _weights[i] * _frequencies[i], 0};
+		blocks[i] = block;
+		startOf[i] = i;
+		if(i > 0) {
+			DendrogramPair pair = {_frequencies[i] - _frequencies[i-1], i-1, i, 0, 0};
+			pairs.push(pair);
+		}
+	}
+
+	double height = 0;
+	for(size_t step = 0; step < n - 1; ) {
+		DendrogramPair pair = pairs.top();
+		pairs.pop();
+
+		DendrogramBlock& left = blocks[pair.left];
+		DendrogramBlock& right = blocks[pair.right];
+		if(left.version != pair.leftVersion || right.version != pair.rightVersion)
+			continue;
+
+		// close the boundary between the two blocks
+		size_t boundary = left.last;
+		height = std::max(height, pair.distance);
+		_heights[boundary] = height;
+		_steps[boundary] = step++;
+
+		left.last = right.last;
+		left.weight += right.weight;
+		left.weightedSum += right.weightedSum;
+		left.version++;
+		right.version++;
+		startOf[left.last] = left.first;
+
+		if(left.first > 0) {
+			DendrogramBlock& previous = blocks[startOf[left.first - 1]];
+			DendrogramPair newPair = {left.fraction() - previous.fraction(), previous.first, left.first, previous.version, left.version};
+			pairs.push(newPair);
+		}
+		if(left.last + 1 < n) {
+			DendrogramBlock& next = blocks[left.last + 1];
+			DendrogramPair newPair = {next.fraction() - left.fraction(), left.first, next.first, left.version, next.version};
+			pairs.push(newPair);
+		}
+	}
+}
+
+bool Dendrogram::attachLeaves(const std::vector<SomaticEvent *>& events) {
+	if(_leafIDs.size() != leafCount())
+		return false;
+
+	std::map<sqlite3_int64, SomaticEvent *> eventOfID;
+	for(size_t i=0; i<events.size(); i++)
+		eventOfID[events[i]->getId()] = events[i];
+
+	_leaves.resize(_leafIDs.size());
+	for(size_t i=0; i<_leafIDs.size(); i++) {
+		std::map<sqlite3_int64, SomaticEvent *>::const_iterator it = eventOfID.find(_leafIDs[i]);
+		if(_leafIDs[i] <= 0 || it == eventOfID.end()) {
+			_leaves.clear();
+			return false;
+		}
+		_leaves[i] = it->second;
+	}
+
+	for(size_t i=0; i<_leaves.size(); i++)
+		_leaves[i]->frequency = _frequencies[i];
+	return true;
+}
+
+size_t Dendrogram::clusterCount(double threshold) const {
+	if(leafCount() == 0)
+		return 0;
+
+	size_t count = 1;
+	for(size_t i=0; i<_heights.size(); i++)
+		if(_heights[i] > threshold)
+			count++;
+	return count;
+}
+
+std::vector<EventCluster *> Dendrogram::cutBoundaries(const std::vector<bool>& open) const {
+	std::vector<EventCluster *> clusters;
+	if(_leaves.size() != leafCount())
+		return clusters;
+
+	EventCluster *current = NULL;
+	for(size_t i=0; i<_leaves.size(); i++) {
+		if(current == NULL || open[i-1]) {
+			current = new EventCluster();
+			clusters.push_back(current);
+		}
+		current->addEvent(_leaves[i]);
+	}
+	return clusters;
+}
+
+std::vector<EventCluster *> Dendrogram::cut(double threshold) const {
+	std::vector<bool> open(_heights.size());
+	for(size_t i=0; i<_heights.size(); i++)
+		open[i] = _heights[i] > threshold;
+	return cutBoundaries(open);
+}
+
+std::vector<EventCluster *> Dendrogram::cutToCount(size_t count) const {
+	// the last count-1 merges are undone
+	int32_t lastStep = (int32_t)leafCount() - (int32_t)std::max(count, (size_t)1);
+	std::vector<bool> open(_steps.size());
+	for(size_t i=0; i<_steps.size(); i++)
+		open[i] = _steps[i] >= lastStep;
+	return cutBoundaries(open);
+}
+
+void Dendrogram::sweep(std::vector<double>& thresholds, std::vector<size_t>& counts) const {
+	thresholds.clear();
+	counts.clear();
+
+	// the heights in step order; they do not decrease
+	std::vector<double> byStep(_heights.size());
+	for(size_t i=0; i<_heights.size(); i++)
+		byStep[_steps[i]] = _heights[i];
+
+	for(size_t step=0; step<byStep.size(); step++) {
+		if(!thresholds.empty() && thresholds.back() == byStep[step])
+			counts.back()--;
+		else {
+			thresholds.push_back(byStep[step]);
+			counts.push_back(leafCount() - step - 1);
+		}
+	}
+}
+
+/**********************************/
+/*  IMPLEMENTATION OF Archivable  */
+/**********************************/
+
+static const ArchiveField DendrogramFields[] = {
+	{"leafCount", "INTEGER NOT NULL", false},
+	{"frequencies", "BLOB NOT NULL", false},
+	{"weights", "BLOB NOT NULL", false},
+	{"heights", "BLOB NOT NULL", false},
+	{"steps", "BLOB NOT NULL", false},
+	{"leafIDs", "BLOB NOT NULL", false}
+};
+
+const TableSchema& Dendrogram::tableSchema() {
+	static const TableSchema schema("Dendrograms", DendrogramFields);
+	return schema;
+}
+
+void Dendrogram::encodeObject(ArchiveRecord& record) {
+	record.appendInteger(leafCount());
+	record.appendVector(_frequencies);
+	record.appendVector(_weights);
+	record.appendVector(_heights);
+	record.appendVector(_steps);
+
+	// the events keep the ids they were archived with
+	for(size_t i=0; i<_leaves.size(); i++)
+		_leafIDs[i] = _leaves[i]->getId();
+	record.appendVector(_leafIDs);
+}
+
+void Dendrogram::decodeObject(const ArchiveRecord& record) {
+	// the leaf count is implied by the frequency vector
+	int col_pos = 1;
+	_leaves.clear();
+	record.vectorAt(col_pos++, _frequencies);
+	record.vectorAt(col_pos++, _weights);
+	record.vectorAt(col_pos++, _heights);
+	record.vectorAt(col_pos++, _steps);
+	record.vectorAt(col_pos++, _leafIDs);
+}
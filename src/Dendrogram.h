@@ -0,0 +1,149 @@
+#ifndef DENDROGRAM_H
+#define DENDROGRAM_H
+
+/**
+ * @file Dendrogram.h
+ * Interface description of the data structure class Dendrogram
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "Archivable.h"
+#include <vector>
+#include <stdint.h>
+
+namespace SubcloneSeeker {
+
+	// forward declaration, so that pointers can be made
+	class SomaticEvent;
+	class EventCluster;
+
+	/**
+	 * @brief The merge history of agglomerative clustering of events by frequency
+	 *
+	 * Starting from one cluster per event, the two clusters of the closest
+	 * length-weighted fractions are merged, until a single cluster is left. On a
+	 * line, the closest clusters are always neighbours in frequency order, so each
+	 * merge closes one boundary between two events adjacent in that order. The
+	 * dendrogram records, for each such boundary, the merge step that closed it and
+	 * its height, i.e. the distance between the merged fractions (kept
+	 * non-decreasing from step to step). Cutting it at a threshold, or into a given
+	 * number of clusters, then only takes a scan over the boundaries.
+	 *
+	 * The events are archived by id, in leaf order, so they have to be archived
+	 * before the dendrogram. An unarchived dendrogram can report cluster counts and
+	 * sweep right away, but has to be given its events by attachLeaves to be cut.
+	 */
+	class Dendrogram : public Archivable {
+		protected:
+			std::vector<SomaticEvent *> _leaves; /**< the events, in frequency order */
+			DBObjectID_vec _leafIDs; /**< the database id of each leaf, as of the last (un)archiving */
+			std::vector<double> _frequencies; /**< the frequency of each leaf */
+			std::vector<double> _weights; /**< the weight (segment length, or 1) of each leaf */
+			std::vector<double> _heights; /**< for each boundary between leaves i and i+1, the height it was closed at */
+			std::vector<int32_t> _steps; /**< for each boundary, the merge step that closed it */
+
+		protected:
+			// Implements Archivable
+			virtual const TableSchema& tableSchema();
+
+			virtual void encodeObject(ArchiveRecord& record);
+			virtual void decodeObject(const ArchiveRecord& record);
+
+			std::vector<EventCluster *> cutBoundaries(const std::vector<bool>& open) const;
+
+		public:
+			/**
+			 * Minimal constructor, for an empty dendrogram
+			 */
+			Dendrogram() : Archivable() {;}
+
+			/**
+			 * Cluster the events, replacing any previous content. Takes O(n log n)
+			 *
+			 * @param events The events to be clustered; they are not owned by the dendrogram
+			 */
+			void build(const std::vector<SomaticEvent *>& events);
+
+			/**
+			 * The number of events clustered
+			 *
+			 * @return the leaf count
+			 */
+			inline size_t leafCount() const {return _frequencies.size();}
+
+			/**
+			 * The database ids of the events, in leaf order
+			 *
+			 * @return the ids archived with, or unarchived from, the dendrogram
+			 */
+			inline const DBObjectID_vec& leafIDs() const {return _leafIDs;}
+
+			/**
+			 * Give an unarchived dendrogram back its events, so that it can be cut.
+			 * Each leaf takes the event of its archived id, and the frequency it was
+			 * clustered by, which later corrections of the stored events may have changed
+			 *
+			 * @param events Events, in any order, among which are all the leaves; they are not owned by the dendrogram
+			 * @return whether every leaf was found; if not, the dendrogram has no events
+			 */
+			bool attachLeaves(const std::vector<SomaticEvent *>& events);
+
+			/**
+			 * The number of clusters left after merging every pair within the threshold
+			 *
+			 * @param threshold The largest distance between merged fractions
+			 * @return the cluster count
+			 */
+			size_t clusterCount(double threshold) const;
+
+			/**
+			 * Cut the dendrogram at a threshold, as clusterCount counts
+			 *
+			 * @param threshold The largest distance between merged fractions
+			 * @return A vector of newly allocated EventCluster, by increasing fraction
+			 */
+			std::vector<EventCluster *> cut(double threshold) const;
+
+			/**
+			 * Cut the dendrogram into a number of clusters
+			 *
+			 * @param count The number of clusters wanted, at most the leaf count
+			 * @return A vector of newly allocated EventCluster, by increasing fraction
+			 */
+			std::vector<EventCluster *> cutToCount(size_t count) const;
+
+			/**
+			 * List the cluster count at every threshold it changes at
+			 *
+			 * @param thresholds Receives the distinct heights, increasing
+			 * @param counts Receives the cluster count from each threshold up to the next one
+			 */
+			void sweep(std::vector<double>& thresholds, std::vector<size_t>& counts) const;
+	};
+}
+
+#endif
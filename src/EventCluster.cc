@@ -8,42 +8,123 @@
 #include "EventCluster.h"
 #include "SomaticEvent.h"
 #include "SegmentalMutation.h"
+#include "SNP.h"
+#include "EventVisitor.h"
+#include "SQLiteBackend.h"
+#include "LazyTreeLoader.h"
+#include "MixtureClustering.h"
+#include "Dendrogram.h"
 #include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <map>
 
 using namespace SubcloneSeeker;
 
 void EventCluster::addEvent(SomaticEvent *event, bool updateFraction) {
+	if(_membersPending)
+		loadPendingMembers();
+
 	// check if the event already is a member
-	for(size_t i=0; i<_members.size(); i++) {
-		if(_members[i] == event) {
-			return;
-		}
-	}
+	if(_memberIndex.find(event) != _memberIndex.end())
+		return;
+
+	unsigned long thisLen = eventWeight(event);
+	if(updateFraction)
+		_cellFraction = (_cellFraction * _totalWeight + event->frequency * thisLen) / (_totalWeight + thisLen);
+
+	_memberIndex[event] = _members.size();
+	_members.push_back(event);
+	_totalWeight += thisLen;
+}
+
+bool EventCluster::removeEvent(SomaticEvent *event, bool updateFraction) {
+	if(_membersPending)
+		loadPendingMembers();
 
+	MemberIndex::iterator it = _memberIndex.find(event);
+	if(it == _memberIndex.end())
+		return false;
+
+	unsigned long thisLen = eventWeight(event);
 	if(updateFraction) {
-		unsigned long oldLen = 0;
-		for(size_t i=0; i<_members.size(); i++) {
-			SegmentalMutation *asSeg = dynamic_cast<SegmentalMutation *>(_members[i]);
-			if(asSeg != NULL) {
-				oldLen += asSeg->range.length;
-			}
-			else
-				oldLen += 1;
-		}
-		unsigned long thisLen;
-		SegmentalMutation *asSeg = dynamic_cast<SegmentalMutation *>(event);
-		if(asSeg != NULL)
-			thisLen = asSeg->range.length;
+		if(_totalWeight > thisLen)
+			_cellFraction = (_cellFraction * _totalWeight - event->frequency * thisLen) / (_totalWeight - thisLen);
 		else
-			thisLen = 1;
+			_cellFraction = 0;
+	}
 
-		_cellFraction = (_cellFraction * oldLen + event->frequency * thisLen) / (oldLen + thisLen);
+	// fill the hole with the last member
+	size_t pos = it->second;
+	_memberIndex.erase(it);
+	if(pos + 1 < _members.size()) {
+		_members[pos] = _members.back();
+		_memberIndex[_members[pos]] = pos;
 	}
+	_members.pop_back();
+	_totalWeight -= thisLen;
 
-	_members.push_back(event);
+	return true;
+}
+
+void EventCluster::merge(const EventCluster& other, bool updateFraction) {
+	if(other._membersPending)
+		const_cast<EventCluster&>(other).loadPendingMembers();
+
+	_memberIndex.reserve(_members.size() + other._members.size());
+	_members.reserve(_members.size() + other._members.size());
+	for(size_t i=0; i<other._members.size(); i++)
+		addEvent(other._members[i], updateFraction);
+}
+
+void EventCluster::loadPendingMembers() {
+	_membersPending = false;
+	if(_lazyLoader != NULL)
+		_lazyLoader->loadMembers(this);
+}
+
+bool EventCluster::clusteringEngineFromName(const char *name, ClusteringEngine& engine) {
+	if(strcmp(name, "greedy") == 0)
+		engine = CLUSTERING_GREEDY;
+	else if(strcmp(name, "sweep") == 0)
+		engine = CLUSTERING_SWEEP;
+	else if(strcmp(name, "kmeans") == 0)
+		engine = CLUSTERING_KMEANS;
+	else if(strcmp(name, "gmm") == 0)
+		engine = CLUSTERING_GMM;
+	else if(strcmp(name, "hierarchical") == 0)
+		engine = CLUSTERING_HIERARCHICAL;
+	else
+		return false;
+	return true;
 }
 
-std::vector<EventCluster *> EventCluster::clustering(const std::vector<SomaticEvent *>& events, double threshold) {
+std::vector<EventCluster *> EventCluster::clustering(const std::vector<SomaticEvent *>& events, double threshold, ClusteringEngine engine) {
+	switch(engine) {
+		case CLUSTERING_SWEEP:
+			return sweepClustering(events, threshold);
+		case CLUSTERING_KMEANS:
+		case CLUSTERING_GMM: {
+			if(threshold < 0 || threshold > 1)
+				return std::vector<EventCluster *>();
+			MixtureClustering mixture(engine == CLUSTERING_GMM ? MixtureClustering::MODEL_GMM : MixtureClustering::MODEL_KMEANS, threshold);
+			return mixture.cluster(events);
+		}
+		case CLUSTERING_HIERARCHICAL: {
+			if(threshold < 0 || threshold > 1)
+				return std::vector<EventCluster *>();
+			Dendrogram dendrogram;
+			dendrogram.build(events);
+			return dendrogram.cut(threshold);
+		}
+		case CLUSTERING_GREEDY:
+		default:
+			return greedyClustering(events, threshold);
+	}
+}
+
+std::vector<EventCluster *> EventCluster::greedyClustering(const std::vector<SomaticEvent *>& events, double threshold) {
 	std::vector<EventCluster *> clusters;
 
 	if(threshold < 0 || threshold > 1)
@@ -79,14 +160,68 @@ std::vector<EventCluster *> EventCluster::clustering(const std::vector<SomaticEv
 	return clusters;
 }
 
+/**
+ * Order events by frequency, breaking ties by genomic position (segments
+ * first), so that sorting does not depend on the input order
+ */
+static bool eventPrecedes(SomaticEvent *a, SomaticEvent *b) {
+	if(a->frequency != b->frequency)
+		return a->frequency < b->frequency;
+
+	bool segA = isSegment(a), segB = isSegment(b);
+	if(segA != segB)
+		return segA;
+
+	if(segA || (a->kind() == SomaticEvent::KIND_SNP && b->kind() == SomaticEvent::KIND_SNP)) {
+		GenomicRange extentA = eventExtent(a), extentB = eventExtent(b);
+		if(extentA < extentB || extentB < extentA)
+			return extentA < extentB;
+		if(extentA.length != extentB.length)
+			return extentA.length < extentB.length;
+	}
+
+	// indistinguishable events; keep duplicates next to each other
+	return std::less<SomaticEvent *>()(a, b);
+}
+
+std::vector<EventCluster *> EventCluster::sweepClustering(const std::vector<SomaticEvent *>& events, double threshold) {
+	std::vector<EventCluster *> clusters;
+
+	if(threshold < 0 || threshold > 1)
+		return clusters;
+
+	std::vector<SomaticEvent *> sorted(events);
+	std::sort(sorted.begin(), sorted.end(), eventPrecedes);
+
+	EventCluster *current = NULL;
+	for(size_t eventIdx = 0; eventIdx < sorted.size(); eventIdx++) {
+		SomaticEvent *currentEvent = sorted[eventIdx];
+
+		if(current == NULL || fabs(currentEvent->frequency - current->_cellFraction) > threshold) {
+			current = new EventCluster();
+			clusters.push_back(current);
+		}
+
+		current->addEvent(currentEvent);
+	}
+
+	return clusters;
+}
+
 DBObjectID_vec EventCluster::allObjectsOfSubclone(sqlite3 *database, sqlite3_int64 subcloneID) {
 	sqlite3_stmt* st;
 	int rc;
 	DBObjectID_vec res_vec;
 
 	std::string queryStr = "SELECT id FROM " + getTableName() + " WHERE ofSubcloneID=?";
+	std::string linkedQueryStr = queryStr + " UNION SELECT clusterID FROM SubcloneClusters WHERE subcloneID=?1";
 
-	rc = sqlite3_prepare_v2(database, queryStr.c_str(), -1, &st, 0);
+	// the join table only exists in databases holding shared clusters
+	rc = sqlite3_prepare_v2(database, linkedQueryStr.c_str(), -1, &st, 0);
+	if(rc != SQLITE_OK) {
+		sqlite3_finalize(st);
+		rc = sqlite3_prepare_v2(database, queryStr.c_str(), -1, &st, 0);
+	}
 	if(rc != SQLITE_OK) {
 		sqlite3_finalize(st);
 		return res_vec;
@@ -108,51 +243,79 @@ DBObjectID_vec EventCluster::allObjectsOfSubclone(sqlite3 *database, sqlite3_int
 	return(res_vec);
 }
 
-/**********************************/
-/*  IMPLEMENTATION OF Archivable  */
-/**********************************/
+std::vector<EventCluster *> EventCluster::unarchiveClustersWithMembers(sqlite3 *database, const DBObjectID_vec& clusterIDs, ObjectArena *arena) {
+	std::vector<EventCluster *> clusters = unarchiveObjectsFromDB<EventCluster>(database, clusterIDs, arena);
 
-std::string EventCluster::getTableName() {
-	return "Clusters";
-}
+	std::map<sqlite3_int64, EventCluster *> clusterOfID;
+	for(size_t i=0; i<clusters.size(); i++)
+		clusterOfID[clusters[i]->getId()] = clusters[i];
 
-std::string EventCluster::createTableStatementStr() {
-	return ", fraction REAL NOT NULL, ofSubcloneID INTEGER NULL REFERENCES Subclone(id)";
-}
+	std::vector<SomaticEvent *> events = SomaticEvent::unarchiveEventsOfClusters(database, clusterIDs, arena);
+	for(size_t i=0; i<events.size(); i++) {
+		std::map<sqlite3_int64, EventCluster *>::iterator it = clusterOfID.find(events[i]->clusterID());
+		if(it != clusterOfID.end())
+			it->second->addEvent(events[i], false);
+	}
 
-std::string EventCluster::createObjectStatementStr() {
-	return "INSERT INTO Clusters (fraction, ofSubcloneID) VALUES (?,?);";
+	return clusters;
 }
 
-std::string EventCluster::updateObjectStatementStr() {
-	return "UPDATE Clusters SET fraction=?, ofSubcloneID=? WHERE id=?;";
-}
+std::vector<EventCluster *> EventCluster::unarchiveClustersOfSubclone(StorageBackend& backend, sqlite3_int64 subcloneID, ObjectArena *arena) {
+	std::vector<EventCluster *> clusters = unarchiveObjectsReferringTo<EventCluster>(backend, "ofSubcloneID", subcloneID, arena);
+
+	for(size_t i=0; i<clusters.size(); i++) {
+		std::vector<SomaticEvent *> events = SomaticEvent::unarchiveEventsOfCluster(backend, clusters[i]->getId(), arena);
+		for(size_t j=0; j<events.size(); j++)
+			clusters[i]->addEvent(events[j], false);
+	}
 
-std::string EventCluster::selectObjectColumnListStr() {
-	return "fraction, ofSubcloneID";
+	return clusters;
 }
 
-int EventCluster::bindObjectToStatement(sqlite3_stmt *statement) {
-	int bind_loc = 1;
-	sqlite3_bind_double(statement, bind_loc++, _cellFraction);
-	if(ofSubcloneID> 0) {
-		sqlite3_bind_int64(statement, bind_loc++, ofSubcloneID);
-	}
-	else {
-		sqlite3_bind_null(statement, bind_loc++);
+std::vector<EventCluster *> EventCluster::unarchiveClustersWithMembers(StorageBackend& backend, const DBObjectID_vec& clusterIDs, ObjectArena *arena) {
+	SQLiteBackend *sqliteBackend = dynamic_cast<SQLiteBackend *>(&backend);
+	if(sqliteBackend != NULL)
+		return unarchiveClustersWithMembers(sqliteBackend->database(), clusterIDs, arena);
+
+	std::vector<EventCluster *> clusters;
+	for(size_t i=0; i<clusterIDs.size(); i++) {
+		EventCluster *cluster = ObjectArena::create<EventCluster>(arena);
+		if(!cluster->unarchiveObject(backend, clusterIDs[i])) {
+			if(arena == NULL)
+				delete cluster;
+			continue;
+		}
+
+		std::vector<SomaticEvent *> events = SomaticEvent::unarchiveEventsOfCluster(backend, clusterIDs[i], arena);
+		for(size_t j=0; j<events.size(); j++)
+			cluster->addEvent(events[j], false);
+		clusters.push_back(cluster);
 	}
 
-	return bind_loc;
+	return clusters;
 }
 
-void EventCluster::updateObjectFromStatement(sqlite3_stmt *statement) {
-	int col_pos = 0;
-	_cellFraction= sqlite3_column_double(statement, col_pos++);
+/**********************************/
+/*  IMPLEMENTATION OF Archivable  */
+/**********************************/
 
-	if(sqlite3_column_type(statement, col_pos) != SQLITE_NULL) {
-		ofSubcloneID = sqlite3_column_int64(statement, col_pos++);
-	}
-	else {
-		ofSubcloneID = 0;
-	}
+static const ArchiveField EventClusterFields[] = {
+	{"fraction", "REAL NOT NULL", false},
+	{"ofSubcloneID", "INTEGER NULL REFERENCES Subclone(id)", false}
+};
+
+const TableSchema& EventCluster::tableSchema() {
+	static const TableSchema schema("Clusters", EventClusterFields);
+	return schema;
+}
+
+void EventCluster::encodeObject(ArchiveRecord& record) {
+	record.appendReal(_cellFraction);
+	record.appendIDOrNull(ofSubcloneID);
+}
+
+void EventCluster::decodeObject(const ArchiveRecord& record) {
+	int col_pos = 0;
+	_cellFraction = record.realAt(col_pos++);
+	ofSubcloneID = record.integerAt(col_pos++);
 }
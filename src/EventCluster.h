@@ -33,11 +33,13 @@ THE SOFTWARE.
 
 #include "Archivable.h"
 #include <vector>
+#include <unordered_map>
 
 namespace SubcloneSeeker {
 
 	// Forward declaration of SomaticEvent so that pointers can be made
 	class SomaticEvent;
+	class LazyTreeLoader;
 
 	/**
 	 * @brief A collection class that each instance groups many SomaticEvents which share the same cell frequency
@@ -52,32 +54,70 @@ namespace SubcloneSeeker {
 		protected:
 			std::vector<SomaticEvent *> _members; /**< the vector that holds all the cluster's members */
 			double _cellFraction; /**< the cell fraction all members share */
+
+			typedef std::unordered_map<SomaticEvent *, size_t> MemberIndex;
+			MemberIndex _memberIndex; /**< the position of each member in _members */
+			unsigned long _totalWeight; /**< the summed weight (segment length, or 1) of all members */
 			
 			sqlite3_int64 ofSubcloneID; /**< to which subclone does this cluster belongs */
 
+			LazyTreeLoader *_lazyLoader; /**< the loader of the pending members, NULL if loaded eagerly */
+			bool _membersPending; /**< whether the members are yet to be loaded by _lazyLoader */
+
+			friend class LazyTreeLoader;
+
+			/**
+			 * Load the members of a cluster created by a LazyTreeLoader
+			 */
+			void loadPendingMembers();
+
 		protected:
 			// Implements Archivable
-			virtual std::string getTableName();
-			virtual std::string createTableStatementStr();
-			virtual std::string createObjectStatementStr();
-			virtual std::string updateObjectStatementStr();
-			virtual std::string selectObjectColumnListStr();
+			virtual const TableSchema& tableSchema();
 
-			virtual int bindObjectToStatement(sqlite3_stmt* statement);
-			virtual void updateObjectFromStatement(sqlite3_stmt* statement);
+			virtual void encodeObject(ArchiveRecord& record);
+			virtual void decodeObject(const ArchiveRecord& record);
 
 		public:
 			/**
 			 * Minimal constructor that resets all member variables
 			 */
-			EventCluster() : Archivable(), _cellFraction(0), ofSubcloneID(0) {;}
+			EventCluster() : Archivable(), _cellFraction(0), _totalWeight(0), ofSubcloneID(0), _lazyLoader(NULL), _membersPending(false) {;}
+
+			/** Iterator over the members of a cluster */
+			typedef std::vector<SomaticEvent *>::const_iterator member_iterator;
 
 			/**
 			 * Retrieve the member vector reference
 			 *
-			 * @return a reference to the members vector
+			 * @return a reference to the members vector, valid until members are added or removed
+			 */
+			inline const std::vector<SomaticEvent *>& members() const {
+				if(_membersPending)
+					const_cast<EventCluster *>(this)->loadPendingMembers();
+				return _members;
+			}
+
+			/**
+			 * The number of members
+			 *
+			 * @return the size of the members vector
 			 */
-			inline std::vector<SomaticEvent *> members() const {return _members;}
+			inline size_t memberCount() const {return members().size();}
+
+			/**
+			 * Iterator to the first member
+			 *
+			 * @return an iterator over the members vector
+			 */
+			inline member_iterator beginMembers() const {return members().begin();}
+
+			/**
+			 * Iterator past the last member
+			 *
+			 * @return the end iterator of the members vector
+			 */
+			inline member_iterator endMembers() const {return members().end();}
 
 			/**
 			 * Retrieve the cell fraction
@@ -96,13 +136,34 @@ namespace SubcloneSeeker {
 			/**
 			 * Add an SomaticEvent object into the member list and update cell fraction
 			 *
+			 * The fraction is the length-weighted mean of the member frequencies. Adding
+			 * takes amortized constant time; an event already a member is ignored.
+			 *
 			 * @param event The event to be added as a member
 			 * @param updateFraction Should the method automatically update the cell fraction of the cluster
 			 */
 			void addEvent(SomaticEvent * event, bool updateFraction = true);
 
-			// Removing an event is such a rare case that, although trivial, it's not yet implemented
-			
+			/**
+			 * Remove an SomaticEvent object from the member list and update cell fraction
+			 *
+			 * Takes constant time; the last member takes the place of the removed one.
+			 * The event itself is not deleted.
+			 *
+			 * @param event The event to be removed
+			 * @param updateFraction Should the method automatically update the cell fraction of the cluster
+			 * @return false if the event is not a member
+			 */
+			bool removeEvent(SomaticEvent * event, bool updateFraction = true);
+
+			/**
+			 * Add all members of another cluster, as addEvent does for each of them
+			 *
+			 * @param other The cluster whose members are added; it is left unchanged
+			 * @param updateFraction Should the method automatically update the cell fraction of the cluster
+			 */
+			void merge(const EventCluster& other, bool updateFraction = true);
+
 
 			/** 
 			 * Override the < operator for sorting purpose
@@ -127,13 +188,58 @@ namespace SubcloneSeeker {
 			 */
 			inline void setSubcloneID(sqlite3_int64 cloneID) { ofSubcloneID = cloneID; }
 
+			/** Clustering engines, as selected by the tools */
+			enum ClusteringEngine {
+				CLUSTERING_GREEDY = 0, /**< greedyClustering */
+				CLUSTERING_SWEEP, /**< sweepClustering */
+				CLUSTERING_KMEANS, /**< MixtureClustering with k-means models */
+				CLUSTERING_GMM, /**< MixtureClustering with Gaussian mixture models */
+				CLUSTERING_HIERARCHICAL /**< Dendrogram cut at the threshold */
+			};
+
+			/**
+			 * Find a clustering engine by its name
+			 *
+			 * @param name One of "greedy", "sweep", "kmeans", "gmm" or "hierarchical"
+			 * @param engine Receives the engine
+			 * @return false if the name is unknown
+			 */
+			static bool clusteringEngineFromName(const char *name, ClusteringEngine& engine);
+
 			/**
 			 * SomaticEvent Clustering Algorithm
 			 * @param events A vector of SomaticEvent to be clustered
-			 * @param threshold The difference threshold to use when doing the clustering
+			 * @param threshold The difference threshold to use when doing the clustering, or the
+			 * resolution of the model-based engines
+			 * @param engine The algorithm grouping the events
 			 * @return A vector of EventCluster containing the resulting clusters
 			 */
-			static std::vector<EventCluster *> clustering(const std::vector<SomaticEvent *>& events, double threshold);
+			static std::vector<EventCluster *> clustering(const std::vector<SomaticEvent *>& events, double threshold,
+					ClusteringEngine engine = CLUSTERING_GREEDY);
+
+			/**
+			 * Cluster events in input order: each event joins the cluster of the
+			 * nearest fraction, if within the threshold, or starts a new one. Takes
+			 * O(n*k) for n events and k clusters, and depends on the input order.
+			 *
+			 * @param events A vector of SomaticEvent to be clustered
+			 * @param threshold The difference threshold to use when doing the clustering
+			 * @return A vector of EventCluster, in the order they were started
+			 */
+			static std::vector<EventCluster *> greedyClustering(const std::vector<SomaticEvent *>& events, double threshold);
+
+			/**
+			 * Cluster events in a single sweep over them, sorted by frequency: each
+			 * event joins the current cluster if within the threshold of its fraction,
+			 * or starts a new one. Fractions are length-weighted as in addEvent.
+			 * Takes O(n log n), and as ties in frequency are broken by genomic
+			 * position, the result does not depend on the input order.
+			 *
+			 * @param events A vector of SomaticEvent to be clustered
+			 * @param threshold The difference threshold to use when doing the clustering
+			 * @return A vector of EventCluster, by increasing fraction
+			 */
+			static std::vector<EventCluster *> sweepClustering(const std::vector<SomaticEvent *>& events, double threshold);
 
 			/**
 			 * Retrieve the subclone ID
@@ -145,12 +251,55 @@ namespace SubcloneSeeker {
 			/**
 			 * Retrieve a vector of cluster IDs whose parent subclone is the given id
 			 *
+			 * Both clusters owned by the subclone and shared clusters linked to it
+			 * through the SubcloneClusters join table are returned
+			 *
 			 * @param database A live database connection
 			 * @param subcloneID The subclone id who contains the clusters
 			 *
 			 * @return a vector of cluster ids contained by the given subclone id
 			 */
 			DBObjectID_vec allObjectsOfSubclone(sqlite3 *database, sqlite3_int64 subcloneID);
+
+			/**
+			 * Unarchive the given clusters together with all their member events
+			 *
+			 * Members of every concrete event type (CNV, LOH and SNP) are loaded, using
+			 * a constant number of queries per batch of cluster ids
+			 *
+			 * @param database A live database connection
+			 * @param clusterIDs The ids of the clusters to be unarchived
+			 * @param arena The arena the clusters and events are made in, NULL to allocate them on the heap
+			 *
+			 * @return a vector of newly allocated clusters, ordered by id, with members populated
+			 */
+			static std::vector<EventCluster *> unarchiveClustersWithMembers(sqlite3 *database, const DBObjectID_vec& clusterIDs, ObjectArena *arena = NULL);
+
+			/**
+			 * Unarchive the clusters owned by a subclone stored in a backend, together
+			 * with all their member events
+			 *
+			 * @param backend The storage backend
+			 * @param subcloneID The id of the subclone who contains the clusters
+			 * @param arena The arena the clusters and events are made in, NULL to allocate them on the heap
+			 *
+			 * @return a vector of newly allocated clusters, ordered by id, with members populated
+			 */
+			static std::vector<EventCluster *> unarchiveClustersOfSubclone(StorageBackend& backend, sqlite3_int64 subcloneID, ObjectArena *arena = NULL);
+
+			/**
+			 * Unarchive the given clusters from a backend, together with all their member events
+			 *
+			 * A SQLiteBackend is served by the batched queries of the sqlite3 variant, other
+			 * backends are read one cluster at a time
+			 *
+			 * @param backend The storage backend
+			 * @param clusterIDs The ids of the clusters to be unarchived
+			 * @param arena The arena the clusters and events are made in, NULL to allocate them on the heap
+			 *
+			 * @return a vector of newly allocated clusters, with members populated
+			 */
+			static std::vector<EventCluster *> unarchiveClustersWithMembers(StorageBackend& backend, const DBObjectID_vec& clusterIDs, ObjectArena *arena = NULL);
 	};
 
 	/**
@@ -0,0 +1,224 @@
+/**
+ * @file EventInterner.cc
+ * Implementation of classes EventSet and EventInterner
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "EventInterner.h"
+#include "EventVisitor.h"
+#include <algorithm>
+
+using namespace SubcloneSeeker;
+
+/**********************************/
+/*   IMPLEMENTATION OF EventSet   */
+/**********************************/
+
+void EventSet::insert(size_t id) {
+	if(id / 64 >= _words.size())
+		_words.resize(id / 64 + 1, 0);
+	_words[id / 64] |= (uint64_t)1 << (id % 64);
+}
+
+size_t EventSet::count() const {
+	size_t total = 0;
+	for(size_t i=0; i<_words.size(); i++)
+		total += __builtin_popcountll(_words[i]);
+	return total;
+}
+
+bool EventSet::empty() const {
+	for(size_t i=0; i<_words.size(); i++)
+		if(_words[i] != 0)
+			return false;
+	return true;
+}
+
+EventSet& EventSet::operator|=(const EventSet& another) {
+	if(another._words.size() > _words.size())
+		_words.resize(another._words.size(), 0);
+	for(size_t i=0; i<another._words.size(); i++)
+		_words[i] |= another._words[i];
+	return *this;
+}
+
+EventSet& EventSet::operator&=(const EventSet& another) {
+	if(_words.size() > another._words.size())
+		_words.resize(another._words.size());
+	for(size_t i=0; i<_words.size(); i++)
+		_words[i] &= another._words[i];
+	return *this;
+}
+
+EventSet& EventSet::subtract(const EventSet& another) {
+	size_t n = _words.size() < another._words.size() ? _words.size() : another._words.size();
+	for(size_t i=0; i<n; i++)
+		_words[i] &= ~another._words[i];
+	return *this;
+}
+
+bool EventSet::intersects(const EventSet& another) const {
+	size_t n = _words.size() < another._words.size() ? _words.size() : another._words.size();
+	for(size_t i=0; i<n; i++)
+		if(_words[i] & another._words[i])
+			return true;
+	return false;
+}
+
+bool EventSet::isSubsetOf(const EventSet& another) const {
+	for(size_t i=0; i<_words.size(); i++) {
+		uint64_t other = i < another._words.size() ? another._words[i] : 0;
+		if(_words[i] & ~other)
+			return false;
+	}
+	return true;
+}
+
+/**********************************/
+/* IMPLEMENTATION OF EventInterner */
+/**********************************/
+
+void EventInterner::setEqual(size_t id1, size_t id2) {
+	_equals[id1 * _width + id2 / 64] |= (uint64_t)1 << (id2 % 64);
+	_equals[id2 * _width + id1 / 64] |= (uint64_t)1 << (id1 % 64);
+}
+
+bool EventInterner::equalsAny(size_t id, const EventSet& set) const {
+	const uint64_t *row = &_equals[id * _width];
+	size_t n = _width < set._words.size() ? _width : set._words.size();
+	for(size_t i=0; i<n; i++)
+		if(row[i] & set._words[i])
+			return true;
+	return false;
+}
+
+size_t EventInterner::slotOf(const SomaticEvent *event) const {
+	// the table size is a power of 2; linear probing from a multiplicative hash
+	size_t mask = _slots.size() - 1;
+	size_t slot = ((uintptr_t)event >> 4) * 0x9E3779B97F4A7C15ULL & mask;
+	while(_slots[slot] != 0 && _events[_slots[slot] - 1] != event)
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+size_t EventInterner::intern(SomaticEvent *event) {
+	size_t slot = slotOf(event);
+	if(_slots[slot] != 0)
+		return _slots[slot] - 1;
+
+	size_t id = _events.size();
+	_events.push_back(event);
+
+	// keep the table at most half full
+	if(2 * _events.size() > _slots.size()) {
+		_slots.assign(_slots.size() * 2, 0);
+		for(size_t i=0; i<_events.size(); i++)
+			_slots[slotOf(_events[i])] = i + 1;
+	}
+	else {
+		_slots[slot] = id + 1;
+	}
+
+	// all rows share one width, doubled, and the rows spread out, when the ids outgrow it
+	if(id / 64 >= _width) {
+		std::vector<uint64_t> wider(_events.size() * _width * 2, 0);
+		for(size_t i=0; i<id; i++)
+			std::copy(_equals.begin() + i * _width, _equals.begin() + (i+1) * _width, wider.begin() + i * _width * 2);
+		_width *= 2;
+		_equals.swap(wider);
+	}
+	else {
+		_equals.resize(_events.size() * _width, 0);
+	}
+
+	// only CNVs of the same chromosome are ever equal, normally to themselves as
+	// well, so only the chain of that chromosome is walked. Negative chromosome
+	// numbers share the chain of 0, which eventsEqual tells apart
+	_previousOfChrom.push_back(0);
+	if(event->kind() == SomaticEvent::KIND_CNV) {
+		int chrom = static_cast<CNV *>(event)->range.chrom;
+		size_t chain = chrom > 0 ? chrom : 0;
+		if(chain >= _lastOfChrom.size())
+			_lastOfChrom.resize(chain + 1, 0);
+
+		for(size_t other = _lastOfChrom[chain]; other != 0; other = _previousOfChrom[other - 1]) {
+			if(eventsEqual(event, _events[other - 1], _resolution))
+				setEqual(id, other - 1);
+		}
+		if(eventsEqual(event, event, _resolution))
+			setEqual(id, id);
+
+		_previousOfChrom[id] = _lastOfChrom[chain];
+		_lastOfChrom[chain] = id + 1;
+	}
+
+	return id;
+}
+
+EventSet EventInterner::setOf(const std::vector<SomaticEvent *>& events) {
+	EventSet set;
+	for(size_t i=0; i<events.size(); i++)
+		set.insert(intern(events[i]));
+	return set;
+}
+
+EventSet EventInterner::equivalentsOf(const EventSet& set) const {
+	EventSet equivalents;
+	equivalents._words.resize(_width, 0);
+	for(size_t w=0; w<set._words.size(); w++) {
+		for(uint64_t bits = set._words[w]; bits != 0; bits &= bits - 1) {
+			size_t id = w * 64 + __builtin_ctzll(bits);
+			if(id >= _events.size())
+				continue;
+			for(size_t i=0; i<_width; i++)
+				equivalents._words[i] |= _equals[id * _width + i];
+		}
+	}
+	return equivalents;
+}
+
+std::vector<SomaticEvent *> EventInterner::difference(const std::vector<SomaticEvent *>& master, const std::vector<SomaticEvent *>& unwanted) {
+	EventSet unwantedSet = setOf(unwanted);
+
+	// the rows of master events interned just now are complete, unlike any
+	// equivalents of unwanted computed before
+	std::vector<SomaticEvent *> remaining;
+	for(size_t i=0; i<master.size(); i++)
+		if(!equalsAny(intern(master[i]), unwantedSet))
+			remaining.push_back(master[i]);
+	return remaining;
+}
+
+bool EventInterner::contains(const std::vector<SomaticEvent *>& container, const std::vector<SomaticEvent *>& containee) {
+	EventSet containerSet = setOf(container);
+
+	// stop at the first miss, before interning the rest of containee
+	for(size_t i=0; i<containee.size(); i++)
+		if(!equalsAny(intern(containee[i]), containerSet))
+			return false;
+	return true;
+}
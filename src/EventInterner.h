@@ -0,0 +1,192 @@
+#ifndef EVENT_INTERNER_H
+#define EVENT_INTERNER_H
+
+/**
+ * @file EventInterner.h
+ * Interface description of the helper classes EventSet and EventInterner
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace SubcloneSeeker {
+
+	// forward declaration, so that pointers can be made
+	class SomaticEvent;
+
+	/**
+	 * @brief A set of dense event ids, as a bitset
+	 *
+	 * The set grows to hold the largest id inserted; sets of different widths
+	 * combine as if the missing words were 0.
+	 */
+	class EventSet {
+		friend class EventInterner;
+
+		protected:
+			std::vector<uint64_t> _words; /**< bit i of word w is id 64*w+i */
+
+		public:
+			/**
+			 * Add an id to the set
+			 */
+			void insert(size_t id);
+
+			/**
+			 * Check if an id is in the set
+			 */
+			inline bool contains(size_t id) const {
+				return id / 64 < _words.size() && (_words[id / 64] >> (id % 64) & 1);
+			}
+
+			/**
+			 * The number of ids in the set
+			 */
+			size_t count() const;
+
+			/**
+			 * Whether the set holds no id
+			 */
+			bool empty() const;
+
+			/**
+			 * Add the ids of another set (OR)
+			 */
+			EventSet& operator|=(const EventSet& another);
+
+			/**
+			 * Keep the ids also found in another set (AND)
+			 */
+			EventSet& operator&=(const EventSet& another);
+
+			/**
+			 * Remove the ids found in another set (AND NOT)
+			 */
+			EventSet& subtract(const EventSet& another);
+
+			/**
+			 * Check if the set shares an id with another set
+			 */
+			bool intersects(const EventSet& another) const;
+
+			/**
+			 * Check if every id of the set is in another set
+			 */
+			bool isSubsetOf(const EventSet& another) const;
+	};
+
+	/**
+	 * @brief Dense ids for the events of a comparison context
+	 *
+	 * Each distinct event object compared in a context (e.g. the two trees of a
+	 * treemerge pair) is given a dense id on first sight, together with the set of
+	 * ids it is equal to, as SomaticEvent::isEqualTo at the resolution of the
+	 * context. Equality within a resolution is not transitive, so ids are not
+	 * merged; instead an event matches a set if its equality row intersects the
+	 * set, or equivalently if its id is in the equivalents of the set, the union
+	 * of the equality rows of its members. Difference and containment then are
+	 * word-wise operations over bitsets, with the very same results as the
+	 * pairwise comparisons.
+	 */
+	class EventInterner {
+		protected:
+			unsigned long _resolution; /**< the boundary resolution of equality */
+			std::vector<SomaticEvent *> _events; /**< event of each id */
+			std::vector<size_t> _slots; /**< open addressing table of id+1 by event address, 0 for a free slot */
+			size_t _width; /**< words per equality row, enough for all ids */
+			std::vector<uint64_t> _equals; /**< the ids each id is equal to, one row of _width words per id */
+			std::vector<size_t> _lastOfChrom; /**< id+1 of the last CNV interned on each chromosome, 0 for none */
+			std::vector<size_t> _previousOfChrom; /**< id+1 of the CNV interned before each id on its chromosome, 0 for none */
+
+			/**
+			 * The slot of an event in _slots: either its own, or the free one it would take
+			 */
+			size_t slotOf(const SomaticEvent *event) const;
+
+			/**
+			 * Mark two ids as equal to each other
+			 */
+			void setEqual(size_t id1, size_t id2);
+
+			/**
+			 * Check if an id is equal to a member of a set
+			 */
+			bool equalsAny(size_t id, const EventSet& set) const;
+
+		public:
+			/**
+			 * Constructor
+			 *
+			 * @param resolution The boundary resolution events are compared at
+			 */
+			EventInterner(unsigned long resolution) : _resolution(resolution), _slots(256, 0), _width(1) {;}
+
+			/**
+			 * The id of an event, given on first sight
+			 *
+			 * @param event The event, which has to outlive the context
+			 * @return its dense id
+			 */
+			size_t intern(SomaticEvent *event);
+
+			/**
+			 * The ids of a vector of events, interning them as needed
+			 */
+			EventSet setOf(const std::vector<SomaticEvent *>& events);
+
+			/**
+			 * The ids equal to at least one member of a set
+			 */
+			EventSet equivalentsOf(const EventSet& set) const;
+
+			/**
+			 * The number of interned events
+			 */
+			inline size_t size() const {return _events.size();}
+
+			/**
+			 * The event of an id
+			 */
+			inline SomaticEvent *event(size_t id) const {return _events[id];}
+
+			/**
+			 * The events of master not equal to any event of unwanted
+			 *
+			 * @return the remaining events, in the order of master
+			 */
+			std::vector<SomaticEvent *> difference(const std::vector<SomaticEvent *>& master, const std::vector<SomaticEvent *>& unwanted);
+
+			/**
+			 * Check if every event of containee is equal to an event of container
+			 */
+			bool contains(const std::vector<SomaticEvent *>& container, const std::vector<SomaticEvent *>& containee);
+	};
+}
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * @file EventRegionIndex.cc
+ * Implementation of the helper class EventRegionIndex
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "EventRegionIndex.h"
+#include <sstream>
+
+using namespace SubcloneSeeker;
+
+/** The event tables that get indexed */
+static const char *EventTables[] = {"Events_CNV", "Events_LOH", "Events_SNP"};
+static const size_t NumEventTables = sizeof(EventTables) / sizeof(EventTables[0]);
+
+/**
+ * Check whether a table, or a virtual table, exists
+ */
+static bool tableExists(sqlite3 *database, const std::string& table) {
+	sqlite3_stmt *statement;
+	bool exists = false;
+
+	if(sqlite3_prepare_v2(database, "SELECT 1 FROM sqlite_master WHERE type='table' AND name=?;", -1, &statement, 0) == SQLITE_OK) {
+		sqlite3_bind_text(statement, 1, table.c_str(), -1, SQLITE_TRANSIENT);
+		exists = sqlite3_step(statement) == SQLITE_ROW;
+	}
+
+	sqlite3_finalize(statement);
+	return exists;
+}
+
+bool EventRegionIndex::isAvailable() {
+	return sqlite3_compileoption_used("ENABLE_RTREE") != 0;
+}
+
+bool EventRegionIndex::create(sqlite3 *database) {
+	if(!isAvailable())
+		return false;
+
+	if(sqlite3_exec(database, "SAVEPOINT EventRegionIndex;", 0, 0, 0) != SQLITE_OK)
+		return false;
+
+	bool success = true;
+	for(size_t i=0; success && i<NumEventTables; i++) {
+		std::string events = EventTables[i];
+		std::string index = events + "_Region";
+		if(!tableExists(database, events))
+			continue;
+
+		// the box of an event row, as seen from a trigger (new.) or a select ()
+		std::string box = "chrom, chrom, start, start + IFNULL(length, 0)";
+		std::string newBox = "new.id, new.chrom, new.chrom, new.start, new.start + IFNULL(new.length, 0)";
+
+		std::string stmt_strs[] = {
+			"DROP TABLE IF EXISTS " + index + ";",
+			"CREATE VIRTUAL TABLE " + index + " USING rtree_i32(id, chromMin, chromMax, startMin, endMax);",
+			"INSERT INTO " + index + " SELECT id, " + box + " FROM " + events + ";",
+			"CREATE TRIGGER IF NOT EXISTS " + index + "_insert AFTER INSERT ON " + events +
+				" BEGIN INSERT INTO " + index + " VALUES (" + newBox + "); END;",
+			"CREATE TRIGGER IF NOT EXISTS " + index + "_update AFTER UPDATE ON " + events +
+				" BEGIN DELETE FROM " + index + " WHERE id = old.id; INSERT INTO " + index + " VALUES (" + newBox + "); END;",
+			"CREATE TRIGGER IF NOT EXISTS " + index + "_delete AFTER DELETE ON " + events +
+				" BEGIN DELETE FROM " + index + " WHERE id = old.id; END;"
+		};
+
+		for(size_t j=0; success && j<sizeof(stmt_strs) / sizeof(stmt_strs[0]); j++)
+			success = sqlite3_exec(database, stmt_strs[j].c_str(), 0, 0, 0) == SQLITE_OK;
+	}
+
+	if(!success)
+		sqlite3_exec(database, "ROLLBACK TO EventRegionIndex;", 0, 0, 0);
+	sqlite3_exec(database, "RELEASE EventRegionIndex;", 0, 0, 0);
+	return success;
+}
+
+bool EventRegionIndex::exists(sqlite3 *database) {
+	for(size_t i=0; i<NumEventTables; i++) {
+		if(tableExists(database, std::string(EventTables[i]) + "_Region"))
+			return true;
+	}
+	return false;
+}
+
+bool EventRegionIndex::overlapping(sqlite3 *database, const GenomicRange& range, std::vector<Hit>& hits) {
+	if(!isAvailable() || !exists(database))
+		return false;
+
+	bool hasClusters = tableExists(database, "Clusters");
+	bool hasLinks = tableExists(database, "SubcloneClusters");
+
+	for(size_t i=0; i<NumEventTables; i++) {
+		std::string events = EventTables[i];
+		std::string index = events + "_Region";
+		if(!tableExists(database, index))
+			continue;
+
+		// clusters of a tree refer to their subclone, shared clusters are linked
+		std::ostringstream sql;
+		sql<<"SELECT r.id, e.ofClusterID, "<<(hasClusters ? "c.ofSubcloneID" : "NULL")<<", "<<(hasLinks ? "l.subcloneID" : "NULL")
+			<<" FROM "<<index<<" r JOIN "<<events<<" e ON e.id = r.id";
+		if(hasClusters)
+			sql<<" LEFT JOIN Clusters c ON c.id = e.ofClusterID";
+		if(hasLinks)
+			sql<<" LEFT JOIN SubcloneClusters l ON l.clusterID = e.ofClusterID";
+		sql<<" WHERE r.chromMin <= ?1 AND r.chromMax >= ?1 AND r.startMin <= ?3 AND r.endMax >= ?2 ORDER BY r.id;";
+
+		sqlite3_stmt *statement;
+		if(sqlite3_prepare_v2(database, sql.str().c_str(), -1, &statement, 0) != SQLITE_OK) {
+			sqlite3_finalize(statement);
+			return false;
+		}
+
+		sqlite3_bind_int(statement, 1, range.chrom);
+		sqlite3_bind_int64(statement, 2, range.position);
+		sqlite3_bind_int64(statement, 3, range.position + range.length);
+
+		int rc;
+		while((rc = sqlite3_step(statement)) == SQLITE_ROW) {
+			Hit hit;
+			hit.eventTable = events;
+			hit.eventID = sqlite3_column_int64(statement, 0);
+			hit.clusterID = sqlite3_column_int64(statement, 1);
+			hit.subcloneID = sqlite3_column_int64(statement, 2);
+			if(hit.subcloneID == 0)
+				hit.subcloneID = sqlite3_column_int64(statement, 3);
+			hits.push_back(hit);
+		}
+
+		sqlite3_finalize(statement);
+		if(rc != SQLITE_DONE)
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,105 @@
+#ifndef EVENT_REGION_INDEX_H
+#define EVENT_REGION_INDEX_H
+
+/**
+ * @file EventRegionIndex.h
+ * Interface description of the helper class EventRegionIndex
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <sqlite3/sqlite3.h>
+#include <string>
+#include <vector>
+#include "GenomicRange.h"
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @brief An sqlite3 R*Tree index over the genomic location of archived events
+	 *
+	 * For each of the Events_CNV, Events_LOH and Events_SNP tables, the index is an
+	 * rtree_i32 virtual table named after it with a "_Region" suffix, holding one
+	 * box per event: (chrom, chrom) x (start, start + length), an SNP having a
+	 * length of 0. Triggers on the event table keep the index up to date once it
+	 * has been created.
+	 *
+	 * Overlapping events are then found by the index, in the same way as
+	 * GenomicRange::overlaps compares ranges, without unarchiving any event.
+	 * Positions have to fit into 32 bits signed integers.
+	 */
+	class EventRegionIndex {
+		public:
+			/**
+			 * @brief An event overlapping a queried region
+			 */
+			struct Hit {
+				std::string eventTable; /**< the table of the event, e.g. Events_CNV */
+				sqlite3_int64 eventID; /**< the id of the event */
+				sqlite3_int64 clusterID; /**< the cluster the event belongs to, 0 if none */
+				sqlite3_int64 subcloneID; /**< a subclone holding the cluster, 0 if none */
+			};
+
+			/**
+			 * Check whether the sqlite3 library has been built with the R*Tree module
+			 *
+			 * @return true if indices can be created and queried
+			 */
+			static bool isAvailable();
+
+			/**
+			 * Create the index of every event table of a database, together with the
+			 * triggers maintaining it. Already indexed tables are rebuilt.
+			 *
+			 * @param database An open, writable sqlite3 database connection handle
+			 * @return false if the R*Tree module is missing or on database errors
+			 */
+			static bool create(sqlite3 *database);
+
+			/**
+			 * Check whether any event table of a database is indexed
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @return true if at least one index exists
+			 */
+			static bool exists(sqlite3 *database);
+
+			/**
+			 * Find the events overlapping a genomic range
+			 *
+			 * Clusters shared among trees (ssmain -s) are held by several subclones,
+			 * in which case one hit is returned per subclone.
+			 *
+			 * @param database An open sqlite3 database connection handle, with an index
+			 * @param range The queried range
+			 * @param hits Receives the hits, ordered by event table and event id
+			 * @return false if there is no index or on database errors
+			 */
+			static bool overlapping(sqlite3 *database, const GenomicRange& range, std::vector<Hit>& hits);
+	};
+}
+
+#endif
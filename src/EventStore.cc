@@ -0,0 +1,294 @@
+/**
+ * @file EventStore.cc
+ * Implementation of class EventStore
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "EventStore.h"
+#include "SomaticEvent.h"
+#include "SegmentalMutation.h"
+#include "SNP.h"
+#include "EventVisitor.h"
+#include <algorithm>
+
+using namespace SubcloneSeeker;
+
+/**
+ * Absolute difference of two unsigned values
+ */
+static inline unsigned long distance(unsigned long a, unsigned long b) {
+	return a > b ? a - b : b - a;
+}
+
+EventStore::~EventStore() {
+	clear();
+}
+
+void EventStore::clear() {
+	for(size_t i=0; i<_handles.size(); i++)
+		if(_owned[i])
+			delete _handles[i];
+
+	_kinds.clear();
+	_chroms.clear();
+	_positions.clear();
+	_lengths.clear();
+	_frequencies.clear();
+	_clusterIDs.clear();
+	_handles.clear();
+	_owned.clear();
+	_maxEnds.clear();
+	_sorted = true;
+}
+
+size_t EventStore::append(Kind kind, int chrom, unsigned long position, unsigned long length, double frequency, sqlite3_int64 clusterID) {
+	if(kind != SomaticEvent::KIND_CNV && kind != SomaticEvent::KIND_LOH)
+		length = 0;
+
+	// appending after the last row of the same order keeps the store sorted
+	size_t n = _kinds.size();
+	if(_sorted && n > 0 && (_chroms[n-1] > chrom ||
+				(_chroms[n-1] == chrom && (_positions[n-1] > position ||
+					(_positions[n-1] == position && _lengths[n-1] > length)))))
+		_sorted = false;
+
+	if(_sorted) {
+		unsigned long end = position + length;
+		if(n > 0 && _chroms[n-1] == chrom)
+			end = std::max(end, _maxEnds[n-1]);
+		_maxEnds.push_back(end);
+	}
+	else {
+		_maxEnds.clear();
+	}
+
+	_kinds.push_back(kind);
+	_chroms.push_back(chrom);
+	_positions.push_back(position);
+	_lengths.push_back(length);
+	_frequencies.push_back(frequency);
+	_clusterIDs.push_back(clusterID);
+	_handles.push_back(NULL);
+	_owned.push_back(false);
+
+	return n;
+}
+
+size_t EventStore::append(SomaticEvent *event) {
+	Kind kind;
+	int chrom;
+	unsigned long position, length;
+	describe(event, kind, chrom, position, length);
+
+	size_t i = append(kind, chrom, position, length, event->frequency, event->clusterID());
+	_handles[i] = event;
+	return i;
+}
+
+void EventStore::appendAll(const std::vector<SomaticEvent *>& events) {
+	_kinds.reserve(_kinds.size() + events.size());
+	_chroms.reserve(_chroms.size() + events.size());
+	_positions.reserve(_positions.size() + events.size());
+	_lengths.reserve(_lengths.size() + events.size());
+	_frequencies.reserve(_frequencies.size() + events.size());
+	_clusterIDs.reserve(_clusterIDs.size() + events.size());
+	_handles.reserve(_handles.size() + events.size());
+
+	for(size_t i=0; i<events.size(); i++)
+		append(events[i]);
+}
+
+SomaticEvent *EventStore::event(size_t i) {
+	if(_handles[i] != NULL)
+		return _handles[i];
+
+	SomaticEvent *event;
+	switch(_kinds[i]) {
+		case SomaticEvent::KIND_CNV:
+		case SomaticEvent::KIND_LOH:
+			{
+				SegmentalMutation *segment;
+				if(_kinds[i] == SomaticEvent::KIND_CNV)
+					segment = new CNV();
+				else
+					segment = new LOH();
+				segment->range.chrom = _chroms[i];
+				segment->range.position = _positions[i];
+				segment->range.length = _lengths[i];
+				event = segment;
+			}
+			break;
+		case SomaticEvent::KIND_SNP:
+			{
+				SNP *snp = new SNP();
+				snp->location.chrom = _chroms[i];
+				snp->location.position = _positions[i];
+				event = snp;
+			}
+			break;
+		default:
+			// events of no known subclass can not be made from the columns
+			return NULL;
+	}
+	event->frequency = _frequencies[i];
+	event->setClusterID(_clusterIDs[i]);
+
+	_handles[i] = event;
+	_owned[i] = true;
+	return event;
+}
+
+std::vector<SomaticEvent *> EventStore::events() {
+	std::vector<SomaticEvent *> events;
+	events.reserve(size());
+	for(size_t i=0; i<size(); i++)
+		events.push_back(event(i));
+	return events;
+}
+
+/**
+ * Apply a permutation to a column, row i taking the value of row order[i]
+ */
+template <typename T>
+static void permute(std::vector<T>& column, const std::vector<size_t>& order) {
+	std::vector<T> permuted;
+	permuted.reserve(column.size());
+	for(size_t i=0; i<order.size(); i++)
+		permuted.push_back(column[order[i]]);
+	column.swap(permuted);
+}
+
+void EventStore::sortByPosition() {
+	if(_sorted)
+		return;
+
+	std::vector<size_t> order(size());
+	for(size_t i=0; i<order.size(); i++)
+		order[i] = i;
+
+	// stable, so that equally placed rows keep their order of appending
+	std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+			if(_chroms[a] != _chroms[b]) return _chroms[a] < _chroms[b];
+			if(_positions[a] != _positions[b]) return _positions[a] < _positions[b];
+			return _lengths[a] < _lengths[b];
+			});
+
+	permute(_kinds, order);
+	permute(_chroms, order);
+	permute(_positions, order);
+	permute(_lengths, order);
+	permute(_frequencies, order);
+	permute(_clusterIDs, order);
+	permute(_handles, order);
+	permute(_owned, order);
+
+	_maxEnds.resize(size());
+	for(size_t i=0; i<size(); i++) {
+		_maxEnds[i] = _positions[i] + _lengths[i];
+		if(i > 0 && _chroms[i-1] == _chroms[i])
+			_maxEnds[i] = std::max(_maxEnds[i], _maxEnds[i-1]);
+	}
+	_sorted = true;
+}
+
+size_t EventStore::lowerBound(int chrom, unsigned long position) const {
+	size_t low = 0, high = size();
+	while(low < high) {
+		size_t mid = low + (high - low) / 2;
+		if(_chroms[mid] < chrom || (_chroms[mid] == chrom && _positions[mid] < position))
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+size_t EventStore::upperBound(int chrom, unsigned long position) const {
+	size_t low = 0, high = size();
+	while(low < high) {
+		size_t mid = low + (high - low) / 2;
+		if(_chroms[mid] < chrom || (_chroms[mid] == chrom && _positions[mid] <= position))
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+bool EventStore::overlapsAny(int chrom, unsigned long position, unsigned long length) const {
+	unsigned long end = position + length;
+
+	if(!_sorted) {
+		for(size_t i=0; i<size(); i++)
+			if(_chroms[i] == chrom && !(end < _positions[i] || position > _positions[i] + _lengths[i]))
+				return true;
+		return false;
+	}
+
+	// rows starting after the end of the range can not overlap it, and among
+	// the ones before, the furthest reaching one decides
+	size_t first = lowerBound(chrom, 0);
+	size_t last = upperBound(chrom, end);
+	return last > first && _maxEnds[last-1] >= position;
+}
+
+bool EventStore::containsEqual(Kind kind, int chrom, unsigned long position, unsigned long length, unsigned long resolution) const {
+	if(kind != SomaticEvent::KIND_CNV || resolution == 0)
+		return false;
+
+	unsigned long end = position + length;
+	size_t first = 0, last = size();
+	if(_sorted) {
+		first = lowerBound(chrom, position >= resolution ? position - resolution + 1 : 0);
+		last = lowerBound(chrom, position + resolution);
+	}
+
+	for(size_t i=first; i<last; i++) {
+		if(_kinds[i] != SomaticEvent::KIND_CNV || _chroms[i] != chrom)
+			continue;
+		if(distance(_positions[i], position) < resolution &&
+				distance(_positions[i] + _lengths[i], end) < resolution)
+			return true;
+	}
+	return false;
+}
+
+bool EventStore::containsEqual(SomaticEvent *event, unsigned long resolution) const {
+	Kind kind;
+	int chrom;
+	unsigned long position, length;
+	describe(event, kind, chrom, position, length);
+	return containsEqual(kind, chrom, position, length, resolution);
+}
+
+void EventStore::describe(SomaticEvent *event, Kind& kind, int& chrom, unsigned long& position, unsigned long& length) {
+	GenomicRange extent = eventExtent(event);
+	kind = event->kind();
+	chrom = extent.chrom;
+	position = extent.position;
+	length = extent.length;
+}
@@ -0,0 +1,246 @@
+#ifndef EVENT_STORE_H
+#define EVENT_STORE_H
+
+/**
+ * @file EventStore.h
+ * Interface description of the data structure class EventStore
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "SomaticEvent.h"
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @brief Somatic events kept as columns
+	 *
+	 * Every event is a row across contiguous arrays of kind, chromosome, start,
+	 * length, frequency and cluster id, so that scans over frequency or position
+	 * walk memory linearly instead of chasing one heap object per event.
+	 *
+	 * The columns are a snapshot: rows appended from existing SomaticEvent objects
+	 * keep those objects as their handles (borrowed, never deleted by the store),
+	 * while event() materializes a CNV, LOH or SNP owned by the store for rows
+	 * that were appended from plain values. Changes made to a handle afterwards are
+	 * not reflected in the columns.
+	 *
+	 * After sortByPosition, overlap and equality lookups are binary searches
+	 * within the chromosome instead of a pass over all events.
+	 */
+	class EventStore {
+		public:
+			typedef SomaticEvent::Kind Kind; /**< The kind of an event row */
+
+		protected:
+			std::vector<uint8_t> _kinds; /**< Kind of each row */
+			std::vector<int> _chroms; /**< chromosome of each row */
+			std::vector<unsigned long> _positions; /**< start of each row */
+			std::vector<unsigned long> _lengths; /**< length of each row, 0 for point events */
+			std::vector<double> _frequencies; /**< frequency of each row */
+			std::vector<sqlite3_int64> _clusterIDs; /**< id of the cluster each row belongs to */
+
+			std::vector<SomaticEvent *> _handles; /**< object of each row, NULL if not yet materialized */
+			std::vector<bool> _owned; /**< whether the object of a row is deleted by the store */
+
+			bool _sorted; /**< whether the rows are ordered by (chrom, position) */
+			std::vector<unsigned long> _maxEnds; /**< largest end of the rows of the same chromosome so far, once sorted */
+
+			/**
+			 * The first row at or after (chrom, position), sorted stores only
+			 */
+			size_t lowerBound(int chrom, unsigned long position) const;
+
+			/**
+			 * The first row after (chrom, position), sorted stores only
+			 */
+			size_t upperBound(int chrom, unsigned long position) const;
+
+		public:
+			/**
+			 * Minimal constructor, making an empty store
+			 */
+			EventStore() : _sorted(true) {;}
+
+			/**
+			 * Destructor, releasing the objects materialized by the store
+			 */
+			~EventStore();
+
+			/**
+			 * Append a row from plain values
+			 *
+			 * @param kind The kind of the event
+			 * @param chrom The chromosome
+			 * @param position The 0-based start
+			 * @param length The length of the segment, ignored for point events
+			 * @param frequency The frequency of the event
+			 * @param clusterID The id of the cluster the event belongs to
+			 * @return The index of the new row
+			 */
+			size_t append(Kind kind, int chrom, unsigned long position, unsigned long length, double frequency, sqlite3_int64 clusterID=0);
+
+			/**
+			 * Append a row describing an existing event, which becomes its handle
+			 *
+			 * @param event The event, which the store does not take the ownership of
+			 * @return The index of the new row
+			 */
+			size_t append(SomaticEvent *event);
+
+			/**
+			 * Append a row for each of the events
+			 *
+			 * @param events The events, which the store does not take the ownership of
+			 */
+			void appendAll(const std::vector<SomaticEvent *>& events);
+
+			/**
+			 * Remove every row, releasing the materialized objects
+			 */
+			void clear();
+
+			/**
+			 * The number of rows
+			 */
+			inline size_t size() const {return _kinds.size();}
+
+			/**
+			 * The kind of a row
+			 */
+			inline Kind kind(size_t i) const {return (Kind)_kinds[i];}
+
+			/**
+			 * Retrieve the chromosome column
+			 */
+			inline const std::vector<int>& chroms() const {return _chroms;}
+
+			/**
+			 * Retrieve the start column
+			 */
+			inline const std::vector<unsigned long>& positions() const {return _positions;}
+
+			/**
+			 * Retrieve the length column
+			 */
+			inline const std::vector<unsigned long>& lengths() const {return _lengths;}
+
+			/**
+			 * Retrieve the frequency column
+			 */
+			inline const std::vector<double>& frequencies() const {return _frequencies;}
+
+			/**
+			 * Retrieve the cluster id column
+			 */
+			inline const std::vector<sqlite3_int64>& clusterIDs() const {return _clusterIDs;}
+
+			/**
+			 * The weight a row carries in a cluster, see EventCluster::addEvent
+			 *
+			 * @return the length of a segment, 1 for any other event
+			 */
+			inline unsigned long weight(size_t i) const {
+				return (_kinds[i] == SomaticEvent::KIND_CNV || _kinds[i] == SomaticEvent::KIND_LOH) ? _lengths[i] : 1;
+			}
+
+			/**
+			 * The object of a row, materialized on first use
+			 *
+			 * @param i The row index
+			 * @return The event the row was appended from, or a newly made one owned by the store;
+			 * NULL for a SomaticEvent::KIND_OTHER row appended from plain values
+			 */
+			SomaticEvent *event(size_t i);
+
+			/**
+			 * The objects of all rows, in row order
+			 *
+			 * @return the result of event(i) for every row
+			 */
+			std::vector<SomaticEvent *> events();
+
+			/**
+			 * Order the rows by (chrom, position, length), keeping their handles
+			 * with them, to enable the binary searched lookups
+			 */
+			void sortByPosition();
+
+			/**
+			 * Whether the rows are ordered by position
+			 */
+			inline bool isSorted() const {return _sorted;}
+
+			/**
+			 * Check if any row overlaps a range, with the closed interval semantics
+			 * of GenomicRange::overlaps. Point events are segments of length 0
+			 *
+			 * @param chrom The chromosome of the range
+			 * @param position The start of the range
+			 * @param length The length of the range
+			 * @return true if a row overlaps the range
+			 */
+			bool overlapsAny(int chrom, unsigned long position, unsigned long length) const;
+
+			/**
+			 * Check if any row equals an event, with the semantics of
+			 * SomaticEvent::isEqualTo: only CNVs are equal, if they are on the
+			 * same chromosome and both of their boundaries differ by less than
+			 * the resolution
+			 *
+			 * @return true if an equal row is found
+			 */
+			bool containsEqual(Kind kind, int chrom, unsigned long position, unsigned long length, unsigned long resolution) const;
+
+			/**
+			 * Check if any row equals an existing event
+			 *
+			 * @see containsEqual
+			 */
+			bool containsEqual(SomaticEvent *event, unsigned long resolution) const;
+
+			/**
+			 * Describe an event by its kind and location
+			 *
+			 * @param event The event to be described
+			 * @param kind The kind of the event
+			 * @param chrom The chromosome, 0 for events of no known subclass
+			 * @param position The start
+			 * @param length The length of a segment, 0 for any other event
+			 */
+			static void describe(SomaticEvent *event, Kind& kind, int& chrom, unsigned long& position, unsigned long& length);
+
+		private:
+			// the handles are not copyable
+			EventStore(const EventStore&);
+			EventStore& operator=(const EventStore&);
+	};
+}
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef EVENT_VISITOR_H
+#define EVENT_VISITOR_H
+
+/**
+ * @file EventVisitor.h
+ * Static dispatch over the concrete types of SomaticEvent
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "SomaticEvent.h"
+#include "SegmentalMutation.h"
+#include "SNP.h"
+#include <utility>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * Call the overload of a visitor matching the concrete type of an event
+	 *
+	 * The type is read from the kind tag, so dispatching is a switch and a
+	 * static_cast instead of a chain of dynamic_cast, and the overloads of the
+	 * visitor can be inlined. A visitor declares its result_type, and call
+	 * operators taking a const reference to CNV, LOH and SNP, or to one of their
+	 * bases; the one taking a SomaticEvent is called for KIND_OTHER.
+	 *
+	 * @param event The event to be visited
+	 * @param visitor The visitor
+	 * @return what the matching overload of the visitor returns
+	 */
+	template <class Visitor>
+	inline typename std::decay<Visitor>::type::result_type visitEvent(const SomaticEvent *event, Visitor&& visitor) {
+		switch(event->kind()) {
+			case SomaticEvent::KIND_CNV:
+				return visitor(*static_cast<const CNV *>(event));
+			case SomaticEvent::KIND_LOH:
+				return visitor(*static_cast<const LOH *>(event));
+			case SomaticEvent::KIND_SNP:
+				return visitor(*static_cast<const SNP *>(event));
+			default:
+				return visitor(*event);
+		}
+	}
+
+	/**
+	 * @brief The weight of an event in a cluster: the length of a segment, 1 otherwise
+	 */
+	struct EventWeight {
+		typedef unsigned long result_type;
+		inline result_type operator()(const SegmentalMutation& segment) const {return segment.range.length;}
+		inline result_type operator()(const SomaticEvent&) const {return 1;}
+	};
+
+	/**
+	 * @brief The genomic extent of an event: the range of a segment, the location
+	 * of a SNP as a range of length 0, and an empty range otherwise
+	 */
+	struct EventExtent {
+		typedef GenomicRange result_type;
+		inline result_type operator()(const SegmentalMutation& segment) const {return segment.range;}
+		inline result_type operator()(const SNP& snp) const {
+			GenomicRange extent;
+			extent.chrom = snp.location.chrom;
+			extent.position = snp.location.position;
+			return extent;
+		}
+		inline result_type operator()(const SomaticEvent&) const {return GenomicRange();}
+	};
+
+	/**
+	 * The weight an event carries in a cluster
+	 *
+	 * @see EventWeight
+	 */
+	inline unsigned long eventWeight(const SomaticEvent *event) {
+		return visitEvent(event, EventWeight());
+	}
+
+	/**
+	 * The genomic extent of an event
+	 *
+	 * @see EventExtent
+	 */
+	inline GenomicRange eventExtent(const SomaticEvent *event) {
+		return visitEvent(event, EventExtent());
+	}
+
+	/**
+	 * Whether an event is a segmental mutation
+	 */
+	inline bool isSegment(const SomaticEvent *event) {
+		return event->kind() == SomaticEvent::KIND_CNV || event->kind() == SomaticEvent::KIND_LOH;
+	}
+
+	/**
+	 * Check if two events are the same, as SomaticEvent::isEqualTo: only CNVs
+	 * are ever equal, if both of their boundaries lie within the resolution
+	 *
+	 * @param a The first event
+	 * @param b The second event
+	 * @param resolution The boundary resolution
+	 * @return whether the two events represent the same event
+	 */
+	inline bool eventsEqual(const SomaticEvent *a, const SomaticEvent *b, unsigned long resolution) {
+		if(a->kind() != SomaticEvent::KIND_CNV || b->kind() != SomaticEvent::KIND_CNV)
+			return false;
+		return static_cast<const CNV *>(a)->range.boundariesWithin(static_cast<const CNV *>(b)->range, resolution);
+	}
+}
+
+#endif
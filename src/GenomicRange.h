@@ -72,6 +72,28 @@ namespace SubcloneSeeker {
 				return true;
 			}
 
+			/**
+			 * Check if both boundaries of two GenomicRange lie within a resolution of each other
+			 *
+			 * @param another The other GenomicRange to check with
+			 * @param resolution The largest difference, exclusive, allowed at either boundary
+			 * @return true if they are on the same chromosome with close boundaries, or false
+			 */
+			inline bool boundariesWithin(const GenomicRange& another, unsigned long resolution) const {
+				if(another.chrom != chrom)
+					return false;
+
+				unsigned long startDiff = position > another.position ?
+					position - another.position : another.position - position;
+
+				unsigned long thisEnd = position + length;
+				unsigned long anotherEnd = another.position + another.length;
+				unsigned long endDiff = thisEnd > anotherEnd ?
+					thisEnd - anotherEnd : anotherEnd - thisEnd;
+
+				return startDiff < resolution && endDiff < resolution;
+			}
+
 			/**
 			 * GenomicRange compare operator ==
 			 *
@@ -0,0 +1,118 @@
+/**
+ * @file LazyTreeLoader.cc
+ * Implementation of the class LazyTreeLoader
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "LazyTreeLoader.h"
+#include "Subclone.h"
+#include "EventCluster.h"
+#include "SomaticEvent.h"
+#include <sstream>
+
+using namespace SubcloneSeeker;
+
+LazyTreeLoader::~LazyTreeLoader() {
+	for(std::map<sqlite3_int64, Subclone *>::iterator it = _subclones.begin(); it != _subclones.end(); it++)
+		delete it->second;
+	for(std::map<sqlite3_int64, EventCluster *>::iterator it = _clusters.begin(); it != _clusters.end(); it++)
+		delete it->second;
+	for(size_t i=0; i<_events.size(); i++)
+		delete _events[i];
+}
+
+Subclone *LazyTreeLoader::adoptSubclone(Subclone *clone) {
+	clone->_lazyLoader = this;
+	clone->_childrenPending = true;
+	clone->_clustersPending = true;
+	_subclones[clone->getId()] = clone;
+	return clone;
+}
+
+Subclone *LazyTreeLoader::subclone(sqlite3_int64 id) {
+	std::map<sqlite3_int64, Subclone *>::iterator it = _subclones.find(id);
+	if(it != _subclones.end())
+		return it->second;
+
+	Subclone *clone = new Subclone();
+	if(!clone->unarchiveObjectFromDB(_database, id)) {
+		delete clone;
+		return NULL;
+	}
+	return adoptSubclone(clone);
+}
+
+void LazyTreeLoader::loadChildren(Subclone *clone) {
+	std::ostringstream whereClause;
+	whereClause<<"parentId = "<<clone->getId();
+
+	ArchiveCursor<Subclone> cursor(_database, whereClause.str());
+	for(Subclone *child = cursor.next(); child != NULL; child = cursor.next()) {
+		// a child already handed out (by id) keeps its identity
+		std::map<sqlite3_int64, Subclone *>::iterator it = _subclones.find(child->getId());
+		if(it != _subclones.end()) {
+			delete child;
+			clone->addChild(it->second);
+		}
+		else
+			clone->addChild(adoptSubclone(child));
+	}
+}
+
+void LazyTreeLoader::loadClusters(Subclone *clone) {
+	EventCluster dummyCluster;
+	DBObjectID_vec clusterIDs = dummyCluster.allObjectsOfSubclone(_database, clone->getId());
+
+	for(size_t i=0; i<clusterIDs.size(); i++) {
+		std::map<sqlite3_int64, EventCluster *>::iterator it = _clusters.find(clusterIDs[i]);
+		if(it != _clusters.end()) {
+			clone->_eventClusters.push_back(it->second);
+			continue;
+		}
+
+		EventCluster *cluster = new EventCluster();
+		if(!cluster->unarchiveObjectFromDB(_database, clusterIDs[i])) {
+			delete cluster;
+			continue;
+		}
+
+		cluster->_lazyLoader = this;
+		cluster->_membersPending = true;
+		_clusters[clusterIDs[i]] = cluster;
+		clone->_eventClusters.push_back(cluster);
+	}
+}
+
+void LazyTreeLoader::loadMembers(EventCluster *cluster) {
+	DBObjectID_vec clusterIDs(1, cluster->getId());
+	SomaticEventPtr_vec events = SomaticEvent::unarchiveEventsOfClusters(_database, clusterIDs);
+
+	for(size_t i=0; i<events.size(); i++) {
+		cluster->addEvent(events[i], false);
+		_events.push_back(events[i]);
+	}
+}
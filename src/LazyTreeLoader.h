@@ -0,0 +1,119 @@
+#ifndef LAZY_TREE_LOADER_H
+#define LAZY_TREE_LOADER_H
+
+/**
+ * @file LazyTreeLoader.h
+ * Interface description of the class LazyTreeLoader
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "Archivable.h"
+#include <map>
+#include <vector>
+
+namespace SubcloneSeeker {
+
+	// forward declaration, so that pointers can be made
+	class Subclone;
+	class EventCluster;
+	class SomaticEvent;
+
+	/**
+	 * @brief Loads subclone trees from a database on demand
+	 *
+	 * Where SubcloneLoadTreeTraverser reads a whole tree up front, including every
+	 * cluster and event, the subclones returned by this loader only hold their own
+	 * record. Their children are read the first time they are accessed (through
+	 * getVecChildren, isLeaf or a traversal), their clusters the first time
+	 * vecEventCluster is called, and the events of a cluster the first time its
+	 * members are. Printing the shape and fractions of a tree therefore never
+	 * reads a cluster or an event.
+	 *
+	 * The loader is the object cache of one database connection: each record is
+	 * read at most once, so that a cluster shared by several subclones is a
+	 * single object, and the loader owns everything it returns. The objects are
+	 * freed with the loader, which must not outlive the connection, and must not
+	 * be freed by SubcloneFreeTreeTraverser.
+	 */
+	class LazyTreeLoader {
+		protected:
+			sqlite3 *_database; /**< the connection objects are read from */
+			std::map<sqlite3_int64, Subclone *> _subclones; /**< loaded subclones, by id */
+			std::map<sqlite3_int64, EventCluster *> _clusters; /**< loaded clusters, by id */
+			std::vector<SomaticEvent *> _events; /**< loaded events */
+
+			friend class Subclone;
+			friend class EventCluster;
+
+			/**
+			 * Register a subclone freshly read from the database, with its children and clusters pending
+			 */
+			Subclone *adoptSubclone(Subclone *clone);
+
+			/**
+			 * Read the children of a subclone
+			 */
+			void loadChildren(Subclone *clone);
+
+			/**
+			 * Read the clusters of a subclone, with their members pending
+			 */
+			void loadClusters(Subclone *clone);
+
+			/**
+			 * Read the member events of a cluster
+			 */
+			void loadMembers(EventCluster *cluster);
+
+		public:
+			/**
+			 * Constructor
+			 *
+			 * @param database An open sqlite3 database connection holding subclone trees in the row format
+			 */
+			LazyTreeLoader(sqlite3 *database): _database(database) {;}
+
+			/**
+			 * Destructor, freeing every object loaded
+			 */
+			~LazyTreeLoader();
+
+			/**
+			 * Retrieve a subclone, e.g. the root of a tree, without reading anything else
+			 *
+			 * @param id The database id of the subclone
+			 * @return the subclone, owned by the loader, or NULL if not found
+			 */
+			Subclone *subclone(sqlite3_int64 id);
+
+			inline size_t numLoadedSubclones() const {return _subclones.size();} /**< number of subclones read so far */
+			inline size_t numLoadedClusters() const {return _clusters.size();} /**< number of clusters read so far */
+			inline size_t numLoadedEvents() const {return _events.size();} /**< number of events read so far */
+	};
+}
+
+#endif
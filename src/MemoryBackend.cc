@@ -0,0 +1,318 @@
+/**
+ * @file MemoryBackend.cc
+ * Implementation of classes MemoryBackend and BinaryFileBackend
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "MemoryBackend.h"
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+
+using namespace SubcloneSeeker;
+
+/**********************************/
+/*        MemoryBackend           */
+/**********************************/
+
+MemoryBackend::Table *MemoryBackend::findTable(const TableSchema& schema) {
+	std::map<std::string, Table>::iterator it = _tables.find(schema.name);
+	if(it == _tables.end())
+		return NULL;
+	return &it->second;
+}
+
+bool MemoryBackend::tableExists(const TableSchema& schema) {
+	return findTable(schema) != NULL;
+}
+
+bool MemoryBackend::createTable(const TableSchema& schema) {
+	if(findTable(schema) != NULL)
+		return false;
+	_tables[schema.name].columns = schema.columns;
+	return true;
+}
+
+bool MemoryBackend::recordExists(const TableSchema& schema, sqlite3_int64 id) {
+	Table *table = findTable(schema);
+	return table != NULL && table->records.find(id) != table->records.end();
+}
+
+sqlite3_int64 MemoryBackend::insertRecord(const TableSchema& schema, const ArchiveRecord& record) {
+	Table *table = findTable(schema);
+	if(table == NULL)
+		return -5;
+	if(record.size() != table->columns.size())
+		return -6;
+
+	table->lastID++;
+	table->records[table->lastID] = record;
+	return table->lastID;
+}
+
+bool MemoryBackend::updateRecord(const TableSchema& schema, sqlite3_int64 id, const ArchiveRecord& record) {
+	Table *table = findTable(schema);
+	if(table == NULL || record.size() != table->columns.size())
+		return false;
+
+	std::map<sqlite3_int64, ArchiveRecord>::iterator it = table->records.find(id);
+	if(it == table->records.end())
+		return false;
+	it->second = record;
+	return true;
+}
+
+bool MemoryBackend::fetchRecord(const TableSchema& schema, sqlite3_int64 id, ArchiveRecord& record) {
+	Table *table = findTable(schema);
+	if(table == NULL)
+		return false;
+
+	std::map<sqlite3_int64, ArchiveRecord>::const_iterator it = table->records.find(id);
+	if(it == table->records.end())
+		return false;
+	record = it->second;
+	return true;
+}
+
+DBObjectID_vec MemoryBackend::allRecordIDs(const TableSchema& schema) {
+	DBObjectID_vec ids;
+	Table *table = findTable(schema);
+	if(table == NULL)
+		return ids;
+
+	std::map<sqlite3_int64, ArchiveRecord>::const_iterator it;
+	for(it = table->records.begin(); it != table->records.end(); it++)
+		ids.push_back(it->first);
+	return ids;
+}
+
+DBObjectID_vec MemoryBackend::recordIDsReferringTo(const TableSchema& schema, const std::string& column, sqlite3_int64 id) {
+	DBObjectID_vec ids;
+	Table *table = findTable(schema);
+	if(table == NULL)
+		return ids;
+
+	size_t pos;
+	for(pos = 0; pos < table->columns.size(); pos++)
+		if(table->columns[pos] == column)
+			break;
+	if(pos == table->columns.size())
+		return ids;
+
+	std::map<sqlite3_int64, ArchiveRecord>::const_iterator it;
+	for(it = table->records.begin(); it != table->records.end(); it++) {
+		bool refersToNothing = it->second.isNullAt(pos);
+		if((id > 0 && !refersToNothing && it->second.integerAt(pos) == id) || (id <= 0 && refersToNothing))
+			ids.push_back(it->first);
+	}
+	return ids;
+}
+
+/**********************************/
+/*       BinaryFileBackend        */
+/**********************************/
+
+const char BinaryFileBackend::Magic[8] = {'S', 'S', 'A', 'R', 'C', 'H', 'V', '\0'};
+const uint32_t BinaryFileBackend::Version;
+
+BinaryFileBackend::~BinaryFileBackend() {
+	if(_dirty && !_readOnly)
+		save();
+}
+
+bool BinaryFileBackend::isBackendFile(const char *filename) {
+	char magic[sizeof(Magic)];
+	FILE *fp = fopen(filename, "rb");
+	if(fp == NULL)
+		return false;
+	bool isBackend = fread(magic, sizeof(magic), 1, fp) == 1 && memcmp(magic, Magic, sizeof(Magic)) == 0;
+	fclose(fp);
+	return isBackend;
+}
+
+/**
+ * Write a value of fixed width
+ */
+template <class T>
+static bool writeValue(FILE *fp, const T& value) {
+	return fwrite(&value, sizeof(T), 1, fp) == 1;
+}
+
+/**
+ * Read a value of fixed width
+ */
+template <class T>
+static bool readValue(FILE *fp, T& value) {
+	return fread(&value, sizeof(T), 1, fp) == 1;
+}
+
+/**
+ * Write a length prefixed string
+ */
+static bool writeString(FILE *fp, const std::string& str) {
+	uint32_t length = str.size();
+	return writeValue(fp, length) && (length == 0 || fwrite(str.data(), 1, length, fp) == length);
+}
+
+/**
+ * Read a length prefixed string
+ */
+static bool readString(FILE *fp, std::string& str) {
+	uint32_t length;
+	if(!readValue(fp, length))
+		return false;
+	str.resize(length);
+	return length == 0 || fread(&str[0], 1, length, fp) == length;
+}
+
+bool BinaryFileBackend::open(const char *filename, bool readOnly) {
+	_tables.clear();
+	_filename = filename;
+	_readOnly = readOnly;
+	_dirty = false;
+
+	FILE *fp = fopen(filename, "rb");
+	if(fp == NULL)
+		return !readOnly;
+
+	char magic[sizeof(Magic)];
+	uint32_t version, numTables;
+	bool ok = fread(magic, sizeof(magic), 1, fp) == 1 && memcmp(magic, Magic, sizeof(Magic)) == 0 &&
+		readValue(fp, version) && version == Version && readValue(fp, numTables);
+
+	for(uint32_t t=0; ok && t<numTables; t++) {
+		std::string name;
+		uint32_t numColumns;
+		ok = readString(fp, name) && readValue(fp, numColumns);
+
+		Table& table = _tables[name];
+		table.columns.resize(ok ? numColumns : 0);
+		for(uint32_t c=0; ok && c<numColumns; c++)
+			ok = readString(fp, table.columns[c]);
+
+		uint64_t numRecords;
+		ok = ok && readValue(fp, table.lastID) && readValue(fp, numRecords);
+
+		for(uint64_t r=0; ok && r<numRecords; r++) {
+			sqlite3_int64 id;
+			ok = readValue(fp, id);
+			ArchiveRecord& record = table.records[id];
+
+			for(uint32_t c=0; ok && c<numColumns; c++) {
+				ArchiveValue value;
+				uint8_t type;
+				ok = readValue(fp, type);
+				value.type = (ArchiveValue::Type)type;
+				if(!ok)
+					break;
+				switch(value.type) {
+					case ArchiveValue::TYPE_INTEGER:
+						ok = readValue(fp, value.integer);
+						break;
+					case ArchiveValue::TYPE_REAL:
+						ok = readValue(fp, value.real);
+						break;
+					case ArchiveValue::TYPE_BLOB:
+						ok = readString(fp, value.blob);
+						break;
+					case ArchiveValue::TYPE_NULL:
+						break;
+					default:
+						ok = false;
+						break;
+				}
+				record.appendValue(value);
+			}
+		}
+	}
+
+	fclose(fp);
+	if(!ok)
+		_tables.clear();
+	return ok;
+}
+
+bool BinaryFileBackend::save() {
+	if(_readOnly)
+		return false;
+
+	FILE *fp = fopen(_filename.c_str(), "wb");
+	if(fp == NULL)
+		return false;
+
+	uint32_t numTables = _tables.size();
+	bool ok = fwrite(Magic, sizeof(Magic), 1, fp) == 1 && writeValue(fp, Version) && writeValue(fp, numTables);
+
+	std::map<std::string, Table>::const_iterator it;
+	for(it = _tables.begin(); ok && it != _tables.end(); it++) {
+		const Table& table = it->second;
+		uint32_t numColumns = table.columns.size();
+		ok = writeString(fp, it->first) && writeValue(fp, numColumns);
+		for(uint32_t c=0; ok && c<numColumns; c++)
+			ok = writeString(fp, table.columns[c]);
+
+		uint64_t numRecords = table.records.size();
+		ok = ok && writeValue(fp, table.lastID) && writeValue(fp, numRecords);
+
+		std::map<sqlite3_int64, ArchiveRecord>::const_iterator rit;
+		for(rit = table.records.begin(); ok && rit != table.records.end(); rit++) {
+			ok = writeValue(fp, rit->first);
+			for(size_t c=0; ok && c<rit->second.size(); c++) {
+				const ArchiveValue& value = rit->second[c];
+				uint8_t type = value.type;
+				ok = writeValue(fp, type);
+				if(ok && value.type == ArchiveValue::TYPE_INTEGER)
+					ok = writeValue(fp, value.integer);
+				else if(ok && value.type == ArchiveValue::TYPE_REAL)
+					ok = writeValue(fp, value.real);
+				else if(ok && value.type == ArchiveValue::TYPE_BLOB)
+					ok = writeString(fp, value.blob);
+			}
+		}
+	}
+
+	if(fclose(fp) != 0)
+		ok = false;
+	if(ok)
+		_dirty = false;
+	return ok;
+}
+
+bool BinaryFileBackend::createTable(const TableSchema& schema) {
+	_dirty = true;
+	return MemoryBackend::createTable(schema);
+}
+
+sqlite3_int64 BinaryFileBackend::insertRecord(const TableSchema& schema, const ArchiveRecord& record) {
+	_dirty = true;
+	return MemoryBackend::insertRecord(schema, record);
+}
+
+bool BinaryFileBackend::updateRecord(const TableSchema& schema, sqlite3_int64 id, const ArchiveRecord& record) {
+	_dirty = true;
+	return MemoryBackend::updateRecord(schema, id, record);
+}
@@ -0,0 +1,137 @@
+#ifndef MEMORY_BACKEND_H
+#define MEMORY_BACKEND_H
+
+/**
+ * @file MemoryBackend.h
+ * Interface description of the storage backends MemoryBackend and BinaryFileBackend
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "StorageBackend.h"
+#include <map>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @brief Keeps records in memory, without any database
+	 *
+	 * Lookups by reference scan the whole table; the backend is meant for tests and
+	 * in-process pipelines, where the tables are small or not read back at all.
+	 */
+	class MemoryBackend : public StorageBackend {
+		protected:
+			/** The content of a table */
+			struct Table {
+				std::vector<std::string> columns; /**< the column names, in record order */
+				std::map<sqlite3_int64, ArchiveRecord> records; /**< the records, by id */
+				sqlite3_int64 lastID; /**< the largest id ever given, ids are not reused */
+
+				Table() : lastID(0) {;}
+			};
+
+			std::map<std::string, Table> _tables; /**< the tables, by name */
+
+			/**
+			 * Find a table
+			 *
+			 * @return the table, NULL if it does not exist
+			 */
+			Table *findTable(const TableSchema& schema);
+
+		public:
+			// Implements StorageBackend
+			virtual bool tableExists(const TableSchema& schema);
+			virtual bool createTable(const TableSchema& schema);
+			virtual bool recordExists(const TableSchema& schema, sqlite3_int64 id);
+			virtual sqlite3_int64 insertRecord(const TableSchema& schema, const ArchiveRecord& record);
+			virtual bool updateRecord(const TableSchema& schema, sqlite3_int64 id, const ArchiveRecord& record);
+			virtual bool fetchRecord(const TableSchema& schema, sqlite3_int64 id, ArchiveRecord& record);
+			virtual DBObjectID_vec allRecordIDs(const TableSchema& schema);
+			virtual DBObjectID_vec recordIDsReferringTo(const TableSchema& schema, const std::string& column, sqlite3_int64 id);
+	};
+
+	/**
+	 * @brief A MemoryBackend loaded from, and saved to, a binary file
+	 *
+	 * The whole file is read when it is opened, and written back by save(), which is
+	 * also called on destruction unless the backend is read-only. The file starts
+	 * with Magic and a version, followed by each table: its name, its column names,
+	 * its last id and its records. A record is its id followed by its fields, each
+	 * a type byte and the value. Numbers are in host byte order.
+	 */
+	class BinaryFileBackend : public MemoryBackend {
+		protected:
+			std::string _filename; /**< the file the tables are saved to */
+			bool _readOnly; /**< whether the tables are never saved */
+			bool _dirty; /**< whether anything changed since the last save */
+
+		public:
+			static const char Magic[8]; /**< the first bytes of every backend file */
+			static const uint32_t Version = 1; /**< the format version written by this library */
+
+			/**
+			 * Constructor, does not touch the file
+			 */
+			BinaryFileBackend() : _readOnly(false), _dirty(false) {;}
+
+			/**
+			 * Destructor, saves the tables if they were changed
+			 */
+			virtual ~BinaryFileBackend();
+
+			/**
+			 * Check whether a file starts with the backend file magic
+			 *
+			 * @param filename The file to be checked
+			 * @return true if the file looks like a backend file
+			 */
+			static bool isBackendFile(const char *filename);
+
+			/**
+			 * Load the tables from a file. A missing file is an empty backend, unless read-only
+			 *
+			 * @param filename The backend file
+			 * @param readOnly Whether the tables are never written back
+			 * @return false if the file cannot be read or is not a backend file of this version
+			 */
+			bool open(const char *filename, bool readOnly = false);
+
+			/**
+			 * Write all tables to the file
+			 *
+			 * @return Whether the file has been written
+			 */
+			bool save();
+
+			// Overrides MemoryBackend, to keep track of changes
+			virtual bool createTable(const TableSchema& schema);
+			virtual sqlite3_int64 insertRecord(const TableSchema& schema, const ArchiveRecord& record);
+			virtual bool updateRecord(const TableSchema& schema, sqlite3_int64 id, const ArchiveRecord& record);
+	};
+}
+
+#endif
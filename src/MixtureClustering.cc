@@ -0,0 +1,360 @@
+/**
+ * @file MixtureClustering.cc
+ * Implementation of the helper class MixtureClustering
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "MixtureClustering.h"
+#include "EventCluster.h"
+#include "SomaticEvent.h"
+#include "EventStore.h"
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+
+using namespace SubcloneSeeker;
+
+#define DEFAULT_RESTARTS 4
+#define MAX_ITERATIONS 200
+#define CONVERGENCE 1e-5
+#define MIN_DEVIATION 1e-3
+
+MixtureClustering::MixtureClustering(Model model, double resolution):
+	_model(model), _resolution(resolution), _maxComponents(0), _restarts(DEFAULT_RESTARTS), _threads(0) {
+	_best.k = 0;
+}
+
+/**
+ * The smallest variance a component may have
+ */
+static double minVariance(double resolution) {
+	double deviation = std::max(resolution / 2, MIN_DEVIATION);
+	return deviation * deviation;
+}
+
+/**
+ * Log density of a normal distribution
+ */
+static double logNormal(double x, double mean, double variance) {
+	return -0.5 * (log(2 * M_PI * variance) + (x - mean) * (x - mean) / variance);
+}
+
+/**
+ * Seed the means of a fit: restart 0 spreads them over the weighted quantiles,
+ * later restarts use k-means++ with a generator seeded from (k, restart)
+ */
+static void seedMeans(const std::vector<double>& x, const std::vector<double>& w, size_t k, size_t restart, std::vector<double>& means) {
+	means.clear();
+
+	if(restart == 0) {
+		std::vector<size_t> order(x.size());
+		for(size_t i=0; i<order.size(); i++)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [&x](size_t a, size_t b) {return x[a] < x[b];});
+
+		double total = 0;
+		for(size_t i=0; i<w.size(); i++)
+			total += w[i];
+
+		double cumulative = 0;
+		size_t pos = 0;
+		for(size_t j=0; j<k; j++) {
+			double target = total * (j + 0.5) / k;
+			while(pos + 1 < order.size() && cumulative + w[order[pos]] < target)
+				cumulative += w[order[pos++]];
+			means.push_back(x[order[pos]]);
+		}
+		return;
+	}
+
+	std::mt19937 generator(k * 1000003 + restart);
+	std::vector<double> distance(x.size());
+	std::discrete_distribution<size_t> first(w.begin(), w.end());
+	means.push_back(x[first(generator)]);
+	while(means.size() < k) {
+		double total = 0;
+		for(size_t i=0; i<x.size(); i++) {
+			double nearest = HUGE_VAL;
+			for(size_t j=0; j<means.size(); j++)
+				nearest = std::min(nearest, (x[i] - means[j]) * (x[i] - means[j]));
+			distance[i] = w[i] * nearest;
+			total += distance[i];
+		}
+		// every point already is a mean
+		if(total <= 0) {
+			means.push_back(means.back());
+			continue;
+		}
+		std::discrete_distribution<size_t> next(distance.begin(), distance.end());
+		means.push_back(x[next(generator)]);
+	}
+}
+
+size_t MixtureClustering::component(const Fit& fit, double x) const {
+	size_t best = 0;
+	double bestScore = -HUGE_VAL;
+	for(size_t j=0; j<fit.k; j++) {
+		double score;
+		if(_model == MODEL_GMM)
+			score = log(fit.proportions[j]) + logNormal(x, fit.means[j], fit.variances[j]);
+		else
+			score = -fabs(x - fit.means[j]);
+		if(score > bestScore) {
+			bestScore = score;
+			best = j;
+		}
+	}
+	return best;
+}
+
+void MixtureClustering::fitKMeans(const std::vector<double>& x, const std::vector<double>& w, Fit& fit) const {
+	size_t n = x.size(), k = fit.k;
+	seedMeans(x, w, k, fit.restart, fit.means);
+
+	std::vector<size_t> assignment(n, k);
+	std::vector<double> sums(k), weights(k);
+	for(int iteration = 0; iteration < MAX_ITERATIONS; iteration++) {
+		bool changed = false;
+		for(size_t i=0; i<n; i++) {
+			size_t nearest = 0;
+			for(size_t j=1; j<k; j++)
+				if(fabs(x[i] - fit.means[j]) < fabs(x[i] - fit.means[nearest]))
+					nearest = j;
+			if(assignment[i] != nearest) {
+				assignment[i] = nearest;
+				changed = true;
+			}
+		}
+		if(!changed)
+			break;
+
+		std::fill(sums.begin(), sums.end(), 0);
+		std::fill(weights.begin(), weights.end(), 0);
+		for(size_t i=0; i<n; i++) {
+			sums[assignment[i]] += w[i] * x[i];
+			weights[assignment[i]] += w[i];
+		}
+		// an emptied component keeps its mean
+		for(size_t j=0; j<k; j++)
+			if(weights[j] > 0)
+				fit.means[j] = sums[j] / weights[j];
+	}
+
+	double total = 0, sse = 0;
+	std::fill(weights.begin(), weights.end(), 0);
+	for(size_t i=0; i<n; i++) {
+		weights[assignment[i]] += w[i];
+		sse += w[i] * (x[i] - fit.means[assignment[i]]) * (x[i] - fit.means[assignment[i]]);
+		total += w[i];
+	}
+	double variance = std::max(sse / total, minVariance(_resolution));
+
+	fit.variances.assign(k, variance);
+	fit.proportions.resize(k);
+	for(size_t j=0; j<k; j++)
+		fit.proportions[j] = weights[j] / total;
+
+	fit.logLikelihood = 0;
+	for(size_t i=0; i<n; i++)
+		fit.logLikelihood += w[i] * (log(fit.proportions[assignment[i]]) + logNormal(x[i], fit.means[assignment[i]], variance));
+
+	// k means, k-1 proportions and one variance
+	fit.bic = -2 * fit.logLikelihood + (2 * k) * log(total);
+}
+
+void MixtureClustering::fitGMM(const std::vector<double>& x, const std::vector<double>& w, Fit& fit) const {
+	size_t n = x.size(), k = fit.k;
+	double floor = minVariance(_resolution);
+
+	fitKMeans(x, w, fit);
+	for(size_t j=0; j<k; j++)
+		fit.proportions[j] = std::max(fit.proportions[j], 1e-6);
+
+	std::vector<double> resp(n * k);
+	std::vector<double> sumW(k), sumX(k), sumXX(k), logScale(k), precision(k);
+	double total = 0;
+	for(size_t i=0; i<n; i++)
+		total += w[i];
+
+	double previous = -HUGE_VAL;
+	for(int iteration = 0; iteration < MAX_ITERATIONS; iteration++) {
+		// E step, accumulating the log likelihood
+		for(size_t j=0; j<k; j++) {
+			logScale[j] = log(fit.proportions[j]) - 0.5 * log(2 * M_PI * fit.variances[j]);
+			precision[j] = 1 / fit.variances[j];
+		}
+
+		double logLikelihood = 0;
+		for(size_t i=0; i<n; i++) {
+			double *r = &resp[i * k];
+			double maxLog = -HUGE_VAL;
+			for(size_t j=0; j<k; j++) {
+				double d = x[i] - fit.means[j];
+				r[j] = logScale[j] - 0.5 * d * d * precision[j];
+				maxLog = std::max(maxLog, r[j]);
+			}
+			double sum = 0;
+			for(size_t j=0; j<k; j++) {
+				r[j] = exp(r[j] - maxLog);
+				sum += r[j];
+			}
+			for(size_t j=0; j<k; j++)
+				r[j] /= sum;
+			logLikelihood += w[i] * (maxLog + log(sum));
+		}
+		fit.logLikelihood = logLikelihood;
+
+		if(logLikelihood - previous <= CONVERGENCE * total)
+			break;
+		previous = logLikelihood;
+
+		// M step
+		std::fill(sumW.begin(), sumW.end(), 0);
+		std::fill(sumX.begin(), sumX.end(), 0);
+		std::fill(sumXX.begin(), sumXX.end(), 0);
+		for(size_t i=0; i<n; i++) {
+			for(size_t j=0; j<k; j++) {
+				double rw = resp[i * k + j] * w[i];
+				sumW[j] += rw;
+				sumX[j] += rw * x[i];
+				sumXX[j] += rw * x[i] * x[i];
+			}
+		}
+		for(size_t j=0; j<k; j++) {
+			if(sumW[j] <= 0)
+				continue;
+			fit.proportions[j] = std::max(sumW[j] / total, 1e-6);
+			fit.means[j] = sumX[j] / sumW[j];
+			fit.variances[j] = std::max(sumXX[j] / sumW[j] - fit.means[j] * fit.means[j], floor);
+		}
+	}
+
+	// k means, k variances and k-1 proportions
+	fit.bic = -2 * fit.logLikelihood + (3 * k - 1) * log(total);
+}
+
+MixtureClustering::Fit MixtureClustering::fit(const std::vector<double>& x, const std::vector<double>& w) {
+	_best = Fit();
+	_best.k = 0;
+	if(x.empty())
+		return _best;
+
+	size_t maxK = _maxComponents;
+	if(maxK == 0)
+		maxK = _resolution > 0 ? (size_t)(1 / _resolution) : x.size();
+	maxK = std::max((size_t)1, std::min(maxK, x.size()));
+
+	// normalize the weights to sum up to the number of events
+	double total = 0;
+	for(size_t i=0; i<w.size(); i++)
+		total += w[i];
+	std::vector<double> weights(w.size());
+	for(size_t i=0; i<w.size(); i++)
+		weights[i] = total > 0 ? w[i] * x.size() / total : 1;
+
+	// one job per (k, restart); k=1 has a single solution
+	std::vector<Fit> fits;
+	for(size_t k=1; k<=maxK; k++) {
+		for(size_t restart=0; restart < (k == 1 ? 1 : _restarts); restart++) {
+			Fit job;
+			job.k = k;
+			job.restart = restart;
+			fits.push_back(job);
+		}
+	}
+
+	std::atomic<size_t> nextJob(0);
+	auto worker = [&]() {
+		for(size_t job = nextJob++; job < fits.size(); job = nextJob++) {
+			if(_model == MODEL_GMM)
+				fitGMM(x, weights, fits[job]);
+			else
+				fitKMeans(x, weights, fits[job]);
+		}
+	};
+
+	size_t numThreads = _threads > 0 ? _threads : std::thread::hardware_concurrency();
+	numThreads = std::max((size_t)1, std::min(numThreads, fits.size()));
+	std::vector<std::thread> threads;
+	for(size_t t=1; t<numThreads; t++)
+		threads.push_back(std::thread(worker));
+	worker();
+	for(size_t t=0; t<threads.size(); t++)
+		threads[t].join();
+
+	// the first of the best, in (k, restart) order
+	size_t best = 0;
+	for(size_t i=1; i<fits.size(); i++)
+		if(fits[i].bic < fits[best].bic)
+			best = i;
+	_best = fits[best];
+	return _best;
+}
+
+std::vector<EventCluster *> MixtureClustering::cluster(const std::vector<SomaticEvent *>& events) {
+	EventStore store;
+	store.appendAll(events);
+	return cluster(store);
+}
+
+std::vector<EventCluster *> MixtureClustering::cluster(EventStore& store) {
+	std::vector<EventCluster *> clusters;
+
+	const std::vector<double>& x = store.frequencies();
+	std::vector<double> w(store.size());
+	for(size_t i=0; i<w.size(); i++)
+		w[i] = store.weight(i);
+
+	Fit selected = fit(x, w);
+	if(selected.k == 0)
+		return clusters;
+
+	// components by increasing mean; empty ones yield no cluster
+	std::vector<size_t> order(selected.k);
+	for(size_t j=0; j<order.size(); j++)
+		order[j] = j;
+	std::sort(order.begin(), order.end(), [&selected](size_t a, size_t b) {return selected.means[a] < selected.means[b];});
+
+	std::vector<EventCluster *> ofComponent(selected.k, (EventCluster *)NULL);
+	for(size_t j=0; j<order.size(); j++)
+		ofComponent[order[j]] = new EventCluster();
+
+	for(size_t i=0; i<store.size(); i++)
+		ofComponent[component(selected, x[i])]->addEvent(store.event(i));
+
+	for(size_t j=0; j<order.size(); j++) {
+		EventCluster *cluster = ofComponent[order[j]];
+		if(cluster->memberCount() > 0)
+			clusters.push_back(cluster);
+		else
+			delete cluster;
+	}
+
+	return clusters;
+}
@@ -0,0 +1,157 @@
+#ifndef MIXTURE_CLUSTERING_H
+#define MIXTURE_CLUSTERING_H
+
+/**
+ * @file MixtureClustering.h
+ * Interface description of the helper class MixtureClustering
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <vector>
+#include <stddef.h>
+
+namespace SubcloneSeeker {
+
+	// forward declaration, so that pointers can be made
+	class SomaticEvent;
+	class EventCluster;
+	class EventStore;
+
+	/**
+	 * @brief Model-based clustering of events by frequency, choosing the number of clusters by BIC
+	 *
+	 * Events are points on the frequency axis, weighted by their length (see
+	 * EventCluster::addEvent) and normalized so that the weights sum up to the
+	 * number of events. For every k from 1 to maxComponents, and for a number of
+	 * restarts, either a k-means model (one shared variance) or a Gaussian mixture
+	 * (one variance per component, fitted by EM from the k-means solution) is fitted,
+	 * and the fit with the lowest Bayesian Information Criterion is kept. The fits
+	 * are independent and spread over worker threads; each is seeded from (k, restart)
+	 * only, so the result does not depend on the number of threads.
+	 *
+	 * The resolution plays the role of the clustering threshold: no component is
+	 * narrower than half of it, and there are at most 1/resolution components.
+	 */
+	class MixtureClustering {
+		public:
+			/** The model fitted to the frequencies */
+			enum Model {
+				MODEL_KMEANS = 0, /**< k-means, hard assignments and one shared variance */
+				MODEL_GMM /**< Gaussian mixture, soft assignments and one variance per component */
+			};
+
+			/**
+			 * @brief One fitted model
+			 */
+			struct Fit {
+				size_t k; /**< number of components */
+				size_t restart; /**< restart the fit was seeded from */
+				std::vector<double> means; /**< mean frequency of each component */
+				std::vector<double> variances; /**< variance of each component */
+				std::vector<double> proportions; /**< mixing proportion of each component */
+				double logLikelihood; /**< weighted log likelihood of the frequencies */
+				double bic; /**< Bayesian Information Criterion, lower is better */
+			};
+
+		protected:
+			Model _model; /**< the model fitted */
+			double _resolution; /**< the smallest difference in frequency worth separating */
+			size_t _maxComponents; /**< largest k tried, 0 to derive it from the resolution */
+			size_t _restarts; /**< number of fits per k */
+			size_t _threads; /**< number of worker threads, 0 for one per core */
+			Fit _best; /**< the selected fit of the last run */
+
+			void fitKMeans(const std::vector<double>& x, const std::vector<double>& w, Fit& fit) const;
+			void fitGMM(const std::vector<double>& x, const std::vector<double>& w, Fit& fit) const;
+			size_t component(const Fit& fit, double x) const;
+
+		public:
+			/**
+			 * Constructor
+			 *
+			 * @param model The model to be fitted
+			 * @param resolution The smallest difference in frequency worth separating, like the clustering threshold
+			 */
+			MixtureClustering(Model model, double resolution);
+
+			/**
+			 * Set the largest number of components tried
+			 *
+			 * @param k The largest k, 0 (the default) for 1/resolution
+			 */
+			inline void setMaxComponents(size_t k) {_maxComponents = k;}
+
+			/**
+			 * Set the number of fits per number of components
+			 *
+			 * @param restarts The number of differently seeded fits, at least 1
+			 */
+			inline void setRestarts(size_t restarts) {_restarts = restarts > 0 ? restarts : 1;}
+
+			/**
+			 * Set the number of worker threads
+			 *
+			 * @param threads The number of threads, 0 (the default) for one per core
+			 */
+			inline void setThreads(size_t threads) {_threads = threads;}
+
+			/**
+			 * Fit the model to the events and group them by component
+			 *
+			 * @param events The events to be clustered
+			 * @return A vector of newly allocated EventCluster, by increasing fraction
+			 */
+			std::vector<EventCluster *> cluster(const std::vector<SomaticEvent *>& events);
+
+			/**
+			 * Fit the model to the frequency and length columns of a store and group
+			 * the rows by component
+			 *
+			 * @param store The events to be clustered, materialized if needed
+			 * @return A vector of newly allocated EventCluster, by increasing fraction
+			 */
+			std::vector<EventCluster *> cluster(EventStore& store);
+
+			/**
+			 * Fit the model to weighted frequencies
+			 *
+			 * @param x The frequencies
+			 * @param w The weight of each frequency
+			 * @return The fit with the lowest BIC
+			 */
+			Fit fit(const std::vector<double>& x, const std::vector<double>& w);
+
+			/**
+			 * The fit selected by the last run
+			 *
+			 * @return a reference to the fit, k is 0 if nothing was fitted
+			 */
+			inline const Fit& selected() const {return _best;}
+	};
+}
+
+#endif
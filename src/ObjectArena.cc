@@ -0,0 +1,82 @@
+/**
+ * @file ObjectArena.cc
+ * Implementation of class ObjectArena
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "ObjectArena.h"
+#include <cstdlib>
+
+using namespace SubcloneSeeker;
+
+ObjectArena::ObjectArena(size_t blockSize): _current(0), _offset(0), _blockSize(blockSize > 0 ? blockSize : 1) {;}
+
+ObjectArena::~ObjectArena() {
+	reset();
+	for(size_t i=0; i<_blocks.size(); i++)
+		free(_blocks[i].memory);
+}
+
+void *ObjectArena::allocate(size_t size, size_t alignment) {
+	while(_current < _blocks.size()) {
+		size_t start = (_offset + alignment - 1) / alignment * alignment;
+		if(start + size <= _blocks[_current].size) {
+			_offset = start + size;
+			return _blocks[_current].memory + start;
+		}
+		_current++;
+		_offset = 0;
+	}
+
+	// malloc aligns for any fundamental type, so the new block starts aligned
+	Block block;
+	block.size = size > _blockSize ? size : _blockSize;
+	block.memory = (char *)malloc(block.size);
+	if(block.memory == NULL)
+		throw std::bad_alloc();
+	_blocks.push_back(block);
+
+	_current = _blocks.size() - 1;
+	_offset = size;
+	return block.memory;
+}
+
+void ObjectArena::reset() {
+	for(size_t i=_destructors.size(); i>0; i--)
+		_destructors[i-1].destroy(_destructors[i-1].object);
+	_destructors.clear();
+
+	_current = 0;
+	_offset = 0;
+}
+
+size_t ObjectArena::capacity() const {
+	size_t total = 0;
+	for(size_t i=0; i<_blocks.size(); i++)
+		total += _blocks[i].size;
+	return total;
+}
@@ -0,0 +1,148 @@
+#ifndef OBJECT_ARENA_H
+#define OBJECT_ARENA_H
+
+/**
+ * @file ObjectArena.h
+ * Interface description of the helper class ObjectArena
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <vector>
+#include <new>
+#include <stddef.h>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @brief A bump pointer allocator owning short lived objects
+	 *
+	 * Objects made by the arena are placed one after another in large memory
+	 * blocks, and are destroyed all at once, in reverse order of creation, by
+	 * reset() or the destructor of the arena. They must never be deleted on their
+	 * own. The blocks are kept across resets, so a loop that resets the arena once
+	 * per iteration (per tree, per tree pair) only holds the memory of its largest
+	 * iteration.
+	 *
+	 * Code that may or may not be given an arena allocates through create(), which
+	 * falls back to plain new when the arena is NULL.
+	 */
+	class ObjectArena {
+		protected:
+			/**
+			 * @brief A contiguous chunk of memory objects are placed in
+			 */
+			struct Block {
+				char *memory; /**< start of the block */
+				size_t size; /**< size of the block in bytes */
+			};
+
+			/**
+			 * @brief How to destroy an object made by the arena
+			 */
+			struct Destructor {
+				void *object; /**< the object */
+				void (*destroy)(void *); /**< calls the destructor of its type */
+			};
+
+			std::vector<Block> _blocks; /**< all blocks, in order of use */
+			size_t _current; /**< index of the block being filled */
+			size_t _offset; /**< first free byte in the current block */
+			size_t _blockSize; /**< the size of a regular block */
+			std::vector<Destructor> _destructors; /**< one entry per live object, in order of creation */
+
+			/**
+			 * Reserve aligned memory, moving on to the next block, or adding a new one, when needed
+			 */
+			void *allocate(size_t size, size_t alignment);
+
+			/**
+			 * Destructor thunk of an object of type T
+			 */
+			template <class T>
+			static void destroy(void *object) {static_cast<T *>(object)->~T();}
+
+		public:
+			/**
+			 * Constructor
+			 *
+			 * @param blockSize The size of the memory blocks; larger objects get a block of their own
+			 */
+			ObjectArena(size_t blockSize = 64 * 1024);
+
+			/**
+			 * Destructor, destroying the objects and releasing the memory
+			 */
+			~ObjectArena();
+
+			/**
+			 * Make a default constructed object in the arena
+			 *
+			 * @return the new object, owned by the arena
+			 */
+			template <class T>
+			T *make() {
+				void *memory = allocate(sizeof(T), __alignof__(T));
+				T *object = new(memory) T();
+				Destructor destructor = {object, &destroy<T>};
+				_destructors.push_back(destructor);
+				return object;
+			}
+
+			/**
+			 * Make an object in an arena if given one, on the heap otherwise
+			 *
+			 * @param arena The arena, or NULL
+			 * @return the new object, owned by the arena or by the caller
+			 */
+			template <class T>
+			static T *create(ObjectArena *arena) {
+				return arena != NULL ? arena->make<T>() : new T();
+			}
+
+			/**
+			 * Destroy every object made so far, keeping the blocks for the next ones
+			 */
+			void reset();
+
+			/**
+			 * The number of live objects
+			 */
+			inline size_t objectCount() const {return _destructors.size();}
+
+			/**
+			 * The memory held by the arena, in bytes
+			 */
+			size_t capacity() const;
+
+		private:
+			// the objects are owned by exactly one arena
+			ObjectArena(const ObjectArena&);
+			ObjectArena& operator=(const ObjectArena&);
+	};
+}
+
+#endif
@@ -32,45 +32,24 @@ THE SOFTWARE.
 
 using namespace SubcloneSeeker;
 
-std::string SNP::getTableName() {
-	return "Events_SNP";
+const TableSchema& SNP::tableSchema() {
+	static const TableSchema schema("Events_SNP", Fields);
+	return schema;
 }
 
-std::string SNP::createObjectStatementStr() {
-	return "INSERT INTO " + getTableName() + " (frequency, chrom, start, ofClusterID) VALUES (?,?,?,?);";
+void SNP::encodeObject(ArchiveRecord& record) {
+	record.appendReal(frequency);
+	record.appendInteger(location.chrom);
+	record.appendInteger(location.position);
+	record.appendNull();
+	record.appendIDOrNull(ofClusterID);
 }
 
-std::string SNP::updateObjectStatementStr() {
-	return "UPDATE " + getTableName() + " SET frequency=?, chrom=?, start=?, ofClusterID=? WHERE id=?;";
-}
-
-std::string SNP::selectObjectColumnListStr() {
-	return "frequency, chrom, start, ofClusterID";
-}
-
-int SNP::bindObjectToStatement(sqlite3_stmt *statement) {
-	int bind_loc = 1;
-	sqlite3_bind_double(statement, bind_loc++, frequency);
-	sqlite3_bind_int(statement, bind_loc++, location.chrom);
-	sqlite3_bind_int64(statement, bind_loc++, location.position);
-	if(ofClusterID > 0) {
-		sqlite3_bind_int64(statement, bind_loc++, ofClusterID);
-	}
-	else {
-		sqlite3_bind_null(statement, bind_loc++);
-	}
-	return bind_loc;
-}
-
-void SNP::updateObjectFromStatement(sqlite3_stmt *statement) {
+void SNP::decodeObject(const ArchiveRecord& record) {
 	int col_pos = 0;
-	frequency = sqlite3_column_double(statement, col_pos++);
-	location.chrom = sqlite3_column_int(statement, col_pos++);
-	location.position = sqlite3_column_int64(statement, col_pos++);
-	if(sqlite3_column_type(statement, col_pos) != SQLITE_NULL) {
-		ofClusterID = sqlite3_column_int64(statement, col_pos++);
-	}
-	else {
-		ofClusterID = 0;
-	}
+	frequency = record.realAt(col_pos++);
+	location.chrom = record.integerAt(col_pos++);
+	location.position = record.integerAt(col_pos++);
+	col_pos++; // length
+	ofClusterID = record.integerAt(col_pos++);
 }
@@ -45,16 +45,18 @@ namespace SubcloneSeeker {
 	class SNP : public SomaticEvent {
 		protected:
 			// Implements Archivable
-			virtual std::string getTableName();
-			virtual std::string createObjectStatementStr();
-			virtual std::string updateObjectStatementStr();
-			virtual std::string selectObjectColumnListStr();
-			virtual int bindObjectToStatement(sqlite3_stmt *);
-			virtual void updateObjectFromStatement(sqlite3_stmt *);
+			virtual const TableSchema& tableSchema();
+			virtual void encodeObject(ArchiveRecord& record);
+			virtual void decodeObject(const ArchiveRecord& record);
 
 
 		public:
 			GenomicLocation location; /**< At which location did the SNP occurred */
+
+			/**
+			 * minimal constructor to reset all member variables
+			 */
+			SNP() : SomaticEvent(KIND_SNP), location() {}
 	};
 }
 
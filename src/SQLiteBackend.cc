@@ -0,0 +1,239 @@
+/**
+ * @file SQLiteBackend.cc
+ * Implementation of class SQLiteBackend
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "SQLiteBackend.h"
+#include "CohortDB.h"
+#include <sstream>
+
+using namespace SubcloneSeeker;
+
+SQLiteBackend::~SQLiteBackend() {
+	std::map<std::string, sqlite3_stmt *>::iterator it;
+	for(it = _statements.begin(); it != _statements.end(); it++)
+		sqlite3_finalize(it->second);
+
+	if(_ownsDatabase)
+		sqlite3_close(_database);
+}
+
+sqlite3_stmt *SQLiteBackend::cachedStatement(const std::string& sql) {
+	std::map<std::string, sqlite3_stmt *>::iterator it = _statements.find(sql);
+	if(it != _statements.end()) {
+		sqlite3_reset(it->second);
+		sqlite3_clear_bindings(it->second);
+		return it->second;
+	}
+
+	sqlite3_stmt *statement;
+	if(sqlite3_prepare_v2(_database, sql.c_str(), -1, &statement, 0) != SQLITE_OK) {
+		sqlite3_finalize(statement);
+		return NULL;
+	}
+
+	_statements[sql] = statement;
+	return statement;
+}
+
+/**
+ * The insert statement of a table in a cohort sample. The tables of a sample
+ * are read-only views, so records are written to the main database directly.
+ */
+static std::string scopedInsertSQL(const TableSchema& schema, sqlite3_int64 sample) {
+	std::ostringstream sql;
+	sql<<"INSERT INTO main."<<schema.name<<" (sampleID, "<<schema.selectColumnsSQL<<") VALUES ("<<sample;
+	for(size_t i=0; i<schema.columns.size(); i++)
+		sql<<", ?";
+	sql<<");";
+	return sql.str();
+}
+
+/**
+ * The update statement of a table in a cohort sample, with the id bound last
+ */
+static std::string scopedUpdateSQL(const TableSchema& schema, sqlite3_int64 sample) {
+	std::ostringstream sql;
+	sql<<"UPDATE main."<<schema.name<<" SET ";
+	for(size_t i=0; i<schema.columns.size(); i++)
+		sql<<(i > 0 ? ", " : "")<<schema.columns[i]<<"=?";
+	sql<<" WHERE id=? AND sampleID="<<sample<<";";
+	return sql.str();
+}
+
+sqlite3_int64 SQLiteBackend::scopedSample() {
+	if(!_sampleChecked) {
+		_sample = CohortDB::currentSample(_database);
+		_sampleChecked = true;
+	}
+	return _sample;
+}
+
+bool SQLiteBackend::tableExists(const TableSchema& schema) {
+	if(_knownTables.count(schema.name) > 0)
+		return true;
+
+	sqlite3_stmt *statement = cachedStatement("SELECT name FROM sqlite_master WHERE type='table' AND name=?;");
+	if(statement == NULL)
+		return false;
+
+	sqlite3_bind_text(statement, 1, schema.name.c_str(), -1, SQLITE_STATIC);
+	int rc = sqlite3_step(statement);
+	sqlite3_reset(statement);
+
+	if(rc != SQLITE_ROW)
+		return false;
+
+	_knownTables.insert(schema.name);
+	return true;
+}
+
+bool SQLiteBackend::createTable(const TableSchema& schema) {
+	// in a cohort sample, every table and index gets a leading sampleID
+	bool scoped = scopedSample() > 0;
+	std::string id_str = "id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT";
+	if(scoped)
+		id_str += std::string(", ") + CohortDB::SampleColumnDefinition;
+	std::string stmt_str = "CREATE TABLE main." + schema.name + " ( " + id_str + schema.createColumnsSQL + ");";
+
+	if(sqlite3_exec(_database, stmt_str.c_str(), 0, 0, 0) != SQLITE_OK)
+		return false;
+
+	// create the indexes requested by the concrete class
+	for(size_t i=0; i<schema.indexedColumns.size(); i++) {
+		std::string index_str = "CREATE INDEX main." + schema.name + "_" + schema.indexedColumns[i] + " ON " + schema.name +
+			" (" + (scoped ? "sampleID, " : "") + schema.indexedColumns[i] + ");";
+		if(sqlite3_exec(_database, index_str.c_str(), 0, 0, 0) != SQLITE_OK)
+			return false;
+	}
+
+	if(scoped && !CohortDB::scopeTable(_database, schema.name))
+		return false;
+
+	_knownTables.insert(schema.name);
+	return true;
+}
+
+bool SQLiteBackend::recordExists(const TableSchema& schema, sqlite3_int64 id) {
+	sqlite3_stmt *statement = cachedStatement("SELECT id FROM " + schema.name + " WHERE id=?;");
+	if(statement == NULL)
+		return false;
+
+	sqlite3_bind_int64(statement, 1, id);
+	int rc = sqlite3_step(statement);
+	sqlite3_reset(statement);
+	return rc == SQLITE_ROW;
+}
+
+sqlite3_int64 SQLiteBackend::insertRecord(const TableSchema& schema, const ArchiveRecord& record) {
+	// a record short of a column would otherwise leave a binding unset
+	if(record.size() != schema.columns.size())
+		return -5;
+
+	sqlite3_int64 sample = scopedSample();
+	sqlite3_stmt *statement = cachedStatement(sample > 0 ? scopedInsertSQL(schema, sample) : schema.insertSQL);
+	if(statement == NULL)
+		return -5;
+
+	record.bindToStatement(statement);
+
+	// the blobs are bound without a copy, and do not outlive the record
+	int rc = sqlite3_step(statement);
+	sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+	if(rc != SQLITE_DONE) {
+		return -6;
+	}
+
+	return sqlite3_last_insert_rowid(_database);
+}
+
+bool SQLiteBackend::updateRecord(const TableSchema& schema, sqlite3_int64 id, const ArchiveRecord& record) {
+	if(record.size() != schema.columns.size())
+		return false;
+
+	sqlite3_int64 sample = scopedSample();
+	sqlite3_stmt *statement = cachedStatement(sample > 0 ? scopedUpdateSQL(schema, sample) : schema.updateSQL);
+	if(statement == NULL)
+		return false;
+
+	int bind_pos = record.bindToStatement(statement);
+	sqlite3_bind_int64(statement, bind_pos, id);
+
+	int rc = sqlite3_step(statement);
+	sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+	return rc == SQLITE_DONE;
+}
+
+bool SQLiteBackend::fetchRecord(const TableSchema& schema, sqlite3_int64 id, ArchiveRecord& record) {
+	sqlite3_stmt *statement = cachedStatement(schema.selectSQL);
+	if(statement == NULL)
+		return false;
+
+	sqlite3_bind_int64(statement, 1, id);
+	int rc = sqlite3_step(statement);
+	if(rc == SQLITE_ROW)
+		record.readFromStatement(statement, sqlite3_column_count(statement));
+
+	sqlite3_reset(statement);
+	return rc == SQLITE_ROW;
+}
+
+/**
+ * Run a query returning a single id column
+ */
+static DBObjectID_vec queryIDs(sqlite3 *database, const std::string& query_str, bool bindValue, sqlite3_int64 value) {
+	sqlite3_stmt* statement;
+	DBObjectID_vec ret;
+
+	int rc = sqlite3_prepare_v2(database, query_str.c_str(), -1, &statement, 0);
+	if(rc != SQLITE_OK) {
+		sqlite3_finalize(statement);
+		return ret;
+	}
+
+	if(bindValue)
+		sqlite3_bind_int64(statement, 1, value);
+
+	while((rc = sqlite3_step(statement)) == SQLITE_ROW) 
+		ret.push_back(sqlite3_column_int64(statement, 0));
+
+	sqlite3_finalize(statement);
+	return ret;
+}
+
+DBObjectID_vec SQLiteBackend::allRecordIDs(const TableSchema& schema) {
+	return queryIDs(_database, "SELECT id FROM " + schema.name + ";", false, 0);
+}
+
+DBObjectID_vec SQLiteBackend::recordIDsReferringTo(const TableSchema& schema, const std::string& column, sqlite3_int64 id) {
+	if(id > 0)
+		return queryIDs(_database, "SELECT id FROM " + schema.name + " WHERE " + column + "=? ORDER BY id;", true, id);
+	return queryIDs(_database, "SELECT id FROM " + schema.name + " WHERE " + column + " IS NULL ORDER BY id;", false, 0);
+}
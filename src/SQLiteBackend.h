@@ -0,0 +1,115 @@
+#ifndef SQLITE_BACKEND_H
+#define SQLITE_BACKEND_H
+
+/**
+ * @file SQLiteBackend.h
+ * Interface description of the storage backend SQLiteBackend
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "StorageBackend.h"
+#include <map>
+#include <set>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @brief Stores records in a sqlite3 database, one table per Archivable class
+	 *
+	 * This is the schema the tools have always written: an AUTOINCREMENT id column
+	 * followed by the columns of the class, and NULL for unset references.
+	 *
+	 * Statements are prepared once per backend and reused, and tables are only
+	 * looked up in sqlite_master until they are known to exist, so that archiving
+	 * many objects through the same backend does not pay for either again. The
+	 * sqlite3* methods of Archivable use a backend for the one call only, so that
+	 * nothing stays prepared on connections closed by sqlite3_close.
+	 *
+	 * On a connection scoped to a sample of a cohort database (see CohortDB),
+	 * tables are created with the cohort layout and records are written with the
+	 * sample id; the sample should be entered before the backend archives its
+	 * first object.
+	 */
+	class SQLiteBackend : public StorageBackend {
+		protected:
+			sqlite3 *_database; /**< the connection records are stored through */
+			bool _ownsDatabase; /**< whether the connection is closed with the backend */
+			std::set<std::string> _knownTables; /**< tables known to exist */
+			std::map<std::string, sqlite3_stmt *> _statements; /**< prepared statements, by SQL text */
+			sqlite3_int64 _sample; /**< the cohort sample the connection is scoped to, 0 if none */
+			bool _sampleChecked; /**< whether _sample has been looked up */
+
+			/**
+			 * The cohort sample the connection is scoped to, looked up once
+			 *
+			 * @return the id of the sample, 0 if none
+			 */
+			sqlite3_int64 scopedSample();
+
+			/**
+			 * Get a prepared statement, preparing it on first use
+			 *
+			 * The statement is returned reset and without bindings; callers reset it
+			 * again once done, so that it holds no lock while cached.
+			 *
+			 * @param sql The SQL text of the statement
+			 * @return the statement, NULL if it cannot be prepared
+			 */
+			sqlite3_stmt *cachedStatement(const std::string& sql);
+
+		public:
+			/**
+			 * Constructor
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @param ownsDatabase Whether the connection is closed when the backend is destroyed
+			 */
+			SQLiteBackend(sqlite3 *database, bool ownsDatabase = false) : _database(database), _ownsDatabase(ownsDatabase),
+				_sample(0), _sampleChecked(false) {;}
+
+			virtual ~SQLiteBackend();
+
+			/**
+			 * The underlying connection
+			 *
+			 * @return the sqlite3 connection handle
+			 */
+			inline sqlite3 *database() const {return _database;}
+
+			// Implements StorageBackend
+			virtual bool tableExists(const TableSchema& schema);
+			virtual bool createTable(const TableSchema& schema);
+			virtual bool recordExists(const TableSchema& schema, sqlite3_int64 id);
+			virtual sqlite3_int64 insertRecord(const TableSchema& schema, const ArchiveRecord& record);
+			virtual bool updateRecord(const TableSchema& schema, sqlite3_int64 id, const ArchiveRecord& record);
+			virtual bool fetchRecord(const TableSchema& schema, sqlite3_int64 id, ArchiveRecord& record);
+			virtual DBObjectID_vec allRecordIDs(const TableSchema& schema);
+			virtual DBObjectID_vec recordIDsReferringTo(const TableSchema& schema, const std::string& column, sqlite3_int64 id);
+	};
+}
+
+#endif
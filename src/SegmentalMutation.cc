@@ -29,83 +29,38 @@ THE SOFTWARE.
 */
 
 #include "SegmentalMutation.h"
+#include "EventVisitor.h"
 #include <iostream>
 
 using namespace SubcloneSeeker;
 
-std::string SegmentalMutation::createObjectStatementStr() {
-	return "INSERT INTO " + getTableName() + " (frequency, chrom, start, length, ofClusterID) VALUES (?,?,?,?,?);";
+void SegmentalMutation::encodeObject(ArchiveRecord& record) {
+	record.appendReal(frequency);
+	record.appendInteger(range.chrom);
+	record.appendInteger(range.position);
+	record.appendInteger(range.length);
+	record.appendIDOrNull(ofClusterID);
 }
 
-std::string SegmentalMutation::updateObjectStatementStr() {
-	return "UPDATE " + getTableName() + " SET frequency=?, chrom=?, start=?, length=?, ofClusterID=? WHERE id=?;";
-}
-
-std::string SegmentalMutation::selectObjectColumnListStr() {
-	return "frequency, chrom, start, length, ofClusterID";
-}
-
-int SegmentalMutation::bindObjectToStatement(sqlite3_stmt *statement) {
-	int bind_loc = 1;
-	sqlite3_bind_double(statement, bind_loc++, frequency);
-	sqlite3_bind_int(statement, bind_loc++, range.chrom);
-	sqlite3_bind_int64(statement, bind_loc++, range.position);
-	sqlite3_bind_int64(statement, bind_loc++, range.length);
-	if(ofClusterID > 0) {
-		sqlite3_bind_int64(statement, bind_loc++, ofClusterID);
-	}
-	else {
-		sqlite3_bind_null(statement, bind_loc++);
-	}
-	return bind_loc;
-}
-
-void SegmentalMutation::updateObjectFromStatement(sqlite3_stmt *statement) {
+void SegmentalMutation::decodeObject(const ArchiveRecord& record) {
 	int col_pos = 0;
-	frequency = sqlite3_column_double(statement, col_pos++);
-	range.chrom = sqlite3_column_int(statement, col_pos++);
-	range.position = sqlite3_column_int64(statement, col_pos++);
-	range.length = sqlite3_column_int64(statement, col_pos++);
-
-	if(sqlite3_column_type(statement, col_pos) != SQLITE_NULL) {
-		ofClusterID = sqlite3_column_int64(statement, col_pos++);
-	}
-	else {
-		ofClusterID = 0;
-	}
+	frequency = record.realAt(col_pos++);
+	range.chrom = record.integerAt(col_pos++);
+	range.position = record.integerAt(col_pos++);
+	range.length = record.integerAt(col_pos++);
+	ofClusterID = record.integerAt(col_pos++);
 }
 
 bool CNV::isEqualTo(SomaticEvent * anotherEvent, unsigned long resolution) {
-	CNV *cnvEvent = dynamic_cast<CNV*>(anotherEvent);
-
-	if(cnvEvent == NULL) {
-		return false; 
-	}
-
-	if(range.chrom != cnvEvent->range.chrom) {
-		return false; 
-	}
-
-	unsigned long startDiff = range.position > cnvEvent->range.position?
-		range.position - cnvEvent->range.position:
-		cnvEvent->range.position - range.position;
-
-	unsigned long thisEnd = range.position + range.length;
-	unsigned long anotherEnd = cnvEvent->range.position + cnvEvent->range.length;
-	unsigned long endDiff = thisEnd > anotherEnd ? 
-		thisEnd - anotherEnd :
-		anotherEnd - thisEnd;
-
-	if(startDiff < resolution && endDiff < resolution)
-		return true;
-
-	return false;
+	return eventsEqual(this, anotherEvent, resolution);
 }
 
-std::string CNV::getTableName() {
-	return "Events_CNV";
+const TableSchema& CNV::tableSchema() {
+	static const TableSchema schema("Events_CNV", Fields);
+	return schema;
 }
 
-std::string LOH::getTableName() {
-	return "Events_LOH";
+const TableSchema& LOH::tableSchema() {
+	static const TableSchema schema("Events_LOH", Fields);
+	return schema;
 }
@@ -48,19 +48,18 @@ namespace SubcloneSeeker {
 	class SegmentalMutation : public SomaticEvent{
 		protected:
 			// Implements Archivable
-			virtual std::string createObjectStatementStr();
-			virtual std::string updateObjectStatementStr();
-			virtual std::string selectObjectColumnListStr();
-			virtual int bindObjectToStatement(sqlite3_stmt *);
-			virtual void updateObjectFromStatement(sqlite3_stmt *);
+			virtual void encodeObject(ArchiveRecord& record);
+			virtual void decodeObject(const ArchiveRecord& record);
 
 		public:
 			GenomicRange range; /**< Genomic range over which the mutation occurred */
 
 			/**
 			 * minimal constructor to reset all member variables 
+			 *
+			 * @param kind The concrete type, given by the constructor of the subclass
 			 */
-			SegmentalMutation() : SomaticEvent(), range() {}
+			SegmentalMutation(Kind kind = KIND_OTHER) : SomaticEvent(kind), range() {}
 
 
 	};
@@ -74,10 +73,15 @@ namespace SubcloneSeeker {
 	 */
 	class CNV : public SegmentalMutation {
 		protected:
-			// Overwrite Archivable tableName
-			virtual std::string getTableName();
+			// Implements Archivable
+			virtual const TableSchema& tableSchema();
 
 		public:
+			/**
+			 * minimal constructor to reset all member variables
+			 */
+			CNV() : SegmentalMutation(KIND_CNV) {}
+
 			// Override isEqualTo
 			virtual bool isEqualTo(SomaticEvent * anotherEvent, unsigned long resolution=10000L);
 	};
@@ -92,9 +96,14 @@ namespace SubcloneSeeker {
 	 */
 	class LOH : public SegmentalMutation {
 		protected:
-			// Overwrite Archivable tableName
-			virtual std::string getTableName();
-	
+			// Implements Archivable
+			virtual const TableSchema& tableSchema();
+
+		public:
+			/**
+			 * minimal constructor to reset all member variables
+			 */
+			LOH() : SegmentalMutation(KIND_LOH) {}
 	};
 }
 
@@ -0,0 +1,83 @@
+#ifndef SHARD_SPEC_H
+#define SHARD_SPEC_H
+
+/**
+ * @file ShardSpec.h
+ * Interface description of the helper class ShardSpec
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <stdint.h>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @brief One slice of a workload that is split across several runs
+	 *
+	 * A workload of a known number of items, numbered in the order a single run
+	 * would process them, is cut into count contiguous blocks of (nearly) equal
+	 * size; shard index owns the index-th block. As the blocks are contiguous,
+	 * concatenating the results of shards 0 .. count-1, in this order, gives the
+	 * result of the single run. Shard indices start at 0.
+	 */
+	class ShardSpec {
+		protected:
+			uint32_t _index; /**< which block this shard owns, 0 based */
+			uint32_t _count; /**< into how many blocks the workload is cut */
+
+		public:
+			/**
+			 * Default constructor, describing a single shard that owns everything
+			 */
+			ShardSpec() : _index(0), _count(1) {;}
+
+			/**
+			 * Parse a shard given as "i/N"
+			 *
+			 * @param spec The text, with 0 <= i < N
+			 * @return false if the text is malformed, the shard is left unchanged
+			 */
+			bool parse(const char *spec);
+
+			/**
+			 * Check whether an item belongs to this shard
+			 *
+			 * @param item The number of the item, in single run order
+			 * @param numItems The total number of items
+			 * @return true if the item falls into the block of this shard
+			 */
+			inline bool owns(uint64_t item, uint64_t numItems) const {
+				return _count == 1 || item * _count / numItems == _index;
+			}
+
+			inline uint32_t index() const {return _index;} /**< the block owned, 0 based */
+			inline uint32_t count() const {return _count;} /**< the number of blocks */
+			inline bool isSharded() const {return _count > 1;} /**< whether the workload is split at all */
+	};
+}
+
+#endif
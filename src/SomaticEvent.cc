@@ -30,14 +30,20 @@ THE SOFTWARE.
 */
 
 #include "SomaticEvent.h"
+#include "SegmentalMutation.h"
+#include "SNP.h"
 #include <sqlite3/sqlite3.h>
 #include <string>
 
 using namespace SubcloneSeeker;
 
-std::string SomaticEvent::createTableStatementStr() {
-	return ", frequency REAL NOT NULL, chrom INTEGER NOT NULL, start INTEGER NOT NULL, length INTEGER NULL, ofClusterID INTEGER NULL REFERENCES Clusters(id)";
-}
+const ArchiveField SomaticEvent::Fields[5] = {
+	{"frequency", "REAL NOT NULL", false},
+	{"chrom", "INTEGER NOT NULL", false},
+	{"start", "INTEGER NOT NULL", false},
+	{"length", "INTEGER NULL", false},
+	{"ofClusterID", "INTEGER NULL REFERENCES Clusters(id)", false}
+};
 
 DBObjectID_vec SomaticEvent::allObjectsOfCluster(sqlite3 *database, sqlite3_int64 clusterID) {
 	std::string queryStr = "SELECT id FROM " + getTableName() + " WHERE ofClusterID=?;";
@@ -61,3 +67,41 @@ DBObjectID_vec SomaticEvent::allObjectsOfCluster(sqlite3 *database, sqlite3_int6
 
 	return res_vec;
 }
+
+SomaticEventPtr_vec SomaticEvent::unarchiveEventsOfClusters(sqlite3 *database, const DBObjectID_vec& clusterIDs, ObjectArena *arena) {
+	SomaticEventPtr_vec events;
+
+	for(size_t offset = 0; offset < clusterIDs.size(); offset += BatchSize) {
+		size_t end = offset + BatchSize < clusterIDs.size() ? offset + BatchSize : clusterIDs.size();
+		std::string whereClause = "ofClusterID IN (" + idListStr(clusterIDs.begin() + offset, clusterIDs.begin() + end) + ")";
+
+		std::vector<CNV *> cnvs;
+		unarchiveObjectsFromDBWhere(database, whereClause, cnvs, "id", arena);
+		events.insert(events.end(), cnvs.begin(), cnvs.end());
+
+		std::vector<LOH *> lohs;
+		unarchiveObjectsFromDBWhere(database, whereClause, lohs, "id", arena);
+		events.insert(events.end(), lohs.begin(), lohs.end());
+
+		std::vector<SNP *> snps;
+		unarchiveObjectsFromDBWhere(database, whereClause, snps, "id", arena);
+		events.insert(events.end(), snps.begin(), snps.end());
+	}
+
+	return events;
+}
+
+SomaticEventPtr_vec SomaticEvent::unarchiveEventsOfCluster(StorageBackend& backend, sqlite3_int64 clusterID, ObjectArena *arena) {
+	SomaticEventPtr_vec events;
+
+	std::vector<CNV *> cnvs = unarchiveObjectsReferringTo<CNV>(backend, "ofClusterID", clusterID, arena);
+	events.insert(events.end(), cnvs.begin(), cnvs.end());
+
+	std::vector<LOH *> lohs = unarchiveObjectsReferringTo<LOH>(backend, "ofClusterID", clusterID, arena);
+	events.insert(events.end(), lohs.begin(), lohs.end());
+
+	std::vector<SNP *> snps = unarchiveObjectsReferringTo<SNP>(backend, "ofClusterID", clusterID, arena);
+	events.insert(events.end(), snps.begin(), snps.end());
+
+	return events;
+}
@@ -44,19 +44,45 @@ namespace SubcloneSeeker {
 	 * fraction of the cells does this specific event exist
 	 */
 	class SomaticEvent : public Archivable {
+		public:
+			/**
+			 * The concrete type of an event. The set of event types is closed, so
+			 * code that depends on the type switches on this tag (see visitEvent)
+			 * rather than probing with dynamic_cast
+			 */
+			enum Kind {
+				KIND_CNV=0, /**< CNV */
+				KIND_LOH, /**< LOH */
+				KIND_SNP, /**< SNP */
+				KIND_OTHER /**< any other subclass */
+			};
+
 		protected:
-			// Implements Archivable
-			virtual std::string createTableStatementStr();
+			/**
+			 * The columns shared by the tables of all event types, in record order.
+			 * Events without a length store NULL in the length column.
+			 */
+			static const ArchiveField Fields[5];
 
 			sqlite3_int64 ofClusterID; /**< to which cluster in database does this event belongs */
+			Kind _kind; /**< the concrete type, set once by the constructor of the subclass */
 
 		public:
 			double frequency; /**< Cell frequency */
 
 			/**
 			 * minimal constructor to reset member variables
+			 *
+			 * @param kind The concrete type, given by the constructor of the subclass
+			 */
+			SomaticEvent(Kind kind = KIND_OTHER): Archivable(), ofClusterID(0), _kind(kind), frequency(0) {;}
+
+			/**
+			 * Retrieve the concrete type of the event
+			 *
+			 * @return the kind tag
 			 */
-			SomaticEvent(): Archivable(), ofClusterID(0), frequency(0) {;}
+			inline Kind kind() const {return _kind;}
 
 			/**
 			 * Set the cluster's database id to which this event belongs
@@ -89,6 +115,32 @@ namespace SubcloneSeeker {
 			 */
 			virtual DBObjectID_vec allObjectsOfCluster(sqlite3 *database, sqlite3_int64 clusterID);
 
+			/**
+			 * Unarchive all events, regardless of their concrete type (CNV, LOH or SNP),
+			 * that belong to any of the given clusters
+			 *
+			 * One query is issued per event table and batch of cluster ids, instead of one
+			 * query per cluster and one per event. Event tables missing from the database
+			 * are skipped.
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @param clusterIDs The database ids of the clusters whose members are wanted
+			 * @param arena The arena the events are made in, NULL to allocate them on the heap
+			 * @return a vector of newly allocated events, with their cluster id populated
+			 */
+			static std::vector<SomaticEvent *> unarchiveEventsOfClusters(sqlite3 *database, const DBObjectID_vec& clusterIDs, ObjectArena *arena = NULL);
+
+			/**
+			 * Unarchive all events, regardless of their concrete type (CNV, LOH or SNP),
+			 * that belong to a cluster stored in a backend
+			 *
+			 * @param backend The storage backend
+			 * @param clusterID The id of the cluster whose members are wanted
+			 * @param arena The arena the events are made in, NULL to allocate them on the heap
+			 * @return a vector of newly allocated events, with their cluster id populated
+			 */
+			static std::vector<SomaticEvent *> unarchiveEventsOfCluster(StorageBackend& backend, sqlite3_int64 clusterID, ObjectArena *arena = NULL);
+
 	};
 
 	/**
@@ -0,0 +1,81 @@
+/**
+ * @file StorageBackend.cc
+ * Implementation of the shared parts of the storage abstraction
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "StorageBackend.h"
+#include "SQLiteBackend.h"
+#include "MemoryBackend.h"
+#include <cstring>
+
+using namespace SubcloneSeeker;
+
+bool StorageBackend::kindFromName(const char *name, Kind& kind) {
+	if(strcmp(name, "sqlite") == 0)
+		kind = KIND_SQLITE;
+	else if(strcmp(name, "memory") == 0)
+		kind = KIND_MEMORY;
+	else if(strcmp(name, "file") == 0)
+		kind = KIND_FILE;
+	else
+		return false;
+	return true;
+}
+
+StorageBackend::Kind StorageBackend::kindOfFile(const char *filename) {
+	if(BinaryFileBackend::isBackendFile(filename))
+		return KIND_FILE;
+	return KIND_SQLITE;
+}
+
+StorageBackend *StorageBackend::open(const char *filename, Kind kind, bool readOnly, DBConnection::Profile profile) {
+	switch(kind) {
+		case KIND_SQLITE:
+			{
+				sqlite3 *database;
+				int flags = readOnly ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+				if(DBConnection::open(filename, &database, flags, profile) != SQLITE_OK) {
+					sqlite3_close(database);
+					return NULL;
+				}
+				return new SQLiteBackend(database, true);
+			}
+		case KIND_MEMORY:
+			return new MemoryBackend();
+		case KIND_FILE:
+			{
+				BinaryFileBackend *backend = new BinaryFileBackend();
+				if(!backend->open(filename, readOnly)) {
+					delete backend;
+					return NULL;
+				}
+				return backend;
+			}
+	}
+	return NULL;
+}
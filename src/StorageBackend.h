@@ -0,0 +1,144 @@
+#ifndef STORAGE_BACKEND_H
+#define STORAGE_BACKEND_H
+
+/**
+ * @file StorageBackend.h
+ * Interface description of the storage abstraction used by Archivable
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "Archivable.h"
+#include "ArchiveRecord.h"
+#include "TableSchema.h"
+#include "DBConnection.h"
+#include <sqlite3/sqlite3.h>
+#include <string>
+#include <vector>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @interface StorageBackend
+	 * @brief Where archived records are kept
+	 *
+	 * Archivable objects encode themselves into an ArchiveRecord, which a backend
+	 * stores under an integer id within a table. Ids are assigned by the backend on
+	 * insertion, starting from 1. Three backends exist:
+	 * . SQLiteBackend stores the records in a sqlite3 database, with today's schema
+	 * . MemoryBackend keeps them in memory, for tests and in-process pipelines
+	 * . BinaryFileBackend is a MemoryBackend loaded from, and saved to, a binary file
+	 */
+	class StorageBackend {
+		public:
+			/** Kinds of backends, as selected by the tools */
+			enum Kind {
+				KIND_SQLITE = 0, /**< SQLiteBackend */
+				KIND_MEMORY, /**< MemoryBackend */
+				KIND_FILE /**< BinaryFileBackend */
+			};
+
+			virtual ~StorageBackend() {}
+
+			/**
+			 * Find a backend kind by its name
+			 *
+			 * @param name One of "sqlite", "memory" or "file"
+			 * @param kind Receives the kind
+			 * @return false if the name is unknown
+			 */
+			static bool kindFromName(const char *name, Kind& kind);
+
+			/**
+			 * Guess the kind of backend a file was written by, from its first bytes
+			 *
+			 * @param filename The file to be checked
+			 * @return KIND_FILE for a BinaryFileBackend file, KIND_SQLITE otherwise
+			 */
+			static Kind kindOfFile(const char *filename);
+
+			/**
+			 * Open a backend of the given kind on a file
+			 *
+			 * @param filename The database or backend file; ignored by KIND_MEMORY
+			 * @param kind The kind of backend
+			 * @param readOnly Whether the backend is only read from
+			 * @param profile The connection profile of a KIND_SQLITE backend
+			 * @return a newly allocated backend, to be deleted by the caller; NULL if the file cannot be opened
+			 */
+			static StorageBackend *open(const char *filename, Kind kind, bool readOnly = false,
+					DBConnection::Profile profile = DBConnection::PROFILE_DEFAULT);
+
+			/**
+			 * Check whether a table exists
+			 */
+			virtual bool tableExists(const TableSchema& schema) = 0;
+
+			/**
+			 * Create a table, and its indexes
+			 */
+			virtual bool createTable(const TableSchema& schema) = 0;
+
+			/**
+			 * Check whether a record exists
+			 */
+			virtual bool recordExists(const TableSchema& schema, sqlite3_int64 id) = 0;
+
+			/**
+			 * Insert a new record
+			 *
+			 * @return the id of the new record, or a negative number on error
+			 */
+			virtual sqlite3_int64 insertRecord(const TableSchema& schema, const ArchiveRecord& record) = 0;
+
+			/**
+			 * Replace an existing record
+			 */
+			virtual bool updateRecord(const TableSchema& schema, sqlite3_int64 id, const ArchiveRecord& record) = 0;
+
+			/**
+			 * Read a record
+			 *
+			 * @return false if the record does not exist
+			 */
+			virtual bool fetchRecord(const TableSchema& schema, sqlite3_int64 id, ArchiveRecord& record) = 0;
+
+			/**
+			 * The ids of all records of a table, in increasing order
+			 */
+			virtual DBObjectID_vec allRecordIDs(const TableSchema& schema) = 0;
+
+			/**
+			 * The ids of the records referring to another record, in increasing order
+			 *
+			 * @param column The name of a column holding a reference, as written by ArchiveRecord::appendIDOrNull
+			 * @param id The referred id; 0 selects the records referring to nothing
+			 */
+			virtual DBObjectID_vec recordIDsReferringTo(const TableSchema& schema, const std::string& column, sqlite3_int64 id) = 0;
+	};
+}
+
+#endif
@@ -29,18 +29,24 @@ THE SOFTWARE.
 */
 
 #include <assert.h>
+#include <sstream>
 
 #include "Subclone.h"
 #include "EventCluster.h"
 #include "SomaticEvent.h"
 #include "SegmentalMutation.h"
+#include "SQLiteBackend.h"
+#include "LazyTreeLoader.h"
+#include "CohortDB.h"
+#include "CompactTree.h"
+#include "ObjectArena.h"
 
 using namespace SubcloneSeeker;
 
 void Subclone::addEventCluster(EventCluster *cluster) {
 	bool alreadyExist = false;
 
-	for(size_t i=0; i<_eventClusters.size(); i++) {
+	for(size_t i=0; i<vecEventCluster().size(); i++) {
 		if(_eventClusters[i] == cluster) {
 			alreadyExist = true;
 			break;
@@ -52,80 +58,163 @@ void Subclone::addEventCluster(EventCluster *cluster) {
 	}
 }
 
-// Implements Archivable
-std::string Subclone::getTableName() {
-	return "Subclones";
+void Subclone::appendEvents(std::vector<SomaticEvent *>& events) const {
+	const std::vector<EventCluster *>& clusters = vecEventCluster();
+	for(size_t i=0; i<clusters.size(); i++)
+		events.insert(events.end(), clusters[i]->beginMembers(), clusters[i]->endMembers());
 }
 
-std::string Subclone::createTableStatementStr() {
-	return ", fraction REAL NOT NULL, treeFraction REAL NOT NULL, parentId INTEGER NULL REFERENCES Subclones(id)";
+void Subclone::loadPendingClusters() {
+	_clustersPending = false;
+	if(_lazyLoader != NULL)
+		_lazyLoader->loadClusters(this);
 }
 
-std::string Subclone::createObjectStatementStr() {
-	return "INSERT INTO Subclones (fraction, treeFraction, parentId) VALUES (?, ?, ?);";
+void Subclone::loadPendingChildren() {
+	if(_lazyLoader != NULL)
+		_lazyLoader->loadChildren(this);
 }
 
-std::string Subclone::updateObjectStatementStr() {
-	return "UPDATE Subclones SET fraction=?, treeFraction=?, parentId=? WHERE id=?;";
-}
+bool Subclone::createClusterLinkTableInDB(sqlite3 *database) {
+	// in a cohort sample, the table and its index get a leading sampleID
+	bool scoped = CohortDB::currentSample(database) > 0;
+	std::string sample_str = scoped ? std::string(CohortDB::SampleColumnDefinition) + ", " : "";
+	std::string stmt_strs[] = {
+		"CREATE TABLE IF NOT EXISTS main.SubcloneClusters (" + sample_str + "subcloneID INTEGER NOT NULL REFERENCES Subclones(id), clusterID INTEGER NOT NULL REFERENCES Clusters(id));",
+		"CREATE INDEX IF NOT EXISTS main.SubcloneClusters_subcloneID ON SubcloneClusters (" + std::string(scoped ? "sampleID, " : "") + "subcloneID);"
+	};
+
+	for(size_t i=0; i<sizeof(stmt_strs) / sizeof(stmt_strs[0]); i++) {
+		if(sqlite3_exec(database, stmt_strs[i].c_str(), 0, 0, 0) != SQLITE_OK)
+			return false;
+	}
 
-std::string Subclone::selectObjectColumnListStr() {
-	return "fraction, treeFraction, parentId";
+	if(scoped)
+		return CohortDB::scopeTable(database, "SubcloneClusters");
+	return true;
 }
 
-int Subclone::bindObjectToStatement(sqlite3_stmt* statement) {
-	int bind_loc = 1;
-	sqlite3_bind_double(statement, bind_loc++, _fraction);
-	sqlite3_bind_double(statement, bind_loc++, _treeFraction);
-	if(parentId > 0) {
-		sqlite3_bind_int64(statement, bind_loc++, parentId);
-	}
-	else {
-		sqlite3_bind_null(statement, bind_loc++);
+bool Subclone::linkClusterInDB(sqlite3 *database, sqlite3_int64 subcloneID, sqlite3_int64 clusterID) {
+	sqlite3_stmt *statement;
+	int rc;
+
+	std::string insert_str = "INSERT INTO SubcloneClusters (subcloneID, clusterID) VALUES (?,?);";
+	rc = sqlite3_prepare_v2(database, insert_str.c_str(), -1, &statement, 0);
+	if(rc != SQLITE_OK) {
+		sqlite3_finalize(statement);
+
+		// in a cohort sample, the join table is shadowed by a read-only view
+		sqlite3_int64 sample = CohortDB::currentSample(database);
+		if(sample > 0) {
+			std::ostringstream scoped_str;
+			scoped_str<<"INSERT INTO main.SubcloneClusters (sampleID, subcloneID, clusterID) VALUES ("<<sample<<",?,?);";
+			insert_str = scoped_str.str();
+			rc = sqlite3_prepare_v2(database, insert_str.c_str(), -1, &statement, 0);
+		}
+
+		// the join table may not exist yet
+		if(rc != SQLITE_OK) {
+			sqlite3_finalize(statement);
+			if(!createClusterLinkTableInDB(database))
+				return false;
+
+			rc = sqlite3_prepare_v2(database, insert_str.c_str(), -1, &statement, 0);
+			if(rc != SQLITE_OK) {
+				sqlite3_finalize(statement);
+				return false;
+			}
+		}
 	}
-	return bind_loc;
+
+	sqlite3_bind_int64(statement, 1, subcloneID);
+	sqlite3_bind_int64(statement, 2, clusterID);
+
+	rc = sqlite3_step(statement);
+	sqlite3_finalize(statement);
+
+	return rc == SQLITE_DONE;
 }
 
-void Subclone::updateObjectFromStatement(sqlite3_stmt* statement) {
-	int col_pos = 0;
-	_fraction = sqlite3_column_double(statement, col_pos++);
-	_treeFraction = sqlite3_column_double(statement, col_pos++);
+// Implements Archivable
+static const ArchiveField SubcloneFields[] = {
+	{"fraction", "REAL NOT NULL", false},
+	{"treeFraction", "REAL NOT NULL", false},
+	{"parentId", "INTEGER NULL REFERENCES Subclones(id)", false}
+};
+
+const TableSchema& Subclone::tableSchema() {
+	static const TableSchema schema("Subclones", SubcloneFields);
+	return schema;
+}
 
-	if(sqlite3_column_type(statement, col_pos) != SQLITE_NULL) {
-		parentId = sqlite3_column_int64(statement, col_pos++);
-	}
-	else {
-		parentId = 0;
-	}
+void Subclone::encodeObject(ArchiveRecord& record) {
+	record.appendReal(_fraction);
+	record.appendReal(_treeFraction);
+	record.appendIDOrNull(parentId);
+}
+
+void Subclone::decodeObject(const ArchiveRecord& record) {
+	int col_pos = 0;
+	_fraction = record.realAt(col_pos++);
+	_treeFraction = record.realAt(col_pos++);
+	parentId = record.integerAt(col_pos++);
 }
 
 
 // SubcloneSaveTreeTraverser
+SubcloneSaveTreeTraverser::SubcloneSaveTreeTraverser(sqlite3 *database, bool shareClusters):
+	_database(database), _backend(new SQLiteBackend(database)), _ownsBackend(true), _shareClusters(shareClusters) {;}
+
+SubcloneSaveTreeTraverser::~SubcloneSaveTreeTraverser() {
+	if(_ownsBackend)
+		delete _backend;
+}
+
 void SubcloneSaveTreeTraverser::processNode(TreeNode *node) {
 	Subclone *clone = dynamic_cast<Subclone *>(node);
 	clone->setId(0);
 
-	sqlite3_int64 id  = clone->archiveObjectToDB(_database);
+	sqlite3_int64 id  = clone->archiveObject(*_backend);
+
+	if(_shareClusters) {
+		// SAVE SHARED CLUSTERS, only the first time they are encountered
+		for(size_t i=0; i<clone->vecEventCluster().size(); i++) {
+			EventCluster *cluster = clone->vecEventCluster()[i];
+			if(cluster->getId() == 0) {
+				cluster->setSubcloneID(0);
+				sqlite3_int64 newCluID = cluster->archiveObject(*_backend);
+				for(EventCluster::member_iterator it = cluster->beginMembers(); it != cluster->endMembers(); it++) {
+					(*it)->setId(0);
+					(*it)->setClusterID(newCluID);
+					(*it)->archiveObject(*_backend);
+				}
+			}
+			Subclone::linkClusterInDB(_database, id, cluster->getId());
+		}
+		return;
+	}
 
 	// SAVE CLUSTERS
 	for(size_t i=0; i<clone->vecEventCluster().size(); i++) {
-		sqlite3_int64 oldCluID = clone->vecEventCluster()[i]->getId();
-		sqlite3_int64 oldSubcID = clone->vecEventCluster()[i]->subcloneID();
-		clone->vecEventCluster()[i]->setId(0);
-		clone->vecEventCluster()[i]->setSubcloneID(id);
-		sqlite3_int64 newCluID = clone->vecEventCluster()[i]->archiveObjectToDB(_database);
-		for(size_t j=0; j<clone->vecEventCluster()[i]->members().size(); j++) {
-			sqlite3_int64 oldEventID = clone->vecEventCluster()[i]->members()[j]->getId();
-			sqlite3_int64 oldOfCluID = clone->vecEventCluster()[i]->members()[j]->clusterID();
-			clone->vecEventCluster()[i]->members()[j]->setId(0);
-			clone->vecEventCluster()[i]->members()[j]->setClusterID(newCluID);
-			sqlite3_int64 newEventID = clone->vecEventCluster()[i]->members()[j]->archiveObjectToDB(_database);
-
-			clone->vecEventCluster()[i]->members()[j]->setId(oldEventID);
-			clone->vecEventCluster()[i]->members()[j]->setClusterID(oldOfCluID);
+		EventCluster *cluster = clone->vecEventCluster()[i];
+		sqlite3_int64 oldCluID = cluster->getId();
+		sqlite3_int64 oldSubcID = cluster->subcloneID();
+		cluster->setId(0);
+		cluster->setSubcloneID(id);
+		sqlite3_int64 newCluID = cluster->archiveObject(*_backend);
+		for(EventCluster::member_iterator it = cluster->beginMembers(); it != cluster->endMembers(); it++) {
+			SomaticEvent *event = *it;
+			sqlite3_int64 oldEventID = event->getId();
+			sqlite3_int64 oldOfCluID = event->clusterID();
+			event->setId(0);
+			event->setClusterID(newCluID);
+			event->archiveObject(*_backend);
+
+			event->setId(oldEventID);
+			event->setClusterID(oldOfCluID);
 		}
-		clone->vecEventCluster()[i]->setId(oldCluID);
-		clone->vecEventCluster()[i]->setSubcloneID(oldSubcID);
+		cluster->setId(oldCluID);
+		cluster->setSubcloneID(oldSubcID);
 	}
 }
 
@@ -142,10 +231,46 @@ void SubcloneSaveTreeTraverser::preprocessNode(TreeNode *node) {
 }
 
 // SubcloneLoadTreeTraverser
+bool SubcloneLoadTreeTraverser::isCompactDB(sqlite3 *database) {
+	Subclone dummyClone;
+	CompactTree dummyTree;
+	return !dummyClone.tableExistsInDB(database) && dummyTree.tableExistsInDB(database);
+}
+
 std::vector<sqlite3_int64> SubcloneLoadTreeTraverser::rootNodes(sqlite3 *database) {
+	if(isCompactDB(database)) {
+		CompactTree dummyTree;
+		return dummyTree.vecAllObjectsID(database);
+	}
 	return nodesOfParentID(database, 0);
 }
 
+Subclone *SubcloneLoadTreeTraverser::loadTree(sqlite3 *database, sqlite3_int64 rootID, ObjectArena *arena) {
+	if(isCompactDB(database)) {
+		// the whole tree is one record, expanded on demand
+		CompactTree compactTree;
+		if(!compactTree.unarchiveObjectFromDB(database, rootID))
+			return NULL;
+
+		// the root keeps the record id as the id of the tree
+		Subclone *root = compactTree.expandTree(database, arena);
+		if(root != NULL)
+			root->setId(rootID);
+		return root;
+	}
+
+	Subclone *root = ObjectArena::create<Subclone>(arena);
+	if(!root->unarchiveObjectFromDB(database, rootID)) {
+		if(arena == NULL)
+			delete root;
+		return NULL;
+	}
+
+	SubcloneLoadTreeTraverser loadTraverser(database, arena);
+	TreeNode::PreOrderTraverse(root, loadTraverser);
+	return root;
+}
+
 std::vector<sqlite3_int64> SubcloneLoadTreeTraverser::nodesOfParentID(sqlite3 *database, sqlite3_int64 parentId) {
 
 	sqlite3_stmt *statement;
@@ -180,33 +305,55 @@ std::vector<sqlite3_int64> SubcloneLoadTreeTraverser::nodesOfParentID(sqlite3 *d
 	return res;
 }
 
+std::vector<sqlite3_int64> SubcloneLoadTreeTraverser::rootNodes(StorageBackend& backend) {
+	return nodesOfParentID(backend, 0);
+}
+
+std::vector<sqlite3_int64> SubcloneLoadTreeTraverser::nodesOfParentID(StorageBackend& backend, sqlite3_int64 parentId) {
+	return Archivable::objectIDsReferringTo<Subclone>(backend, "parentId", parentId);
+}
+
 void SubcloneLoadTreeTraverser::processNode(TreeNode * node) {
 	Subclone *clone = dynamic_cast<Subclone *>(node);
 
-	// unarchive clusters and events
+	if(_backend != NULL) {
+		std::vector<EventCluster *> clusters = EventCluster::unarchiveClustersOfSubclone(*_backend, clone->getId(), _arena);
+		for(size_t i=0; i<clusters.size(); i++)
+			clone->addEventCluster(clusters[i]);
+
+		SubclonePtr_vec children = Archivable::unarchiveObjectsReferringTo<Subclone>(*_backend, "parentId", clone->getId(), _arena);
+		for(size_t i=0; i<children.size(); i++)
+			clone->addChild(children[i]);
+		return;
+	}
+
+	// unarchive clusters and events of every type
 	EventCluster dummyCluster;
 	DBObjectID_vec cluster_ids = dummyCluster.allObjectsOfSubclone(_database, clone->getId());
-	for(size_t i=0; i<cluster_ids.size(); i++) {
-		EventCluster *newCluster = new EventCluster();
-		newCluster->unarchiveObjectFromDB(_database, cluster_ids[i]);
-
-		// unarchive CNV
-		CNV dummyCNV;
-		DBObjectID_vec cnv_ids = dummyCNV.allObjectsOfCluster(_database, newCluster->getId());
-		for(size_t j=0; j<cnv_ids.size(); j++) {
-			CNV *newCNV = new CNV();
-			newCNV->unarchiveObjectFromDB(_database, cnv_ids[j]);
-			newCluster->addEvent(newCNV, false);
-		}
+	std::vector<EventCluster *> clusters = EventCluster::unarchiveClustersWithMembers(_database, cluster_ids, _arena);
+	for(size_t i=0; i<clusters.size(); i++)
+		clone->addEventCluster(clusters[i]);
 
-		clone->addEventCluster(newCluster);
+	std::vector<sqlite3_int64> childrenIDs = nodesOfParentID(_database, clone->getId());
+	SubclonePtr_vec children = Archivable::unarchiveObjectsFromDB<Subclone>(_database, childrenIDs, _arena);
+
+	for(size_t i=0; i<children.size(); i++) {
+		clone->addChild(children[i]);
 	}
+}
 
-	std::vector<sqlite3_int64> childrenIDs = nodesOfParentID(_database, clone->getId());
+// SubcloneFreeTreeTraverser
+void SubcloneFreeTreeTraverser::processNode(TreeNode *node) {
+	Subclone *clone = dynamic_cast<Subclone *>(node);
 
-	for(size_t i=0; i<childrenIDs.size(); i++) {
-		Subclone *children = new Subclone();
-		children->unarchiveObjectFromDB(_database, childrenIDs[i]);
-		clone->addChild(children);
+	if(_freeClusters) {
+		for(size_t i=0; i<clone->vecEventCluster().size(); i++) {
+			EventCluster *cluster = clone->vecEventCluster()[i];
+			for(EventCluster::member_iterator it = cluster->beginMembers(); it != cluster->endMembers(); it++)
+				delete *it;
+			delete cluster;
+		}
 	}
+
+	delete clone;
 }
@@ -39,7 +39,9 @@ namespace SubcloneSeeker {
 
 	// forward declaration of EventCluster, so that pointers can be made
 	class EventCluster;
+	class SomaticEvent;
 	class SubcloneSaveTreeTraverser;
+	class LazyTreeLoader;
 	
 	/**
 	 * @brief The class that represents a subclone in a subclonal structure tree
@@ -57,23 +59,28 @@ namespace SubcloneSeeker {
 
 			sqlite3_int64 parentId;	/**< The database id of the parent node, 0 represents a root */
 
+			LazyTreeLoader *_lazyLoader; /**< the loader of the pending children and clusters, NULL if loaded eagerly */
+			bool _clustersPending; /**< whether the clusters are yet to be loaded by _lazyLoader */
+
+			friend class LazyTreeLoader;
+
 		protected:
 			// Implements Archivable
-			virtual std::string getTableName();
-			virtual std::string createTableStatementStr();
-			virtual std::string createObjectStatementStr();
-			virtual std::string updateObjectStatementStr();
-			virtual std::string selectObjectColumnListStr();
+			virtual const TableSchema& tableSchema();
 
-			virtual int bindObjectToStatement(sqlite3_stmt* statement);
-			virtual void updateObjectFromStatement(sqlite3_stmt* statement);
+			virtual void encodeObject(ArchiveRecord& record);
+			virtual void decodeObject(const ArchiveRecord& record);
+
+			// Implements TreeNode
+			virtual void loadPendingChildren();
 
 		public:
 
 			/**
 			 * Minimal constructor to reset all member variables
 			 */
-			Subclone() : TreeNode(), Archivable(), _fraction(0), _treeFraction(0), parentId(0) {;}
+			Subclone() : TreeNode(), Archivable(), _fraction(0), _treeFraction(0), parentId(0),
+				_lazyLoader(NULL), _clustersPending(false) {;}
 
 			/** set parent id
 			 * @param pid The new parent id
@@ -109,7 +116,34 @@ namespace SubcloneSeeker {
 			 *
 			 * @return member EventCluster vector
 			 */
-			inline std::vector<EventCluster *> &vecEventCluster() {return _eventClusters;}
+			inline std::vector<EventCluster *> &vecEventCluster() {
+				if(_clustersPending)
+					loadPendingClusters();
+				return _eventClusters;
+			}
+
+			/**
+			 * retreve a vector of all EventClusters this subclone has
+			 *
+			 * @return member EventCluster vector, read only
+			 */
+			inline const std::vector<EventCluster *> &vecEventCluster() const {
+				if(_clustersPending)
+					const_cast<Subclone *>(this)->loadPendingClusters();
+				return _eventClusters;
+			}
+
+			/**
+			 * Append the members of all EventClusters this subclone has to a vector
+			 *
+			 * @param events The vector receiving the events, cluster by cluster
+			 */
+			void appendEvents(std::vector<SomaticEvent *>& events) const;
+
+			/**
+			 * Load the clusters of a subclone created by a LazyTreeLoader
+			 */
+			void loadPendingClusters();
 
 			/**
 			 * Add a given EventCluster into the subclone
@@ -117,6 +151,28 @@ namespace SubcloneSeeker {
 			 * @param cluster The EventCluster to be added to the subclone
 			 */
 			void addEventCluster(EventCluster *cluster);
+
+			/**
+			 * Create the join table through which subclones refer to shared clusters
+			 *
+			 * In the shared storage mode, clusters and their events are written once per
+			 * database, and each subclone lists the clusters it contains in this table,
+			 * instead of owning private copies through Clusters.ofSubcloneID
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @return Whether the table exists after the call
+			 */
+			static bool createClusterLinkTableInDB(sqlite3 *database);
+
+			/**
+			 * Record in the join table that a subclone contains a shared cluster
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @param subcloneID The database id of the subclone
+			 * @param clusterID The database id of the shared cluster
+			 * @return Whether the operation is successful or not
+			 */
+			static bool linkClusterInDB(sqlite3 *database, sqlite3_int64 subcloneID, sqlite3_int64 clusterID);
 	};
 
 	/**
@@ -126,18 +182,37 @@ namespace SubcloneSeeker {
 	 * entire subclone structure will be saved. When performing the actual load, a pre-order traverse
 	 * should be performed on the root node of the tree being archived. The traverser will archive the
 	 * root node, then traverse its children node.
+	 *
+	 * By default every tree gets its own copy of all its clusters and events. When shareClusters is
+	 * set, a cluster is archived (together with its events) only if it does not have a database id
+	 * yet, and keeps the id afterwards; subclones then refer to it through the SubcloneClusters join
+	 * table. Saving many trees built over the same clusters therefore writes each cluster only once.
 	 */
 	class SubcloneSaveTreeTraverser : public TreeTraverseDelegate {
 		protected:
-			sqlite3* _database; /**< To which database will the tree be saved */
+			sqlite3* _database; /**< To which database will the tree be saved, NULL for other backends */
+			StorageBackend* _backend; /**< To which backend will the tree be saved */
+			bool _ownsBackend; /**< Whether the backend wraps _database, and is deleted with the traverser */
+			bool _shareClusters; /**< Whether clusters are shared among trees through the join table */
 
 		public:
 			/**
 			 * Constructor of the SubcloneSaveTreeTraverser class 
 			 *
 			 * @param database To which database will the tree be saved
+			 * @param shareClusters Whether clusters are stored once and shared through the join table
+			 */
+			SubcloneSaveTreeTraverser(sqlite3 *database, bool shareClusters = false);
+
+			/**
+			 * Constructor saving to a storage backend. Every tree gets its own copy of its
+			 * clusters and events, as the shared mode relies on a sqlite3 join table
+			 *
+			 * @param backend To which backend will the tree be saved
 			 */
-			SubcloneSaveTreeTraverser(sqlite3 *database): _database(database) {;}
+			SubcloneSaveTreeTraverser(StorageBackend& backend): _database(NULL), _backend(&backend), _ownsBackend(false), _shareClusters(false) {;}
+
+			virtual ~SubcloneSaveTreeTraverser();
 
 			virtual void processNode(TreeNode *node);
 			virtual void preprocessNode(TreeNode *node);
@@ -155,24 +230,58 @@ namespace SubcloneSeeker {
 	class SubcloneLoadTreeTraverser : public TreeTraverseDelegate {
 		protected:
 			sqlite3* _database; /**< From which database will be tree be loaded */
+			StorageBackend* _backend; /**< From which backend will the tree be loaded, if not a database */
+			ObjectArena* _arena; /**< In which arena are the loaded objects made, NULL for the heap */
 
 		public:
 			/**
 			 * Constructor of the SubcloneLoadTreeTraverser class 
 			 *
 			 * @param database From which database will the tree be load
+			 * @param arena In which arena are the loaded nodes, clusters and events made, NULL for the heap
+			 */
+			SubcloneLoadTreeTraverser(sqlite3 *database, ObjectArena *arena = NULL): _database(database), _backend(NULL), _arena(arena) {;}
+
+			/**
+			 * Constructor loading from a storage backend
+			 *
+			 * @param backend From which backend will the tree be loaded
+			 * @param arena In which arena are the loaded nodes, clusters and events made, NULL for the heap
 			 */
-			SubcloneLoadTreeTraverser(sqlite3 *database): _database(database) {;}
+			SubcloneLoadTreeTraverser(StorageBackend& backend, ObjectArena *arena = NULL): _database(NULL), _backend(&backend), _arena(arena) {;}
 			virtual void processNode(TreeNode *node);
 
+			/**
+			 * @brief Check if the trees of a database are stored as CompactTrees records only
+			 *
+			 * ssmain -c writes every tree as a single CompactTrees record and no Subclones table.
+			 *
+			 * @param database The database to which the query is sent
+			 * @return whether the database has a CompactTrees table but no Subclones table
+			 */
+			static bool isCompactDB(sqlite3 *database);
+
 			/**
 			 * @brief Query the database for a set of nodes that appears to be root
 			 *
+			 * In a compact database (see isCompactDB), these are the ids of the
+			 * CompactTrees records instead, which loadTree accepts just the same.
+			 *
 			 * @param database The database to which the query is sent
 			 * @return A vector of IDs representing nodes in the database that appears to be root nodes.
 			 */
 			static std::vector<sqlite3_int64> rootNodes(sqlite3 *database);
 
+			/**
+			 * @brief Load a whole tree, whichever way it is stored
+			 *
+			 * @param database The database the tree is stored in
+			 * @param rootID A root id as given by rootNodes, which the root keeps as its id
+			 * @param arena In which arena are the loaded nodes, clusters and events made, NULL for the heap
+			 * @return the root of the loaded tree, NULL if it cannot be found
+			 */
+			static Subclone *loadTree(sqlite3 *database, sqlite3_int64 rootID, ObjectArena *arena = NULL);
+
 			/**
 			 * @brief Query the database for a set of nodes that appears to be the children of a given node ID
 			 *
@@ -181,8 +290,47 @@ namespace SubcloneSeeker {
 			 * @return a vector of IDs representing nodes in the database that appears to be the direct children of the given parent ID
 			 */
 			static std::vector<sqlite3_int64> nodesOfParentID(sqlite3 *database, sqlite3_int64 parentId);
+
+			/**
+			 * @brief Query a backend for a set of nodes that appears to be root
+			 *
+			 * @param backend The storage backend
+			 * @return A vector of IDs representing nodes in the backend that appears to be root nodes.
+			 */
+			static std::vector<sqlite3_int64> rootNodes(StorageBackend& backend);
+
+			/**
+			 * @brief Query a backend for a set of nodes that appears to be the children of a given node ID
+			 *
+			 * @param backend The storage backend
+			 * @param parentId The ID representing a node in the backend
+			 * @return a vector of IDs representing nodes in the backend that appears to be the direct children of the given parent ID
+			 */
+			static std::vector<sqlite3_int64> nodesOfParentID(StorageBackend& backend, sqlite3_int64 parentId);
 	};
 
+	/**
+	 * @brief A tree traverser that frees an entire tree structure
+	 *
+	 * A post-order traverse should be performed on the root of the tree, which
+	 * deletes every node after its children. Trees loaded from a database own
+	 * their clusters and events, one copy per node, which are deleted as well;
+	 * clusters shared with other trees, such as those of TreeSetFile::expandTree,
+	 * have to be kept by passing freeClusters = false.
+	 */
+	class SubcloneFreeTreeTraverser : public TreeTraverseDelegate {
+		protected:
+			bool _freeClusters; /**< Whether the clusters and their events are deleted with the nodes */
+
+		public:
+			/**
+			 * Constructor of the SubcloneFreeTreeTraverser class
+			 *
+			 * @param freeClusters Whether the clusters and their events are owned by the tree
+			 */
+			SubcloneFreeTreeTraverser(bool freeClusters = true): _freeClusters(freeClusters) {;}
+			virtual void processNode(TreeNode *node);
+	};
 
 	/**
 	 * A vector of Subclone pointers
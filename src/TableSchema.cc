@@ -0,0 +1,66 @@
+/**
+ * @file TableSchema.cc
+ * Implementation of struct TableSchema
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "TableSchema.h"
+
+using namespace SubcloneSeeker;
+
+TableSchema::TableSchema(const char *tableName, const ArchiveField *fields, size_t numFields) {
+	build(tableName, fields, numFields);
+}
+
+void TableSchema::build(const char *tableName, const ArchiveField *fields, size_t numFields) {
+	name = tableName;
+
+	std::string placeholders, assignments;
+	for(size_t i=0; i<numFields; i++) {
+		std::string separator = i > 0 ? ", " : "";
+
+		columns.push_back(fields[i].name);
+		if(fields[i].indexed)
+			indexedColumns.push_back(fields[i].name);
+
+		createColumnsSQL += std::string(", ") + fields[i].name + " " + fields[i].definition;
+		selectColumnsSQL += separator + fields[i].name;
+		placeholders += separator + "?";
+		assignments += separator + fields[i].name + "=?";
+	}
+
+	insertSQL = "INSERT INTO " + name + " (" + selectColumnsSQL + ") VALUES (" + placeholders + ");";
+	updateSQL = "UPDATE " + name + " SET " + assignments + " WHERE id=?;";
+	selectSQL = "SELECT " + selectColumnsSQL + " FROM " + name + " WHERE id=?;";
+}
+
+int TableSchema::columnIndex(const std::string& column) const {
+	for(size_t i=0; i<columns.size(); i++)
+		if(columns[i] == column)
+			return i;
+	return -1;
+}
@@ -0,0 +1,103 @@
+#ifndef TABLE_SCHEMA_H
+#define TABLE_SCHEMA_H
+
+/**
+ * @file TableSchema.h
+ * Interface description of the table descriptions used by Archivable and the storage backends
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @brief Compile-time description of one column of an Archivable class
+	 *
+	 * Each class lists its columns in a static array, in the order in which
+	 * encodeObject appends them; the SQL of the table is generated from the array.
+	 */
+	struct ArchiveField {
+		const char *name; /**< the column name */
+		const char *definition; /**< the column type and constraints, e.g. "REAL NOT NULL" */
+		bool indexed; /**< whether an index is created on the column */
+	};
+
+	/**
+	 * @brief Everything a backend needs to know about the table of an Archivable class
+	 *
+	 * A schema is built once per class, from its ArchiveField array, and kept
+	 * as a static constant. The SQL strings are only used by the sqlite3 backend;
+	 * the other backends only use the table name and the column names.
+	 */
+	struct TableSchema {
+		std::string name; /**< the table name */
+		std::vector<std::string> columns; /**< the column names, in record order, without id */
+		std::string createColumnsSQL; /**< the column definitions, prefixed with "," */
+		std::string insertSQL; /**< the unbound insert statement */
+		std::string updateSQL; /**< the unbound update statement, with the id bound last */
+		std::string selectSQL; /**< the unbound select statement of one record by id */
+		std::string selectColumnsSQL; /**< the select column list */
+		std::vector<std::string> indexedColumns; /**< the columns to be indexed */
+
+		/**
+		 * Generate the schema of a table
+		 *
+		 * @param tableName The table name
+		 * @param fields The columns, without id, in record order
+		 * @param numFields The number of columns
+		 */
+		TableSchema(const char *tableName, const ArchiveField *fields, size_t numFields);
+
+		/**
+		 * Generate the schema of a table from a static array of columns
+		 *
+		 * @param tableName The table name
+		 * @param fields The columns, without id, in record order
+		 */
+		template <size_t N>
+		TableSchema(const char *tableName, const ArchiveField (&fields)[N]) {build(tableName, fields, N);}
+
+		/**
+		 * Find a column by name
+		 *
+		 * @param column The column name
+		 * @return the position of the column in a record, -1 if not found
+		 */
+		int columnIndex(const std::string& column) const;
+
+		protected:
+			/**
+			 * Fill in the names and the SQL of the table
+			 */
+			void build(const char *tableName, const ArchiveField *fields, size_t numFields);
+	};
+}
+
+#endif
@@ -0,0 +1,270 @@
+/**
+ * @file TreeEnumerator.cc
+ * Implementation of the helper class TreeEnumerator
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "TreeEnumerator.h"
+#include "Subclone.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#define EPISLON (0.01)
+
+using namespace SubcloneSeeker;
+
+/**
+ * @brief A tree traverser collecting the nodes in the order they are visited
+ */
+class NodeCollectTraverser : public TreeTraverseDelegate {
+	protected:
+		std::vector<TreeNode *>& _nodes;
+
+	public:
+		NodeCollectTraverser(std::vector<TreeNode *>& nodes): _nodes(nodes) {;}
+
+		virtual void processNode(TreeNode *node) {
+			_nodes.push_back(node);
+		}
+};
+
+/**
+ * @brief A tree traverser resetting the fractions and ids, so that the same nodes
+ * can be used for another structure's evaluation
+ */
+class NodeResetTraverser : public TreeTraverseDelegate {
+	public:
+		virtual void processNode(TreeNode *node) {
+			Subclone *clone = dynamic_cast<Subclone *>(node);
+			clone->setFraction(-1);
+			clone->setTreeFraction(-1);
+			clone->setParentId(0);
+			clone->setId(0);
+		}
+};
+
+/**
+ * @brief A post-order tree traverser assigning the fractions, bottom-up
+ *
+ * A leaf takes the cell fraction of its clusters. An intermediate node keeps
+ * what its children leave of its own cell fraction (1 for the root); if that is
+ * negative, the tree is not viable and the traversal stops, leaving the
+ * fraction of the root unassigned.
+ */
+class FracAsnTraverser : public TreeTraverseDelegate {
+	public:
+		virtual void processNode(TreeNode *node) {
+			Subclone *clone = dynamic_cast<Subclone *>(node);
+
+			if(node->isLeaf()) {
+				clone->setFraction(clone->vecEventCluster()[0]->cellFraction());
+				clone->setTreeFraction(clone->vecEventCluster()[0]->cellFraction());
+				return;
+			}
+
+			if(clone->isRoot())
+				clone->setTreeFraction(1);
+			else
+				clone->setTreeFraction(clone->vecEventCluster()[0]->cellFraction());
+
+			assert(clone->treeFraction() >= -EPISLON && clone->treeFraction() <= 1 + EPISLON);
+
+			double childrenFraction = 0;
+			for(size_t i=0; i<node->getVecChildren().size(); i++)
+				childrenFraction += ((Subclone *)node->getVecChildren()[i])->treeFraction();
+
+			double nodeFraction = clone->treeFraction() - childrenFraction;
+
+			if(nodeFraction < EPISLON && nodeFraction > -EPISLON)
+				nodeFraction = 0;
+
+			if(nodeFraction < -EPISLON) {
+				terminate();
+			}
+			else {
+				clone->setFraction(nodeFraction);
+				assert(clone->fraction() >= -EPISLON && clone->fraction() <= 1+EPISLON);
+			}
+		}
+};
+
+TreeEnumerator::TreeEnumerator(const std::vector<EventCluster>& clusters):
+	_clusters(clusters), _shardDepth(0), _numPrefixes(1), _nextPrefix(0),
+	_started(false), _finished(false), _numTrees(0) {
+	_root = new Subclone();
+	_root->setFraction(-1);
+	_root->setTreeFraction(-1);
+
+	// group the clusters sharing the same fraction into one subclone. This is
+	// unlikely to happen if the clusters are generated from a clustering
+	// algorithm run on the raw data, but possible with external datasets
+	size_t symIdx = 0;
+	while(symIdx < _clusters.size()) {
+		Subclone *clone = new Subclone();
+		clone->setFraction(-1);
+		clone->setTreeFraction(-1);
+		clone->addEventCluster(&_clusters[symIdx]);
+
+		float currentFraction = _clusters[symIdx].cellFraction();
+		symIdx++;
+		while(symIdx < _clusters.size() &&
+				fabs(_clusters[symIdx].cellFraction() - currentFraction) < EPISLON) {
+			clone->addEventCluster(&_clusters[symIdx]);
+			symIdx++;
+		}
+
+		_nodes.push_back(clone);
+	}
+}
+
+TreeEnumerator::~TreeEnumerator() {
+	// nodes do not free their children, so the current tree needs no dismantling
+	for(size_t i=0; i<_nodes.size(); i++)
+		delete _nodes[i];
+	delete _root;
+}
+
+void TreeEnumerator::setShard(const ShardSpec& shard) {
+	const uint64_t prefixesPerShard = 8;
+
+	_shard = shard;
+
+	// The k-th subclone can be placed under the root or under any of the k-1
+	// before it, so there are k! prefixes of depth k. The depth is the smallest
+	// one giving every shard several prefixes, which evens out their share.
+	_shardDepth = 1;
+	_numPrefixes = 1;
+	while(_shardDepth < _nodes.size() && _shardDepth < 20 &&
+			_numPrefixes < prefixesPerShard * _shard.count()) {
+		_shardDepth++;
+		_numPrefixes *= _shardDepth;
+	}
+}
+
+/**
+ * Place a subclone under the first candidate, from the given one on, that is
+ * allowed by the shard
+ *
+ * @return false if no candidate is left
+ */
+bool TreeEnumerator::placeFrom(size_t level, size_t position) {
+	for(; position < _candidates[level].size(); position++) {
+		// the placement completing a prefix numbers it, owned or not
+		if(_shard.isSharded() && level + 1 == _shardDepth && !_shard.owns(_nextPrefix++, _numPrefixes))
+			continue;
+
+		_candidates[level][position]->addChild(_nodes[level]);
+		_positions[level] = position;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Move the last placed subclone to its next candidate, going back up the
+ * placements when a subclone has run out of candidates
+ *
+ * @return false if there is no placement left
+ */
+bool TreeEnumerator::backtrack() {
+	while(!_positions.empty()) {
+		size_t level = _positions.size() - 1;
+		_candidates[level][_positions[level]]->removeChild(_nodes[level]);
+		if(placeFrom(level, _positions[level] + 1))
+			return true;
+
+		_positions.pop_back();
+		_candidates.pop_back();
+	}
+	return false;
+}
+
+/**
+ * Place the remaining subclones under their first candidates
+ *
+ * @return false if there is no placement left
+ */
+bool TreeEnumerator::fill() {
+	while(_positions.size() < _nodes.size()) {
+		size_t level = _positions.size();
+
+		// a subclone may go under any node already in the tree, visited in pre-order
+		_candidates.push_back(std::vector<TreeNode *>());
+		NodeCollectTraverser collector(_candidates.back());
+		TreeNode::PreOrderTraverse(_root, collector);
+		_positions.push_back(0);
+
+		if(!placeFrom(level, 0)) {
+			_positions.pop_back();
+			_candidates.pop_back();
+			if(!backtrack())
+				return false;
+		}
+	}
+	return true;
+}
+
+void TreeEnumerator::assess() {
+	NodeResetTraverser nrTraverser;
+	TreeNode::PreOrderTraverse(_root, nrTraverser);
+
+	FracAsnTraverser fracTraverser;
+	TreeNode::PostOrderTraverse(_root, fracTraverser);
+}
+
+bool TreeEnumerator::next() {
+	if(_finished)
+		return false;
+
+	bool placed;
+	if(!_started) {
+		_started = true;
+		// a root without any subclone is not a tree
+		placed = _nodes.size() > 0 && fill();
+	}
+	else
+		placed = backtrack() && fill();
+
+	if(!placed) {
+		_finished = true;
+		return false;
+	}
+
+	assess();
+	_numTrees++;
+	return true;
+}
+
+bool TreeEnumerator::isViable() const {
+	return _numTrees > 0 && _root->fraction() >= -EPISLON;
+}
+
+void TreeEnumerator::sortForPlacement(std::vector<EventCluster>& clusters) {
+	std::sort(clusters.begin(), clusters.end());
+	std::reverse(clusters.begin(), clusters.end());
+}
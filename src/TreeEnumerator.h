@@ -0,0 +1,146 @@
+#ifndef TREE_ENUMERATOR_H
+#define TREE_ENUMERATOR_H
+
+/**
+ * @file TreeEnumerator.h
+ * Interface description of the helper class TreeEnumerator
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "EventCluster.h"
+#include "ShardSpec.h"
+#include <vector>
+#include <stdint.h>
+
+namespace SubcloneSeeker {
+
+	// forward declaration, so that pointers can be made
+	class TreeNode;
+	class Subclone;
+
+	/**
+	 * @brief Enumerate every subclone tree that can be built from a list of clusters, one at a time
+	 *
+	 * Clusters of (nearly) the same cell fraction are grouped into one subclone. In
+	 * the placement order (see sortForPlacement), each subclone is placed under the
+	 * root or under any subclone placed before it, and every complete placement is
+	 * one tree. The enumeration keeps an explicit stack of placements instead of
+	 * recursing, so that it can be resumed by the caller: next() moves on to the
+	 * next complete tree and assesses its viability, leaving the fractions in the
+	 * nodes. The nodes are owned by the enumerator and reused from tree to tree.
+	 */
+	class TreeEnumerator {
+		protected:
+			std::vector<EventCluster> _clusters; /**< the clusters, in placement order */
+			Subclone *_root; /**< the root, holding no cluster */
+			std::vector<Subclone *> _nodes; /**< one subclone per group of clusters, in placement order */
+			std::vector<std::vector<TreeNode *> > _candidates; /**< for each placed subclone, the nodes it may be placed under */
+			std::vector<size_t> _positions; /**< for each placed subclone, the candidate it is placed under */
+
+			ShardSpec _shard; /**< the slice of the trees to enumerate */
+			size_t _shardDepth; /**< number of placements forming a prefix of a sharded run */
+			uint64_t _numPrefixes; /**< number of prefixes of that depth */
+			uint64_t _nextPrefix; /**< number of the next prefix to be completed */
+
+			bool _started; /**< whether the first tree has been built */
+			bool _finished; /**< whether all trees have been enumerated */
+			uint64_t _numTrees; /**< number of complete trees enumerated so far */
+
+			bool placeFrom(size_t level, size_t position);
+			bool backtrack();
+			bool fill();
+			void assess();
+
+		public:
+			/**
+			 * Constructor
+			 *
+			 * @param clusters The clusters to build the trees from, already in placement order
+			 */
+			TreeEnumerator(const std::vector<EventCluster>& clusters);
+
+			/**
+			 * Destructor, freeing the nodes
+			 */
+			~TreeEnumerator();
+
+			/**
+			 * Only enumerate one slice of the trees
+			 *
+			 * The placements of the first few subclones form a prefix, and the
+			 * prefixes are numbered in enumeration order; a shard only completes the
+			 * trees of the prefixes it owns. Should be called before the first next().
+			 *
+			 * @param shard The slice to enumerate
+			 */
+			void setShard(const ShardSpec& shard);
+
+			/**
+			 * Move on to the next complete tree and assess it
+			 *
+			 * @return false if all trees have been enumerated
+			 */
+			bool next();
+
+			/**
+			 * The root of the current tree
+			 *
+			 * @return the root, valid until the enumerator is destroyed
+			 */
+			inline Subclone *root() const {return _root;}
+
+			/**
+			 * Whether the current tree is viable, i.e. no subclone has a negative fraction
+			 *
+			 * @return true if the current tree is viable
+			 */
+			bool isViable() const;
+
+			/**
+			 * The subclones the trees are built from
+			 *
+			 * @return a reference to one subclone per group of clusters, in placement order
+			 */
+			inline const std::vector<Subclone *>& nodes() const {return _nodes;}
+
+			/**
+			 * The number of complete trees enumerated so far, viable or not
+			 *
+			 * @return the tree count
+			 */
+			inline uint64_t numTrees() const {return _numTrees;}
+
+			/**
+			 * Sort clusters into placement order, by decreasing cell fraction
+			 *
+			 * @param clusters The clusters to be sorted, in place
+			 */
+			static void sortForPlacement(std::vector<EventCluster>& clusters);
+	};
+}
+
+#endif
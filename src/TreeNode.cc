@@ -37,6 +37,7 @@ using namespace SubcloneSeeker;
 void TreeNode::addChild(TreeNode *child)
 {
 	if(child==NULL) return;
+	materializeChildren();
 	
 	TreeNodeVec_t::iterator child_it = std::find(children.begin(), children.end(), child);
 	if(child_it != children.end()) return;
@@ -47,6 +48,7 @@ void TreeNode::addChild(TreeNode *child)
 
 void TreeNode::removeChild(TreeNode *child)
 {
+	materializeChildren();
 	TreeNodeVec_t::iterator child_it = std::find(children.begin(), children.end(), child);
 	if(child_it != children.end()) {
 		// child found in the node's children list, removing it from the vector
@@ -69,10 +71,13 @@ void TreeNode::PreOrderTraverse(TreeNode * root, TreeTraverseDelegate &traverseD
 
 	// Preprocess Hook
 	traverseDelegate.preprocessNode(root);
+	root->materializeChildren();
 	
-	// recursively traverse the children nodes
-	for(TreeNodeVec_t::iterator it = root->children.begin(); it != root->children.end(); it++) {
-		TreeNode::PreOrderTraverse(*it, traverseDelegate);
+	// recursively traverse the children nodes. The delegate may add and remove
+	// children on the way (see the tree enumeration of ssmain), which can move
+	// the vector, so it is walked by index rather than by iterator
+	for(size_t i=0; i<root->children.size(); i++) {
+		TreeNode::PreOrderTraverse(root->children[i], traverseDelegate);
 		// check if premature-termination has happened
 		if(traverseDelegate.isTerminated())
 			return;
@@ -93,10 +98,11 @@ void TreeNode::PostOrderTraverse(TreeNode * root, TreeTraverseDelegate &traverse
 	
 	// Preprocess Hook
 	traverseDelegate.preprocessNode(root);
+	root->materializeChildren();
 	
-	// recursively traverse the children nodes
-	for(TreeNodeVec_t::iterator it = root->children.begin(); it != root->children.end(); it++) {
-		TreeNode::PostOrderTraverse(*it, traverseDelegate);
+	// recursively traverse the children nodes, by index as in PreOrderTraverse
+	for(size_t i=0; i<root->children.size(); i++) {
+		TreeNode::PostOrderTraverse(root->children[i], traverseDelegate);
 		// check if premature-termination has happened
 		if(traverseDelegate.isTerminated())
 			return;
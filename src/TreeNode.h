@@ -117,6 +117,25 @@ namespace SubcloneSeeker{
 	protected:
 		TreeNodeVec_t children; /**< children node list */
 		TreeNode * parent;		/**< parent node */
+		bool _childrenPending;	/**< whether the children are yet to be loaded by loadPendingChildren */
+
+		/**
+		 * Load the children of a node created with _childrenPending set
+		 *
+		 * Called once, the first time the children are accessed. Nodes that are
+		 * always built in full, which is the default, never need it.
+		 */
+		virtual void loadPendingChildren() {;}
+
+		/**
+		 * Make sure the children are loaded
+		 */
+		inline void materializeChildren() {
+			if(_childrenPending) {
+				_childrenPending = false;
+				loadPendingChildren();
+			}
+		}
 
 	public:
 
@@ -126,7 +145,7 @@ namespace SubcloneSeeker{
 		/**
 		 * minimal constructor, reset all member variables
 		 */
-		TreeNode():parent(NULL) {;}
+		TreeNode():parent(NULL), _childrenPending(false) {;}
 
 		/**
 		 * declaring destructor to be virtual
@@ -138,7 +157,7 @@ namespace SubcloneSeeker{
 		 *
 		 * @return A std::vector of children node pointers
 		 */
-		inline TreeNodeVec_t& getVecChildren() {return children;}
+		inline TreeNodeVec_t& getVecChildren() {materializeChildren(); return children;}
 		
 		/** 
 		 * returns the node's parent.
@@ -190,7 +209,7 @@ namespace SubcloneSeeker{
 		 *
 		 * @return whether the node is a leaf node
 		 */
-		inline bool isLeaf() const {return children.size() == 0;}
+		inline bool isLeaf() const {const_cast<TreeNode *>(this)->materializeChildren(); return children.size() == 0;}
 
 		/**
 		 * whether the node is a root node
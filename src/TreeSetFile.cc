@@ -0,0 +1,389 @@
+/**
+ * @file TreeSetFile.cc
+ * Implementation of class TreeSetFile
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "TreeSetFile.h"
+#include "Subclone.h"
+#include "EventCluster.h"
+#include "SegmentalMutation.h"
+#include "SNP.h"
+#include "EventVisitor.h"
+#include <map>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace SubcloneSeeker;
+
+const char TreeSetFile::Magic[8] = {'S', 'S', 'T', 'R', 'E', 'E', 'S', '\0'};
+
+/**
+ * @brief A tree traverser that appends the nodes of a tree, in pre-order, to the tree-set sections
+ */
+class TreeSetWriteTraverser : public TreeTraverseDelegate {
+	protected:
+		std::map<TreeNode *, int32_t> _nodeIndex; /**< index within the current tree of each visited node */
+		std::map<EventCluster *, uint32_t> _clusterIndex; /**< index of each cluster already written */
+
+	public:
+		std::vector<TreeSetFile::NodeRecord> nodes;
+		std::vector<uint32_t> placements;
+		std::vector<TreeSetFile::ClusterRecord> clusters;
+		std::vector<TreeSetFile::EventRecord> events;
+
+		/**
+		 * Start a new tree
+		 */
+		void startTree() {
+			_nodeIndex.clear();
+		}
+
+		virtual void processNode(TreeNode *node) {
+			Subclone *clone = dynamic_cast<Subclone *>(node);
+
+			TreeSetFile::NodeRecord record;
+			memset(&record, 0, sizeof(record));
+			record.id = clone->getId();
+			record.fraction = clone->fraction();
+			record.treeFraction = clone->treeFraction();
+			record.firstPlacement = placements.size();
+			record.numPlacements = clone->vecEventCluster().size();
+
+			// the root of the tree may itself have a parent, which is not written
+			std::map<TreeNode *, int32_t>::iterator parentIt = _nodeIndex.find(node->getParent());
+			record.parent = parentIt == _nodeIndex.end() ? -1 : parentIt->second;
+
+			int32_t index = _nodeIndex.size();
+			_nodeIndex[node] = index;
+
+			for(size_t i=0; i<clone->vecEventCluster().size(); i++)
+				placements.push_back(indexOfCluster(clone->vecEventCluster()[i]));
+
+			nodes.push_back(record);
+		}
+
+		/**
+		 * Find the index of a cluster, writing it and its events the first time
+		 */
+		uint32_t indexOfCluster(EventCluster *cluster) {
+			std::map<EventCluster *, uint32_t>::iterator it = _clusterIndex.find(cluster);
+			if(it != _clusterIndex.end())
+				return it->second;
+
+			TreeSetFile::ClusterRecord record;
+			memset(&record, 0, sizeof(record));
+			record.id = cluster->getId();
+			record.cellFraction = cluster->cellFraction();
+			record.firstEvent = events.size();
+			record.numEvents = cluster->memberCount();
+
+			for(EventCluster::member_iterator it = cluster->beginMembers(); it != cluster->endMembers(); it++) {
+				SomaticEvent *event = *it;
+				TreeSetFile::EventRecord eventRecord;
+				memset(&eventRecord, 0, sizeof(eventRecord));
+				eventRecord.id = event->getId();
+				eventRecord.frequency = event->frequency;
+
+				GenomicRange extent = eventExtent(event);
+				eventRecord.chrom = extent.chrom;
+				eventRecord.position = extent.position;
+				eventRecord.length = extent.length;
+				switch(event->kind()) {
+					case SomaticEvent::KIND_LOH:
+						eventRecord.type = TreeSetFile::EVENT_LOH;
+						break;
+					case SomaticEvent::KIND_SNP:
+						eventRecord.type = TreeSetFile::EVENT_SNP;
+						break;
+					default:
+						eventRecord.type = TreeSetFile::EVENT_CNV;
+				}
+				events.push_back(eventRecord);
+			}
+
+			uint32_t index = clusters.size();
+			clusters.push_back(record);
+			_clusterIndex[cluster] = index;
+			return index;
+		}
+};
+
+/**
+ * Order tree records by their root id
+ */
+static bool treeRecordLess(const TreeSetFile::TreeRecord& a, const TreeSetFile::TreeRecord& b) {
+	return a.rootID < b.rootID;
+}
+
+/**
+ * Round an offset up to the next multiple of 8
+ */
+static uint64_t alignedOffset(uint64_t offset) {
+	return (offset + 7) & ~(uint64_t)7;
+}
+
+/**
+ * Write a section at its offset, padding the file up to it
+ */
+template <class T>
+static bool writeSection(FILE *fp, uint64_t offset, const std::vector<T>& records) {
+	static const char padding[8] = {0};
+	long pos = ftell(fp);
+	if(pos < 0 || (uint64_t)pos > offset)
+		return false;
+	if(offset > (uint64_t)pos && fwrite(padding, 1, offset - pos, fp) != offset - pos)
+		return false;
+	if(records.size() > 0 && fwrite(&records[0], sizeof(T), records.size(), fp) != records.size())
+		return false;
+	return true;
+}
+
+bool TreeSetFile::write(const char *filename, const std::vector<Subclone *>& roots) {
+	TreeSetWriteTraverser writer;
+	std::vector<TreeRecord> trees;
+
+	for(size_t i=0; i<roots.size(); i++) {
+		TreeRecord tree;
+		memset(&tree, 0, sizeof(tree));
+		tree.rootID = roots[i]->getId() != 0 ? roots[i]->getId() : (int64_t)(i+1);
+		tree.firstNode = writer.nodes.size();
+
+		writer.startTree();
+		TreeNode::PreOrderTraverse(roots[i], writer);
+
+		tree.nodeCount = writer.nodes.size() - tree.firstNode;
+		trees.push_back(tree);
+	}
+	std::stable_sort(trees.begin(), trees.end(), treeRecordLess);
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.byteOrder = ByteOrderMark;
+	header.numTrees = trees.size();
+	header.numNodes = writer.nodes.size();
+	header.numPlacements = writer.placements.size();
+	header.numClusters = writer.clusters.size();
+	header.numEvents = writer.events.size();
+	header.treesOffset = alignedOffset(sizeof(Header));
+	header.nodesOffset = alignedOffset(header.treesOffset + header.numTrees * sizeof(TreeRecord));
+	header.placementsOffset = alignedOffset(header.nodesOffset + header.numNodes * sizeof(NodeRecord));
+	header.clustersOffset = alignedOffset(header.placementsOffset + header.numPlacements * sizeof(uint32_t));
+	header.eventsOffset = alignedOffset(header.clustersOffset + header.numClusters * sizeof(ClusterRecord));
+
+	FILE *fp = fopen(filename, "wb");
+	if(fp == NULL)
+		return false;
+
+	bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		writeSection(fp, header.treesOffset, trees) &&
+		writeSection(fp, header.nodesOffset, writer.nodes) &&
+		writeSection(fp, header.placementsOffset, writer.placements) &&
+		writeSection(fp, header.clustersOffset, writer.clusters) &&
+		writeSection(fp, header.eventsOffset, writer.events);
+
+	if(fclose(fp) != 0)
+		ok = false;
+	return ok;
+}
+
+bool TreeSetFile::isTreeSetFile(const char *filename) {
+	char magic[sizeof(Magic)];
+	FILE *fp = fopen(filename, "rb");
+	if(fp == NULL)
+		return false;
+	bool isTreeSet = fread(magic, sizeof(magic), 1, fp) == 1 && memcmp(magic, Magic, sizeof(Magic)) == 0;
+	fclose(fp);
+	return isTreeSet;
+}
+
+/**
+ * Check that a section lies within the file and is aligned
+ */
+static bool sectionFits(uint64_t offset, uint64_t count, size_t recordSize, size_t fileSize) {
+	if(offset % 8 != 0 || offset > fileSize)
+		return false;
+	return count <= (fileSize - offset) / recordSize;
+}
+
+bool TreeSetFile::open(const char *filename) {
+	close();
+
+	int fd = ::open(filename, O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+		::close(fd);
+		return false;
+	}
+
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if(map == MAP_FAILED)
+		return false;
+
+	_map = map;
+	_size = st.st_size;
+	_header = (const Header *)_map;
+
+	if(memcmp(_header->magic, Magic, sizeof(Magic)) != 0 ||
+			_header->byteOrder != ByteOrderMark ||
+			_header->version != Version ||
+			!sectionFits(_header->treesOffset, _header->numTrees, sizeof(TreeRecord), _size) ||
+			!sectionFits(_header->nodesOffset, _header->numNodes, sizeof(NodeRecord), _size) ||
+			!sectionFits(_header->placementsOffset, _header->numPlacements, sizeof(uint32_t), _size) ||
+			!sectionFits(_header->clustersOffset, _header->numClusters, sizeof(ClusterRecord), _size) ||
+			!sectionFits(_header->eventsOffset, _header->numEvents, sizeof(EventRecord), _size)) {
+		close();
+		return false;
+	}
+
+	_clusters.assign(_header->numClusters, (EventCluster *)NULL);
+	return true;
+}
+
+void TreeSetFile::close() {
+	for(size_t i=0; i<_clusters.size(); i++) {
+		if(_clusters[i] == NULL)
+			continue;
+		for(EventCluster::member_iterator it = _clusters[i]->beginMembers(); it != _clusters[i]->endMembers(); it++)
+			delete *it;
+		delete _clusters[i];
+	}
+	_clusters.clear();
+
+	if(_map != NULL)
+		munmap(_map, _size);
+	_map = NULL;
+	_size = 0;
+	_header = NULL;
+}
+
+DBObjectID_vec TreeSetFile::rootIDs() const {
+	DBObjectID_vec ids;
+	const TreeRecord *trees = (const TreeRecord *)((const char *)_map + (_header ? _header->treesOffset : 0));
+	for(size_t i=0; i<numTrees(); i++)
+		ids.push_back(trees[i].rootID);
+	return ids;
+}
+
+const TreeSetFile::TreeRecord *TreeSetFile::treeWithRootID(sqlite3_int64 rootID) const {
+	if(_header == NULL)
+		return NULL;
+
+	const TreeRecord *first = (const TreeRecord *)((const char *)_map + _header->treesOffset);
+	const TreeRecord *last = first + _header->numTrees;
+
+	TreeRecord key;
+	key.rootID = rootID;
+	const TreeRecord *found = std::lower_bound(first, last, key, treeRecordLess);
+	if(found == last || found->rootID != rootID)
+		return NULL;
+	return found;
+}
+
+Subclone *TreeSetFile::expandTree(sqlite3_int64 rootID, ObjectArena *arena) {
+	const TreeRecord *tree = treeWithRootID(rootID);
+	if(tree == NULL || tree->nodeCount == 0 || (uint64_t)tree->firstNode + tree->nodeCount > _header->numNodes)
+		return NULL;
+
+	const NodeRecord *records = nodesOfTree(*tree);
+	std::vector<Subclone *> nodes;
+
+	for(size_t i=0; i<tree->nodeCount; i++) {
+		const NodeRecord& record = records[i];
+		Subclone *clone = ObjectArena::create<Subclone>(arena);
+		clone->setId(record.id);
+		clone->setFraction(record.fraction);
+		clone->setTreeFraction(record.treeFraction);
+
+		// pre-order guarantees the parent has already been created
+		if(record.parent >= 0 && (size_t)record.parent < i) {
+			clone->setParentId(nodes[record.parent]->getId());
+			nodes[record.parent]->addChild(clone);
+		}
+
+		if((uint64_t)record.firstPlacement + record.numPlacements <= _header->numPlacements) {
+			const uint32_t *placements = placementsOfNode(record);
+			for(size_t j=0; j<record.numPlacements; j++) {
+				uint32_t index = placements[j];
+				if(index >= _clusters.size())
+					continue;
+
+				if(_clusters[index] == NULL) {
+					const ClusterRecord& clusterRecord = cluster(index);
+					EventCluster *newCluster = new EventCluster();
+					newCluster->setId(clusterRecord.id);
+					newCluster->setCellFraction(clusterRecord.cellFraction);
+
+					if((uint64_t)clusterRecord.firstEvent + clusterRecord.numEvents <= _header->numEvents) {
+						const EventRecord *events = eventsOfCluster(clusterRecord);
+						for(size_t k=0; k<clusterRecord.numEvents; k++) {
+							SomaticEvent *event;
+							if(events[k].type == EVENT_SNP) {
+								SNP *snp = new SNP();
+								snp->location.chrom = events[k].chrom;
+								snp->location.position = events[k].position;
+								event = snp;
+							}
+							else {
+								SegmentalMutation *segment;
+								if(events[k].type == EVENT_LOH)
+									segment = new LOH();
+								else
+									segment = new CNV();
+								segment->range.chrom = events[k].chrom;
+								segment->range.position = events[k].position;
+								segment->range.length = events[k].length;
+								event = segment;
+							}
+							event->setId(events[k].id);
+							event->setClusterID(clusterRecord.id);
+							event->frequency = events[k].frequency;
+							newCluster->addEvent(event, false);
+						}
+					}
+					_clusters[index] = newCluster;
+				}
+				clone->addEventCluster(_clusters[index]);
+			}
+		}
+
+		nodes.push_back(clone);
+	}
+
+	return nodes[0];
+}
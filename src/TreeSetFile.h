@@ -0,0 +1,251 @@
+#ifndef TREE_SET_FILE_H
+#define TREE_SET_FILE_H
+
+/**
+ * @file TreeSetFile.h
+ * Interface description of the binary tree-set archive TreeSetFile
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "Archivable.h"
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace SubcloneSeeker {
+
+	// forward declaration, so that pointers can be made
+	class Subclone;
+	class EventCluster;
+
+	/**
+	 * @brief A read-only, memory mapped file holding a whole set of subclone trees
+	 *
+	 * The file is laid out as a Header followed by five sections of fixed width
+	 * records, each starting at an 8-byte aligned offset given in the header:
+	 * . the tree index, one TreeRecord per tree, sorted by root id
+	 * . the nodes of all trees; the nodes of a tree are contiguous and in pre-order
+	 * . the cluster placements, one cluster index per (node, cluster) pair
+	 * . the clusters, each owning a contiguous range of events
+	 * . the events
+	 *
+	 * All numbers are in host byte order; the header records the byte order and a
+	 * file written on a host of the other byte order is refused. Records are read
+	 * in place from the mapping, without any decoding. Trees can also be expanded
+	 * into Subclone objects, so that the format can replace a subclone database as
+	 * the input of the tools.
+	 */
+	class TreeSetFile {
+		public:
+			static const char Magic[8]; /**< the first bytes of every tree-set file */
+			static const uint32_t Version = 1; /**< the format version written by this library */
+			static const uint32_t ByteOrderMark = 0x01020304; /**< reads differently on a host of the other byte order */
+
+			/** File header */
+			struct Header {
+				char magic[8];
+				uint32_t version;
+				uint32_t byteOrder;
+				uint64_t numTrees;
+				uint64_t numNodes;
+				uint64_t numPlacements;
+				uint64_t numClusters;
+				uint64_t numEvents;
+				uint64_t treesOffset;
+				uint64_t nodesOffset;
+				uint64_t placementsOffset;
+				uint64_t clustersOffset;
+				uint64_t eventsOffset;
+			};
+
+			/** Entry of the tree index */
+			struct TreeRecord {
+				int64_t rootID; /**< id of the root node */
+				uint32_t firstNode; /**< index of the root in the node section */
+				uint32_t nodeCount; /**< number of nodes of the tree */
+			};
+
+			/** A subclone */
+			struct NodeRecord {
+				int64_t id; /**< id of the node */
+				double fraction; /**< fraction of the subclone */
+				double treeFraction; /**< fraction of the subtree rooted at the node */
+				int32_t parent; /**< index of the parent within the tree, -1 for the root */
+				uint32_t firstPlacement; /**< index of the first placement of the node */
+				uint32_t numPlacements; /**< number of clusters on the node */
+				uint32_t reserved; /**< padding, always 0 */
+			};
+
+			/** An event cluster */
+			struct ClusterRecord {
+				int64_t id; /**< id of the cluster */
+				double cellFraction; /**< cell fraction of the cluster */
+				uint32_t firstEvent; /**< index of the first member event */
+				uint32_t numEvents; /**< number of member events */
+			};
+
+			/** Kind of an EventRecord */
+			enum EventType {
+				EVENT_CNV = 0,
+				EVENT_LOH = 1,
+				EVENT_SNP = 2
+			};
+
+			/** A somatic event */
+			struct EventRecord {
+				int64_t id; /**< id of the event */
+				uint32_t type; /**< one of EventType */
+				int32_t chrom; /**< chromosome */
+				uint64_t position; /**< 0-based position */
+				uint64_t length; /**< length of a segmental event, 0 for a SNP */
+				double frequency; /**< cell frequency */
+			};
+
+		protected:
+			void *_map; /**< the mapped file, NULL if not open */
+			size_t _size; /**< the size of the mapping */
+			const Header *_header; /**< the header, at the start of the mapping */
+			std::vector<EventCluster *> _clusters; /**< the clusters expanded so far, shared by all expanded trees */
+
+		public:
+			/**
+			 * Minimal constructor to reset all member variables
+			 */
+			TreeSetFile() : _map(NULL), _size(0), _header(NULL) {;}
+
+			/**
+			 * Destructor, closes the file
+			 */
+			~TreeSetFile() {close();}
+
+			/**
+			 * Write a set of trees into a tree-set file
+			 *
+			 * Clusters are stored once, however many nodes they are placed on. A root with
+			 * id 0 is given its position in the set, starting from 1, as id.
+			 *
+			 * @param filename The file to be written; an existing file is replaced
+			 * @param roots The roots of the trees
+			 * @return Whether the file has been written
+			 */
+			static bool write(const char *filename, const std::vector<Subclone *>& roots);
+
+			/**
+			 * Check whether a file starts with the tree-set magic
+			 *
+			 * @param filename The file to be checked
+			 * @return true if the file looks like a tree-set file
+			 */
+			static bool isTreeSetFile(const char *filename);
+
+			/**
+			 * Map a tree-set file read-only
+			 *
+			 * @param filename The file to be opened
+			 * @return false if the file cannot be mapped, or is not a valid tree-set file of this version
+			 */
+			bool open(const char *filename);
+
+			/**
+			 * Unmap the file. Trees expanded from it remain valid, but their clusters are freed
+			 */
+			void close();
+
+			inline size_t numTrees() const {return _header ? _header->numTrees : 0;} /**< number of trees */
+			inline size_t numClusters() const {return _header ? _header->numClusters : 0;} /**< number of clusters */
+
+			/**
+			 * The ids of the roots of all trees
+			 *
+			 * @return the root ids, in increasing order
+			 */
+			DBObjectID_vec rootIDs() const;
+
+			/**
+			 * Look up a tree by the id of its root
+			 *
+			 * @param rootID The root id
+			 * @return the tree record in the mapping, NULL if not found
+			 */
+			const TreeRecord *treeWithRootID(sqlite3_int64 rootID) const;
+
+			/**
+			 * The nodes of a tree, in pre-order
+			 *
+			 * @param tree A record of the tree index
+			 * @return pointer to the first of tree.nodeCount node records in the mapping
+			 */
+			inline const NodeRecord *nodesOfTree(const TreeRecord& tree) const {
+				return (const NodeRecord *)((const char *)_map + _header->nodesOffset) + tree.firstNode;
+			}
+
+			/**
+			 * The clusters placed on a node
+			 *
+			 * @param node A node record
+			 * @return pointer to the first of node.numPlacements cluster indexes in the mapping
+			 */
+			inline const uint32_t *placementsOfNode(const NodeRecord& node) const {
+				return (const uint32_t *)((const char *)_map + _header->placementsOffset) + node.firstPlacement;
+			}
+
+			/**
+			 * A cluster record
+			 *
+			 * @param index The cluster index, as found in the placements
+			 * @return reference to the cluster record in the mapping
+			 */
+			inline const ClusterRecord& cluster(uint32_t index) const {
+				return ((const ClusterRecord *)((const char *)_map + _header->clustersOffset))[index];
+			}
+
+			/**
+			 * The member events of a cluster
+			 *
+			 * @param cluster A cluster record
+			 * @return pointer to the first of cluster.numEvents event records in the mapping
+			 */
+			inline const EventRecord *eventsOfCluster(const ClusterRecord& cluster) const {
+				return (const EventRecord *)((const char *)_map + _header->eventsOffset) + cluster.firstEvent;
+			}
+
+			/**
+			 * Expand a tree into Subclone objects
+			 *
+			 * The clusters and events are allocated once per file and shared by all trees
+			 * expanded from it; they are owned by this object. The nodes are owned by the caller,
+			 * or by the arena if one is given.
+			 *
+			 * @param rootID The id of the root of the tree
+			 * @param arena The arena the nodes are made in, NULL to allocate them on the heap
+			 * @return the root of a newly allocated tree, NULL if not found
+			 */
+			Subclone *expandTree(sqlite3_int64 rootID, ObjectArena *arena = NULL);
+	};
+}
+
+#endif
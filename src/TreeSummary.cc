@@ -0,0 +1,137 @@
+/**
+ * @file TreeSummary.cc
+ * Implementation of class TreeSummary
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "TreeSummary.h"
+#include "TreeNode.h"
+#include <sstream>
+
+using namespace SubcloneSeeker;
+
+/**
+ * @brief A tree traverser that counts the nodes and leaves, and tracks the depth of a tree
+ */
+class TreeSummaryTraverser : public TreeTraverseDelegate {
+	protected:
+		TreeNode *_root; /**< the root of the summarized tree, which may have a parent itself */
+
+	public:
+		int nodeCount;
+		int leafCount;
+		int depth;
+
+	public:
+		TreeSummaryTraverser(TreeNode *root): _root(root), nodeCount(0), leafCount(0), depth(0) {;}
+
+		virtual void processNode(TreeNode *node) {
+			nodeCount++;
+			if(node->isLeaf()) {
+				leafCount++;
+
+				int level = 1;
+				for(TreeNode *p = node; p != _root; p = p->getParent())
+					level++;
+				if(level > depth)
+					depth = level;
+			}
+		}
+};
+
+void TreeSummary::summarize(TreeNode *root) {
+	TreeSummaryTraverser traverser(root);
+	if(root != NULL)
+		TreeNode::PreOrderTraverse(root, traverser);
+
+	_nodeCount = traverser.nodeCount;
+	_leafCount = traverser.leafCount;
+	_depth = traverser.depth;
+}
+
+bool TreeSummary::isSortKey(const std::string& sortKey) {
+	return sortKey == "rootID" || sortKey == "nodeCount" || sortKey == "depth" || sortKey == "leafCount" || sortKey == "score";
+}
+
+std::vector<TreeSummary *> TreeSummary::summariesFromDB(sqlite3 *database, const std::string& sortKey, int maxDepth, int maxNodeCount) {
+	std::vector<TreeSummary *> result;
+
+	// the key is pasted into the statement, so only known columns are accepted
+	if(!isSortKey(sortKey))
+		return result;
+
+	std::ostringstream where;
+	where<<"1";
+	if(maxDepth > 0)
+		where<<" AND depth<="<<maxDepth;
+	if(maxNodeCount > 0)
+		where<<" AND nodeCount<="<<maxNodeCount;
+
+	unarchiveObjectsFromDBWhere(database, where.str(), result, sortKey + ", id");
+	return result;
+}
+
+/**********************************/
+/*  IMPLEMENTATION OF Archivable  */
+/**********************************/
+
+static const ArchiveField TreeSummaryFields[] = {
+	{"rootID", "INTEGER NOT NULL", true},
+	{"encoding", "INTEGER NOT NULL", false},
+	{"nodeCount", "INTEGER NOT NULL", true},
+	{"depth", "INTEGER NOT NULL", true},
+	{"leafCount", "INTEGER NOT NULL", false},
+	{"score", "REAL", true}
+};
+
+const TableSchema& TreeSummary::tableSchema() {
+	static const TableSchema schema("Trees", TreeSummaryFields);
+	return schema;
+}
+
+void TreeSummary::encodeObject(ArchiveRecord& record) {
+	record.appendInteger(_rootID);
+	record.appendInteger(_encoding);
+	record.appendInteger(_nodeCount);
+	record.appendInteger(_depth);
+	record.appendInteger(_leafCount);
+	if(_hasScore)
+		record.appendReal(_score);
+	else
+		record.appendNull();
+}
+
+void TreeSummary::decodeObject(const ArchiveRecord& record) {
+	int col_pos = 0;
+	_rootID = record.integerAt(col_pos++);
+	_encoding = record.integerAt(col_pos++);
+	_nodeCount = record.integerAt(col_pos++);
+	_depth = record.integerAt(col_pos++);
+	_leafCount = record.integerAt(col_pos++);
+	_hasScore = !record.isNullAt(col_pos);
+	_score = record.realAt(col_pos++);
+}
@@ -0,0 +1,134 @@
+#ifndef TREE_SUMMARY_H
+#define TREE_SUMMARY_H
+
+/**
+ * @file TreeSummary.h
+ * Interface description of the data structure class TreeSummary
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "Archivable.h"
+#include <vector>
+
+namespace SubcloneSeeker {
+
+	// forward declaration, so that pointers can be made
+	class TreeNode;
+
+	/**
+	 * @brief Per-tree facts stored alongside a saved subclone tree
+	 *
+	 * One record is written for each tree when it is saved, so that trees can be
+	 * listed, filtered and sorted by a single indexed query on the Trees table,
+	 * without loading and traversing them. The root id refers either to a record
+	 * in the Subclones table, or to a record in the CompactTrees table, as given
+	 * by the encoding.
+	 */
+	class TreeSummary : public Archivable {
+		public:
+			/** How the summarized tree is stored */
+			enum Encoding {
+				ENCODING_SUBCLONES = 0, /**< one Subclones record per node, rootID is the root node */
+				ENCODING_COMPACT = 1 /**< a single CompactTrees record, rootID is that record */
+			};
+
+		protected:
+			sqlite3_int64 _rootID; /**< id of the stored tree */
+			int _encoding; /**< how the tree is stored, one of Encoding */
+			int _nodeCount; /**< number of nodes, including the root */
+			int _depth; /**< number of nodes on the longest root to leaf path */
+			int _leafCount; /**< number of leaves */
+			double _score; /**< fit score of the tree, only valid if _hasScore */
+			bool _hasScore; /**< whether a fit score has been given */
+
+		protected:
+			// Implements Archivable
+			virtual const TableSchema& tableSchema();
+
+			virtual void encodeObject(ArchiveRecord& record);
+			virtual void decodeObject(const ArchiveRecord& record);
+
+		public:
+			/**
+			 * Minimal constructor to reset all member variables
+			 */
+			TreeSummary() : Archivable(), _rootID(0), _encoding(ENCODING_SUBCLONES),
+				_nodeCount(0), _depth(0), _leafCount(0), _score(0), _hasScore(false) {;}
+
+			/**
+			 * Compute node count, depth and leaf count of a tree
+			 *
+			 * @param root The root of the tree to be summarized
+			 */
+			void summarize(TreeNode *root);
+
+			/**
+			 * Check if summaries can be sorted by a key
+			 *
+			 * @param sortKey The name of the column to sort by
+			 * @return whether the key is one of "rootID", "nodeCount", "depth", "leafCount" or "score"
+			 */
+			static bool isSortKey(const std::string& sortKey);
+
+			/**
+			 * Retrieve all summaries, optionally filtered and sorted
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @param sortKey One of "rootID", "nodeCount", "depth", "leafCount" or "score"
+			 * @param maxDepth Only trees not deeper than this are returned, 0 for no limit
+			 * @param maxNodeCount Only trees with at most this many nodes are returned, 0 for no limit
+			 * @return newly allocated summaries, empty if the table does not exist or the key is unknown
+			 */
+			static std::vector<TreeSummary *> summariesFromDB(sqlite3 *database, const std::string& sortKey = "rootID",
+					int maxDepth = 0, int maxNodeCount = 0);
+
+			/**
+			 * Setter of the stored tree
+			 *
+			 * @param rootID The id of the stored tree
+			 * @param encoding How the tree is stored
+			 */
+			inline void setRoot(sqlite3_int64 rootID, Encoding encoding) {_rootID = rootID; _encoding = encoding;}
+
+			/**
+			 * Setter of the fit score
+			 *
+			 * @param score The fit score of the tree
+			 */
+			inline void setScore(double score) {_score = score; _hasScore = true;}
+
+			inline sqlite3_int64 rootID() const {return _rootID;} /**< id of the stored tree */
+			inline Encoding encoding() const {return (Encoding)_encoding;} /**< how the tree is stored */
+			inline int nodeCount() const {return _nodeCount;} /**< number of nodes */
+			inline int depth() const {return _depth;} /**< number of levels */
+			inline int leafCount() const {return _leafCount;} /**< number of leaves */
+			inline bool hasScore() const {return _hasScore;} /**< whether a score is available */
+			inline double score() const {return _score;} /**< the fit score, if hasScore() */
+	};
+}
+
+#endif
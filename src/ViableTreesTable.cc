@@ -0,0 +1,331 @@
+/**
+ * @file ViableTreesTable.cc
+ * Implementation of the sqlite3 virtual table module ViableTreesTable
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "ViableTreesTable.h"
+#include "TreeEnumerator.h"
+#include "TreeSummary.h"
+#include "Subclone.h"
+#include "StorageBackend.h"
+#include <string>
+#include <vector>
+#include <map>
+
+using namespace SubcloneSeeker;
+
+const char *ViableTreesTable::ModuleName = "viable_trees";
+
+enum {
+	COLUMN_TREE_ID = 0,
+	COLUMN_NODE,
+	COLUMN_PARENT,
+	COLUMN_DEPTH,
+	COLUMN_FRACTION,
+	COLUMN_TREE_FRACTION,
+	COLUMN_CLUSTER_ID,
+	COLUMN_TREE_DEPTH
+};
+
+/**
+ * A declared table, holding the clusters the trees are built from
+ */
+struct ViableTreesVTab {
+	sqlite3_vtab base; /**< must come first */
+	std::vector<EventCluster> clusters; /**< the clusters, in placement order */
+};
+
+/**
+ * One row, i.e. a (node, cluster) pair of the current tree
+ */
+struct ViableTreesRow {
+	int node;
+	int parent; /**< -1 for the root */
+	int depth;
+	double fraction;
+	double treeFraction;
+	sqlite3_int64 clusterID; /**< 0 for the root */
+};
+
+/**
+ * A scan of a table, enumerating the trees
+ */
+struct ViableTreesCursor {
+	sqlite3_vtab_cursor base; /**< must come first */
+	TreeEnumerator *enumerator;
+	std::map<TreeNode *, int> nodeOfSubclone; /**< the node number of each subclone of the enumerator */
+	std::vector<ViableTreesRow> rows; /**< the rows of the current tree */
+	size_t row; /**< the current row */
+	sqlite3_int64 treeID; /**< the number of the current tree */
+	int treeDepth; /**< the depth of the current tree */
+	sqlite3_int64 rowID; /**< the number of the current row within the scan */
+	bool eof;
+};
+
+/**
+ * @brief A tree traverser turning the nodes of a tree into rows
+ */
+class ViableTreesRowTraverser : public TreeTraverseDelegate {
+	protected:
+		std::map<TreeNode *, int>& _nodeOfSubclone;
+		std::vector<ViableTreesRow>& _rows;
+		std::map<int, int> _depthOfNode;
+
+	public:
+		ViableTreesRowTraverser(std::map<TreeNode *, int>& nodeOfSubclone, std::vector<ViableTreesRow>& rows):
+			_nodeOfSubclone(nodeOfSubclone), _rows(rows) {;}
+
+		virtual void processNode(TreeNode *node) {
+			Subclone *clone = dynamic_cast<Subclone *>(node);
+
+			ViableTreesRow row;
+			row.node = _nodeOfSubclone[node];
+			row.parent = -1;
+			row.depth = 0;
+			if(node->getParent() != NULL) {
+				row.parent = _nodeOfSubclone[node->getParent()];
+				row.depth = _depthOfNode[row.parent] + 1;
+			}
+			_depthOfNode[row.node] = row.depth;
+			row.fraction = clone->fraction();
+			row.treeFraction = clone->treeFraction();
+			row.clusterID = 0;
+
+			if(clone->vecEventCluster().size() == 0)
+				_rows.push_back(row);
+			for(size_t i=0; i<clone->vecEventCluster().size(); i++) {
+				row.clusterID = clone->vecEventCluster()[i]->getId();
+				_rows.push_back(row);
+			}
+		}
+};
+
+/**
+ * Move a cursor to the first row of the next viable tree
+ */
+static void nextViableTree(ViableTreesCursor *cursor) {
+	cursor->rows.clear();
+	cursor->row = 0;
+
+	while(cursor->enumerator->next()) {
+		if(!cursor->enumerator->isViable())
+			continue;
+
+		ViableTreesRowTraverser traverser(cursor->nodeOfSubclone, cursor->rows);
+		TreeNode::PreOrderTraverse(cursor->enumerator->root(), traverser);
+
+		TreeSummary summary;
+		summary.summarize(cursor->enumerator->root());
+		cursor->treeDepth = summary.depth();
+		cursor->treeID++;
+		return;
+	}
+
+	cursor->eof = true;
+}
+
+/**
+ * Strip the quotes around a module argument, if any
+ */
+static std::string unquoteArgument(const char *argument) {
+	std::string str(argument);
+	if(str.size() >= 2 && (str[0] == '\'' || str[0] == '"') && str[str.size()-1] == str[0])
+		return str.substr(1, str.size()-2);
+	return str;
+}
+
+static int viableTreesConnect(sqlite3 *database, void *, int argc, const char * const *argv,
+		sqlite3_vtab **ppVTab, char **pzErr) {
+	// argv[0..2] are the module, database and table names
+	if(argc != 4) {
+		*pzErr = sqlite3_mprintf("%s takes the cluster database as its only argument", ViableTreesTable::ModuleName);
+		return SQLITE_ERROR;
+	}
+
+	std::string filename = unquoteArgument(argv[3]);
+	StorageBackend *input = StorageBackend::open(filename.c_str(), StorageBackend::kindOfFile(filename.c_str()), true);
+	if(input == NULL) {
+		*pzErr = sqlite3_mprintf("unable to open cluster database %s", filename.c_str());
+		return SQLITE_ERROR;
+	}
+
+	// only the cell fractions are needed to enumerate the trees, not the members
+	ViableTreesVTab *vtab = new ViableTreesVTab();
+	EventCluster dummyCluster;
+	DBObjectID_vec clusterIDs = dummyCluster.vecAllObjectsID(*input);
+	for(size_t i=0; i<clusterIDs.size(); i++) {
+		EventCluster cluster;
+		if(cluster.unarchiveObject(*input, clusterIDs[i]))
+			vtab->clusters.push_back(cluster);
+	}
+	delete input;
+
+	TreeEnumerator::sortForPlacement(vtab->clusters);
+
+	int rc = sqlite3_declare_vtab(database, "CREATE TABLE x(tree_id INTEGER, node INTEGER, parent INTEGER, "
+			"depth INTEGER, fraction REAL, tree_fraction REAL, cluster_id INTEGER, tree_depth INTEGER)");
+	if(rc != SQLITE_OK) {
+		delete vtab;
+		return rc;
+	}
+
+	*ppVTab = &vtab->base;
+	return SQLITE_OK;
+}
+
+static int viableTreesDisconnect(sqlite3_vtab *pVTab) {
+	delete (ViableTreesVTab *)pVTab;
+	return SQLITE_OK;
+}
+
+static int viableTreesBestIndex(sqlite3_vtab *, sqlite3_index_info *pIdxInfo) {
+	// no constraint can be used, every scan is a full enumeration
+	pIdxInfo->estimatedCost = 1e9;
+	return SQLITE_OK;
+}
+
+static int viableTreesOpen(sqlite3_vtab *, sqlite3_vtab_cursor **ppCursor) {
+	ViableTreesCursor *cursor = new ViableTreesCursor();
+	cursor->enumerator = NULL;
+	cursor->eof = true;
+	*ppCursor = &cursor->base;
+	return SQLITE_OK;
+}
+
+static int viableTreesClose(sqlite3_vtab_cursor *pCursor) {
+	ViableTreesCursor *cursor = (ViableTreesCursor *)pCursor;
+	delete cursor->enumerator;
+	delete cursor;
+	return SQLITE_OK;
+}
+
+static int viableTreesFilter(sqlite3_vtab_cursor *pCursor, int, const char *, int, sqlite3_value **) {
+	ViableTreesCursor *cursor = (ViableTreesCursor *)pCursor;
+	ViableTreesVTab *vtab = (ViableTreesVTab *)pCursor->pVtab;
+
+	delete cursor->enumerator;
+	cursor->enumerator = new TreeEnumerator(vtab->clusters);
+
+	cursor->nodeOfSubclone.clear();
+	cursor->nodeOfSubclone[cursor->enumerator->root()] = 0;
+	for(size_t i=0; i<cursor->enumerator->nodes().size(); i++)
+		cursor->nodeOfSubclone[cursor->enumerator->nodes()[i]] = i+1;
+
+	cursor->treeID = 0;
+	cursor->rowID = 1;
+	cursor->eof = false;
+	nextViableTree(cursor);
+	return SQLITE_OK;
+}
+
+static int viableTreesNext(sqlite3_vtab_cursor *pCursor) {
+	ViableTreesCursor *cursor = (ViableTreesCursor *)pCursor;
+	cursor->rowID++;
+	cursor->row++;
+	if(cursor->row >= cursor->rows.size())
+		nextViableTree(cursor);
+	return SQLITE_OK;
+}
+
+static int viableTreesEof(sqlite3_vtab_cursor *pCursor) {
+	return ((ViableTreesCursor *)pCursor)->eof;
+}
+
+static int viableTreesColumn(sqlite3_vtab_cursor *pCursor, sqlite3_context *context, int column) {
+	ViableTreesCursor *cursor = (ViableTreesCursor *)pCursor;
+	const ViableTreesRow& row = cursor->rows[cursor->row];
+
+	switch(column) {
+		case COLUMN_TREE_ID:
+			sqlite3_result_int64(context, cursor->treeID);
+			break;
+		case COLUMN_NODE:
+			sqlite3_result_int(context, row.node);
+			break;
+		case COLUMN_PARENT:
+			if(row.parent < 0)
+				sqlite3_result_null(context);
+			else
+				sqlite3_result_int(context, row.parent);
+			break;
+		case COLUMN_DEPTH:
+			sqlite3_result_int(context, row.depth);
+			break;
+		case COLUMN_FRACTION:
+			sqlite3_result_double(context, row.fraction);
+			break;
+		case COLUMN_TREE_FRACTION:
+			sqlite3_result_double(context, row.treeFraction);
+			break;
+		case COLUMN_CLUSTER_ID:
+			if(row.clusterID == 0)
+				sqlite3_result_null(context);
+			else
+				sqlite3_result_int64(context, row.clusterID);
+			break;
+		case COLUMN_TREE_DEPTH:
+			sqlite3_result_int(context, cursor->treeDepth);
+			break;
+	}
+	return SQLITE_OK;
+}
+
+static int viableTreesRowid(sqlite3_vtab_cursor *pCursor, sqlite3_int64 *pRowid) {
+	*pRowid = ((ViableTreesCursor *)pCursor)->rowID;
+	return SQLITE_OK;
+}
+
+static sqlite3_module ViableTreesModule = {
+	1,                      /* iVersion */
+	viableTreesConnect,     /* xCreate */
+	viableTreesConnect,     /* xConnect */
+	viableTreesBestIndex,   /* xBestIndex */
+	viableTreesDisconnect,  /* xDisconnect */
+	viableTreesDisconnect,  /* xDestroy */
+	viableTreesOpen,        /* xOpen */
+	viableTreesClose,       /* xClose */
+	viableTreesFilter,      /* xFilter */
+	viableTreesNext,        /* xNext */
+	viableTreesEof,         /* xEof */
+	viableTreesColumn,      /* xColumn */
+	viableTreesRowid,       /* xRowid */
+	NULL,                   /* xUpdate, the table is read-only */
+	NULL,                   /* xBegin */
+	NULL,                   /* xSync */
+	NULL,                   /* xCommit */
+	NULL,                   /* xRollback */
+	NULL,                   /* xFindFunction */
+	NULL,                   /* xRename */
+	NULL,                   /* xSavepoint, version 2 */
+	NULL,                   /* xRelease, version 2 */
+	NULL                    /* xRollbackTo, version 2 */
+};
+
+bool ViableTreesTable::registerModule(sqlite3 *database) {
+	return sqlite3_create_module(database, ModuleName, &ViableTreesModule, NULL) == SQLITE_OK;
+}
@@ -0,0 +1,85 @@
+#ifndef VIABLE_TREES_TABLE_H
+#define VIABLE_TREES_TABLE_H
+
+/**
+ * @file ViableTreesTable.h
+ * Interface description of the sqlite3 virtual table module ViableTreesTable
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <sqlite3/sqlite3.h>
+
+namespace SubcloneSeeker {
+
+	/**
+	 * @brief An sqlite3 virtual table streaming the viable trees of a cluster database
+	 *
+	 * Once the module is registered on a connection, a table is declared over a
+	 * cluster database (as written by segtxt2db or cluster2db) with
+	 *
+	 *   CREATE VIRTUAL TABLE temp.trees USING viable_trees('clusters.sqlite');
+	 *
+	 * Scanning the table runs a TreeEnumerator, and each viable tree becomes rows
+	 * as sqlite3 pulls them; nothing but the current tree is held in memory, and
+	 * nothing is written. Every scan enumerates the trees again. The columns are
+	 * . tree_id: the number of the viable tree, from 1, in the order ssmain finds them
+	 * . node: the subclone, 0 for the root and i for the i-th in placement order,
+	 *   so that a node holds the same clusters in every tree
+	 * . parent: the node of the parent, NULL for the root
+	 * . depth: the distance of the node from the root
+	 * . fraction, tree_fraction: the fractions of the node, see Subclone
+	 * . cluster_id: the id of a cluster of the node in the cluster database. A node
+	 *   holding several clusters of the same fraction gets one row per cluster,
+	 *   the root a single row with a NULL cluster_id
+	 * . tree_depth: the depth of the whole tree, see TreeSummary
+	 *
+	 * For example, the parent of the subclone holding cluster 3, over all trees:
+	 *
+	 *   SELECT p.cluster_id, COUNT(*) FROM trees c JOIN trees p ON p.tree_id = c.tree_id
+	 *   AND p.node = c.parent WHERE c.cluster_id = 3 GROUP BY p.cluster_id;
+	 *
+	 * (in which sqlite3 scans the table once per row of c; materialize one side
+	 * into a temporary table when the trees are many).
+	 */
+	class ViableTreesTable {
+		public:
+			/**
+			 * The name the module is registered under
+			 */
+			static const char *ModuleName;
+
+			/**
+			 * Register the module on a database connection
+			 *
+			 * @param database An open sqlite3 database connection handle
+			 * @return false on sqlite3 errors
+			 */
+			static bool registerModule(sqlite3 *database);
+	};
+}
+
+#endif
@@ -0,0 +1,108 @@
+/**
+ * @file Unit tests for BootstrapStability
+ *
+ * @see BootstrapStability
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "BootstrapStability.h"
+#include "SegmentalMutation.h"
+
+#include "common.h"
+
+/**
+ * Two well separated groups of segments, and a cluster for each
+ */
+struct TwoGroupsFixture {
+	SubcloneSeeker::CNV cnvs[20];
+	SubcloneSeeker::EventCluster low, high;
+	std::vector<SubcloneSeeker::EventCluster *> clusters;
+
+	TwoGroupsFixture() {
+		for(int i=0; i<20; i++) {
+			cnvs[i].frequency = (i < 10 ? 0.2 : 0.7) + 0.001 * i;
+			cnvs[i].range.length = 1000L * (1 + i % 3);
+			(i < 10 ? low : high).addEvent(&cnvs[i]);
+		}
+		clusters.push_back(&low);
+		clusters.push_back(&high);
+	}
+};
+
+SUITE(TestBootstrapStability) {
+	TEST_FIXTURE(TwoGroupsFixture, Resampling) {
+		SubcloneSeeker::BootstrapStability stability(clusters, 0.05);
+		CHECK_EQUAL(2, stability.clusterCount());
+		stability.run(50);
+		CHECK_EQUAL(50, stability.replicates());
+
+		CHECK_CLOSE(1, stability.support(0), 1e-9);
+		CHECK_CLOSE(1, stability.support(1), 1e-9);
+		CHECK_CLOSE(0, stability.coClustering(0, 1), 1e-9);
+		CHECK_CLOSE(0, stability.coClustering(1, 0), 1e-9);
+
+		// the reference events are untouched
+		CHECK_CLOSE(0.2, cnvs[0].frequency, 1e-9);
+	}
+
+	TEST_FIXTURE(TwoGroupsFixture, Perturbation) {
+		SubcloneSeeker::BootstrapStability single(clusters, 0.05);
+		single.setResampling(SubcloneSeeker::BootstrapStability::PERTURB_FREQUENCIES, 0.2);
+		single.setThreads(1);
+		single.run(40);
+
+		// noise far above the threshold splits the groups apart
+		CHECK(single.support(0) < 1);
+		CHECK(single.coClustering(0, 1) > 0);
+
+		SubcloneSeeker::BootstrapStability many(clusters, 0.05);
+		many.setResampling(SubcloneSeeker::BootstrapStability::PERTURB_FREQUENCIES, 0.2);
+		many.setThreads(3);
+		many.run(40);
+
+		for(size_t a=0; a<2; a++)
+			for(size_t b=0; b<2; b++)
+				CHECK_EQUAL(single.coClustering(a, b), many.coClustering(a, b));
+	}
+
+	TEST_FIXTURE(TwoGroupsFixture, ClusterCount) {
+		// a threshold this wide merges the groups
+		SubcloneSeeker::BootstrapStability atThreshold(clusters, 1, SubcloneSeeker::EventCluster::CLUSTERING_HIERARCHICAL);
+		atThreshold.run(20);
+		CHECK_CLOSE(1, atThreshold.coClustering(0, 1), 1e-9);
+
+		// while cutting into two clusters keeps them apart
+		SubcloneSeeker::BootstrapStability toCount(clusters, 1, SubcloneSeeker::EventCluster::CLUSTERING_HIERARCHICAL);
+		toCount.setClusterCount(2);
+		toCount.run(20);
+		CHECK_CLOSE(1, toCount.support(0), 1e-9);
+		CHECK_CLOSE(1, toCount.support(1), 1e-9);
+		CHECK_CLOSE(0, toCount.coClustering(0, 1), 1e-9);
+	}
+}
+
+TEST_MAIN
@@ -0,0 +1,92 @@
+/**
+ * @file Unit tests for LazyTreeLoader
+ *
+ * @see LazyTreeLoader
+ * @author Yi Qiao
+ */
+
+#include <sqlite3/sqlite3.h>
+
+#include "CohortDB.h"
+#include "EventCluster.h"
+#include "Subclone.h"
+
+#include "common.h"
+
+/**
+ * Run a query returning a single integer
+ */
+static sqlite3_int64 queryInteger(sqlite3 *database, const char *query) {
+	sqlite3_stmt *statement;
+	sqlite3_int64 value = -1;
+	if(sqlite3_prepare_v2(database, query, -1, &statement, 0) == SQLITE_OK) {
+		if(sqlite3_step(statement) == SQLITE_ROW)
+			value = sqlite3_column_int64(statement, 0);
+		sqlite3_finalize(statement);
+	}
+	return value;
+}
+
+SUITE(TestCohortDB) {
+	TEST_FIXTURE(DBFixture, SampleScopes) {
+		CHECK(!SubcloneSeeker::CohortDB::isCohort(database));
+		CHECK(SubcloneSeeker::CohortDB::currentSample(database) == 0);
+
+		// two samples written through the same connection, one after the other
+		CHECK(SubcloneSeeker::CohortDB::enterSample(database, "a"));
+		CHECK(SubcloneSeeker::CohortDB::isCohort(database));
+		CHECK(SubcloneSeeker::CohortDB::currentSample(database) == 1);
+
+		SubcloneSeeker::EventCluster cluster;
+		cluster.setCellFraction(0.5);
+		CHECK(cluster.archiveObjectToDB(database) == 1);
+
+		CHECK(SubcloneSeeker::CohortDB::enterSample(database, "b"));
+		CHECK(SubcloneSeeker::CohortDB::currentSample(database) == 2);
+		SubcloneSeeker::EventCluster others[2];
+		for(int i=0; i<2; i++) {
+			others[i].setCellFraction(0.25);
+			CHECK(others[i].archiveObjectToDB(database) == i+2);
+		}
+		CHECK(SubcloneSeeker::Subclone::linkClusterInDB(database, 10, 2));
+
+		// archiving again updates the record
+		others[1].setCellFraction(0.125);
+		CHECK(others[1].archiveObjectToDB(database) == 3);
+		CHECK(queryInteger(database, "SELECT COUNT(*) FROM main.Clusters WHERE fraction=0.125 AND sampleID=2;") == 1);
+
+		SubcloneSeeker::EventCluster dummyCluster;
+		CHECK(dummyCluster.vecAllObjectsID(database).size() == 2);
+		CHECK(queryInteger(database, "SELECT COUNT(*) FROM SubcloneClusters;") == 1);
+
+		CHECK(SubcloneSeeker::CohortDB::enterSample(database, "a"));
+		CHECK(dummyCluster.vecAllObjectsID(database).size() == 1);
+		CHECK(dummyCluster.unarchiveObjectFromDB(database, 1));
+		CHECK_CLOSE(dummyCluster.cellFraction(), 0.5, 1e-6);
+		CHECK(!dummyCluster.unarchiveObjectFromDB(database, 2));
+		CHECK(queryInteger(database, "SELECT COUNT(*) FROM SubcloneClusters;") == 0);
+
+		// the whole cohort, once out of the samples
+		CHECK(SubcloneSeeker::CohortDB::leaveSample(database));
+		CHECK(SubcloneSeeker::CohortDB::currentSample(database) == 0);
+		CHECK(queryInteger(database, "SELECT COUNT(*) FROM Clusters;") == 3);
+		CHECK(queryInteger(database, "SELECT COUNT(*) FROM Clusters WHERE sampleID=2;") == 2);
+
+		std::vector<std::string> samples = SubcloneSeeker::CohortDB::samples(database);
+		CHECK(samples.size() == 2);
+		CHECK(samples[1] == "b");
+	}
+
+	TEST_FIXTURE(DBFixture, NotACohort) {
+		SubcloneSeeker::EventCluster cluster;
+		cluster.setCellFraction(0.5);
+		CHECK(cluster.archiveObjectToDB(database) == 1);
+
+		// a database already holding a single sample is left alone
+		CHECK(!SubcloneSeeker::CohortDB::enterSample(database, "a"));
+		CHECK(!SubcloneSeeker::CohortDB::isCohort(database));
+		CHECK(SubcloneSeeker::CohortDB::currentSample(database) == 0);
+	}
+}
+
+TEST_MAIN
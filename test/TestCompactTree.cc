@@ -0,0 +1,166 @@
+/**
+ * @file Unit tests for CompactTree
+ *
+ * @see CompactTree
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <iostream>
+#include <sqlite3/sqlite3.h>
+#include <cstdio>
+
+#include "CompactTree.h"
+#include "Subclone.h"
+#include "EventCluster.h"
+#include "SegmentalMutation.h"
+#include "ObjectArena.h"
+
+#include "common.h"
+
+SUITE(TestCompactTree) {
+	TEST_FIXTURE(DBFixture, CompactTreeToDB) {
+		SubcloneSeeker::Subclone root, child1, child2, child11;
+		SubcloneSeeker::EventCluster clusterA, clusterB, clusterC;
+		SubcloneSeeker::CNV cnvA, cnvB, cnvC;
+
+		cnvA.frequency = 0.7; cnvA.range.chrom = 1; cnvA.range.length = 1000L;
+		cnvB.frequency = 0.2; cnvB.range.chrom = 2; cnvB.range.length = 1000L;
+		cnvC.frequency = 0.1; cnvC.range.chrom = 3; cnvC.range.length = 1000L;
+		clusterA.addEvent(&cnvA);
+		clusterB.addEvent(&cnvB);
+		clusterC.addEvent(&cnvC);
+
+		// clusters are stored once, the compact tree refers to them by id
+		SubcloneSeeker::EventCluster *clusters[] = {&clusterA, &clusterB, &clusterC};
+		for(int i=0; i<3; i++) {
+			sqlite3_int64 clusterID = clusters[i]->archiveObjectToDB(database);
+			clusters[i]->members()[0]->setClusterID(clusterID);
+			clusters[i]->members()[0]->archiveObjectToDB(database);
+		}
+
+		root.setFraction(0.3); root.setTreeFraction(1);
+		child1.setFraction(0.5); child1.setTreeFraction(0.7); child1.addEventCluster(&clusterA);
+		child11.setFraction(0.2); child11.setTreeFraction(0.2); child11.addEventCluster(&clusterB);
+		child2.setFraction(0.1); child2.setTreeFraction(0.1); child2.addEventCluster(&clusterC);
+
+		root.addChild(&child1);
+		root.addChild(&child2);
+		child1.addChild(&child11);
+
+		SubcloneSeeker::CompactTree compactTree;
+		compactTree.encodeTree(&root);
+
+		CHECK(compactTree.nodeCount() == 4);
+		CHECK(compactTree.parents()[0] == -1);
+		CHECK(compactTree.parents()[1] == 0);
+		CHECK(compactTree.parents()[2] == 1);
+		CHECK(compactTree.parents()[3] == 0);
+
+		// write
+		sqlite3_int64 id = compactTree.archiveObjectToDB(database);
+		CHECK(id > 0);
+
+		// read
+		SubcloneSeeker::CompactTree loadedTree;
+		CHECK(loadedTree.unarchiveObjectFromDB(database, id));
+		CHECK(loadedTree.nodeCount() == 4);
+		CHECK(loadedTree.clusterIDs().size() == 3);
+
+		SubcloneSeeker::Subclone *newRoot = loadedTree.expandTree(database);
+
+		CHECK(newRoot != NULL);
+		CHECK(newRoot->isRoot());
+		CHECK_CLOSE(newRoot->fraction(), 0.3, 1e-3);
+		CHECK_CLOSE(newRoot->treeFraction(), 1, 1e-3);
+		CHECK(newRoot->vecEventCluster().size() == 0);
+		CHECK(newRoot->getVecChildren().size() == 2);
+
+		SubcloneSeeker::Subclone *newChild1 = dynamic_cast<SubcloneSeeker::Subclone *>(newRoot->getVecChildren()[0]);
+		SubcloneSeeker::Subclone *newChild2 = dynamic_cast<SubcloneSeeker::Subclone *>(newRoot->getVecChildren()[1]);
+
+		CHECK_CLOSE(newChild1->fraction(), 0.5, 1e-3);
+		CHECK_CLOSE(newChild1->treeFraction(), 0.7, 1e-3);
+		CHECK(newChild1->vecEventCluster().size() == 1);
+		CHECK(newChild1->vecEventCluster()[0]->getId() == clusterA.getId());
+		CHECK(newChild1->vecEventCluster()[0]->members().size() == 1);
+		CHECK(newChild1->getVecChildren().size() == 1);
+
+		CHECK_CLOSE(newChild2->fraction(), 0.1, 1e-3);
+		CHECK(newChild2->isLeaf());
+		CHECK(newChild2->vecEventCluster()[0]->getId() == clusterC.getId());
+
+		SubcloneSeeker::Subclone *newChild11 = dynamic_cast<SubcloneSeeker::Subclone *>(newChild1->getVecChildren()[0]);
+		CHECK_CLOSE(newChild11->fraction(), 0.2, 1e-3);
+		CHECK(newChild11->isLeaf());
+		CHECK(newChild11->vecEventCluster()[0]->getId() == clusterB.getId());
+	}
+	TEST_FIXTURE(DBFixture, CompactTreeThroughTreeLoader) {
+		SubcloneSeeker::Subclone root, child;
+		SubcloneSeeker::EventCluster cluster;
+		SubcloneSeeker::CNV cnv;
+
+		cnv.frequency = 0.6; cnv.range.chrom = 1; cnv.range.length = 1000L;
+		cluster.addEvent(&cnv);
+		sqlite3_int64 clusterID = cluster.archiveObjectToDB(database);
+		cnv.setClusterID(clusterID);
+		cnv.archiveObjectToDB(database);
+
+		root.setFraction(0.4); root.setTreeFraction(1);
+		child.setFraction(0.6); child.setTreeFraction(0.6); child.addEventCluster(&cluster);
+		root.addChild(&child);
+
+		SubcloneSeeker::CompactTree compactTree;
+		compactTree.encodeTree(&root);
+		sqlite3_int64 id = compactTree.archiveObjectToDB(database);
+
+		// a database holding only compact trees is read by the generic loaders
+		CHECK(SubcloneSeeker::SubcloneLoadTreeTraverser::isCompactDB(database));
+		SubcloneSeeker::DBObjectID_vec rootIDs = SubcloneSeeker::SubcloneLoadTreeTraverser::rootNodes(database);
+		CHECK(rootIDs.size() == 1);
+		CHECK(rootIDs[0] == id);
+
+		SubcloneSeeker::Subclone *loaded = SubcloneSeeker::SubcloneLoadTreeTraverser::loadTree(database, id);
+		CHECK(loaded != NULL);
+		CHECK(loaded->getId() == id);
+		CHECK(loaded->getVecChildren().size() == 1);
+		SubcloneSeeker::Subclone *loadedChild = dynamic_cast<SubcloneSeeker::Subclone *>(loaded->getVecChildren()[0]);
+		CHECK_CLOSE(loadedChild->fraction(), 0.6, 1e-3);
+		CHECK(loadedChild->vecEventCluster().size() == 1);
+		CHECK(loadedChild->vecEventCluster()[0]->getId() == clusterID);
+
+		SubcloneSeeker::SubcloneFreeTreeTraverser freeTraverser;
+		SubcloneSeeker::TreeNode::PostOrderTraverse(loaded, freeTraverser);
+
+		SubcloneSeeker::ObjectArena arena;
+		SubcloneSeeker::Subclone *arenaLoaded = SubcloneSeeker::SubcloneLoadTreeTraverser::loadTree(database, id, &arena);
+		CHECK(arenaLoaded != NULL);
+		CHECK(arenaLoaded->getVecChildren().size() == 1);
+
+		CHECK(SubcloneSeeker::SubcloneLoadTreeTraverser::loadTree(database, id + 1) == NULL);
+	}
+}
+
+TEST_MAIN
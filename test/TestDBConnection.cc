@@ -0,0 +1,100 @@
+/**
+ * @file Unit tests for DBConnection
+ *
+ * @see DBConnection
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include <iostream>
+#include <sqlite3/sqlite3.h>
+#include <cstdio>
+#include <cstring>
+
+#include "DBConnection.h"
+
+#include "common.h"
+
+/**
+ * Run a single value query
+ */
+static std::string queryValue(sqlite3 *database, const char *query) {
+	std::string value;
+	sqlite3_stmt *stmt;
+	if(sqlite3_prepare_v2(database, query, -1, &stmt, NULL) == SQLITE_OK) {
+		if(sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_text(stmt, 0) != NULL)
+			value = (const char *)sqlite3_column_text(stmt, 0);
+		sqlite3_finalize(stmt);
+	}
+	return value;
+}
+
+SUITE(TestDBConnection) {
+	TEST(ProfileNames) {
+		SubcloneSeeker::DBConnection::Profile profile;
+		CHECK(SubcloneSeeker::DBConnection::profileFromName("bulk-write", profile));
+		CHECK(profile == SubcloneSeeker::DBConnection::PROFILE_BULK_WRITE);
+		CHECK(SubcloneSeeker::DBConnection::profileFromName("read-analysis", profile));
+		CHECK(profile == SubcloneSeeker::DBConnection::PROFILE_READ_ANALYSIS);
+		CHECK(SubcloneSeeker::DBConnection::profileFromName("default", profile));
+		CHECK(profile == SubcloneSeeker::DBConnection::PROFILE_DEFAULT);
+		CHECK(!SubcloneSeeker::DBConnection::profileFromName("fast", profile));
+	}
+
+	TEST(Profiles) {
+		sqlite3 *database;
+
+		// write
+		CHECK(SubcloneSeeker::DBConnection::open("test_profile.sqlite", &database,
+					SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, SubcloneSeeker::DBConnection::PROFILE_BULK_WRITE) == SQLITE_OK);
+		CHECK(queryValue(database, "PRAGMA journal_mode;") == "off");
+		CHECK(queryValue(database, "PRAGMA synchronous;") == "0");
+		CHECK(queryValue(database, "PRAGMA locking_mode;") == "exclusive");
+		CHECK(sqlite3_exec(database, "CREATE TABLE T (v INTEGER); INSERT INTO T VALUES (42);", 0, 0, 0) == SQLITE_OK);
+		sqlite3_close(database);
+
+		// read through an in-memory copy
+		CHECK(SubcloneSeeker::DBConnection::open("test_profile.sqlite", &database,
+					SQLITE_OPEN_READONLY, SubcloneSeeker::DBConnection::PROFILE_READ_ANALYSIS) == SQLITE_OK);
+		CHECK(queryValue(database, "SELECT v FROM T;") == "42");
+		CHECK(strlen(sqlite3_db_filename(database, "main")) == 0);
+		sqlite3_close(database);
+
+		// read-analysis does not apply to writable connections
+		CHECK(SubcloneSeeker::DBConnection::open("test_profile.sqlite", &database,
+					SQLITE_OPEN_READWRITE, SubcloneSeeker::DBConnection::PROFILE_READ_ANALYSIS) == SQLITE_OK);
+		CHECK(sqlite3_exec(database, "INSERT INTO T VALUES (43);", 0, 0, 0) == SQLITE_OK);
+		CHECK(queryValue(database, "SELECT count(*) FROM T;") == "2");
+		sqlite3_close(database);
+
+		CHECK(SubcloneSeeker::DBConnection::open("missing.sqlite", &database,
+					SQLITE_OPEN_READONLY, SubcloneSeeker::DBConnection::PROFILE_READ_ANALYSIS) != SQLITE_OK);
+
+		remove("test_profile.sqlite");
+	}
+}
+
+TEST_MAIN
@@ -0,0 +1,152 @@
+/**
+ * @file Unit tests for Dendrogram
+ *
+ * @see Dendrogram
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "Dendrogram.h"
+#include "EventCluster.h"
+#include "SegmentalMutation.h"
+
+#include "common.h"
+
+SUITE(TestDendrogram) {
+	TEST(Cuts) {
+		double freqs[6] = {0.35, 0.8, 0.1, 0.31, 0.12, 0.3};
+		SubcloneSeeker::CNV cnvs[6];
+		std::vector<SubcloneSeeker::SomaticEvent *> events;
+		for(int i=0; i<6; i++) {
+			cnvs[i].frequency = freqs[i];
+			cnvs[i].range.length = 1000L;
+			events.push_back(&cnvs[i]);
+		}
+
+		SubcloneSeeker::Dendrogram dendrogram;
+		dendrogram.build(events);
+		CHECK_EQUAL(6, dendrogram.leafCount());
+		CHECK_EQUAL(6, dendrogram.clusterCount(0));
+		CHECK_EQUAL(3, dendrogram.clusterCount(0.05));
+		CHECK_EQUAL(1, dendrogram.clusterCount(1));
+
+		std::vector<SubcloneSeeker::EventCluster *> clusters = dendrogram.cut(0.05);
+		CHECK_EQUAL(3, clusters.size());
+		if(clusters.size() == 3) {
+			CHECK_EQUAL(2, clusters[0]->memberCount());
+			CHECK_CLOSE(0.11, clusters[0]->cellFraction(), 1e-9);
+			CHECK_EQUAL(3, clusters[1]->memberCount());
+			CHECK_CLOSE(0.32, clusters[1]->cellFraction(), 1e-9);
+			CHECK(clusters[2]->members()[0] == &cnvs[1]);
+		}
+		for(size_t i=0; i<clusters.size(); i++)
+			delete clusters[i];
+
+		clusters = dendrogram.cutToCount(2);
+		CHECK_EQUAL(2, clusters.size());
+		if(clusters.size() == 2) {
+			CHECK_EQUAL(5, clusters[0]->memberCount());
+			CHECK_EQUAL(1, clusters[1]->memberCount());
+		}
+		for(size_t i=0; i<clusters.size(); i++)
+			delete clusters[i];
+
+		std::vector<double> thresholds;
+		std::vector<size_t> counts;
+		dendrogram.sweep(thresholds, counts);
+		double expectedThresholds[5] = {0.01, 0.02, 0.045, 0.21, 0.564};
+		CHECK_EQUAL(5, thresholds.size());
+		CHECK_EQUAL(5, counts.size());
+		for(size_t i=0; i<thresholds.size() && i<5; i++) {
+			CHECK_CLOSE(expectedThresholds[i], thresholds[i], 1e-9);
+			CHECK_EQUAL(5 - i, counts[i]);
+		}
+	}
+
+	TEST_FIXTURE(DBFixture, DendrogramToDB) {
+		SubcloneSeeker::CNV cnvs[4];
+		std::vector<SubcloneSeeker::SomaticEvent *> events;
+		for(int i=0; i<4; i++) {
+			cnvs[i].frequency = 0.1 * i * i;
+			cnvs[i].range.length = 100L * (i+1);
+			events.push_back(&cnvs[i]);
+		}
+
+		SubcloneSeeker::Dendrogram dendrogram;
+		dendrogram.build(events);
+
+		// the leaves are archived first, and referred to by id
+		for(int i=0; i<4; i++)
+			CHECK(cnvs[i].archiveObjectToDB(database) > 0);
+		sqlite3_int64 id = dendrogram.archiveObjectToDB(database);
+		CHECK(id > 0);
+
+		SubcloneSeeker::Dendrogram loaded;
+		CHECK(loaded.unarchiveObjectFromDB(database, id));
+		CHECK_EQUAL(4, loaded.leafCount());
+		CHECK_EQUAL(4, loaded.leafIDs().size());
+		CHECK_EQUAL(dendrogram.clusterCount(0.15), loaded.clusterCount(0.15));
+		CHECK_EQUAL(dendrogram.clusterCount(0.35), loaded.clusterCount(0.35));
+
+		// no events until they are attached
+		CHECK(loaded.cut(0.15).empty());
+
+		std::vector<SubcloneSeeker::SomaticEvent *> partial(events.begin(), events.begin() + 3);
+		CHECK(!loaded.attachLeaves(partial));
+		CHECK(loaded.cut(0.15).empty());
+
+		// the stored events, with frequencies changed after clustering
+		SubcloneSeeker::CNV stored[4];
+		std::vector<SubcloneSeeker::SomaticEvent *> storedEvents;
+		for(int i=3; i>=0; i--) {
+			CHECK(stored[i].unarchiveObjectFromDB(database, cnvs[i].getId()));
+			stored[i].frequency = 1;
+			storedEvents.push_back(&stored[i]);
+		}
+		CHECK(loaded.attachLeaves(storedEvents));
+
+		std::vector<SubcloneSeeker::EventCluster *> expected = dendrogram.cut(0.15);
+		std::vector<SubcloneSeeker::EventCluster *> clusters = loaded.cut(0.15);
+		CHECK_EQUAL(expected.size(), clusters.size());
+		for(size_t i=0; i<clusters.size() && i<expected.size(); i++) {
+			CHECK_EQUAL(expected[i]->memberCount(), clusters[i]->memberCount());
+			CHECK_CLOSE(expected[i]->cellFraction(), clusters[i]->cellFraction(), 1e-9);
+			for(size_t j=0; j<clusters[i]->members().size(); j++)
+				CHECK(clusters[i]->members()[j]->getId() == expected[i]->members()[j]->getId());
+		}
+		for(size_t i=0; i<clusters.size(); i++)
+			delete clusters[i];
+		for(size_t i=0; i<expected.size(); i++)
+			delete expected[i];
+
+		clusters = loaded.cutToCount(2);
+		CHECK_EQUAL(2, clusters.size());
+		for(size_t i=0; i<clusters.size(); i++)
+			delete clusters[i];
+	}
+}
+
+TEST_MAIN
@@ -88,6 +88,86 @@ SUITE(testEventCluster)
 		CHECK(cluster2 > cluster1);
 	}
 
+	TEST(RemoveAndMerge) {
+		SubcloneSeeker::EventCluster cluster, other;
+		SubcloneSeeker::CNV cnv1, cnv2, cnv3;
+
+		cnv1.frequency = 0.2;
+		cnv1.range.length = 1000L;
+		cnv2.frequency = 0.3;
+		cnv2.range.length = 3000L;
+		cnv3.frequency = 0.4;
+		cnv3.range.length = 1000L;
+
+		cluster.addEvent(&cnv1);
+		cluster.addEvent(&cnv2);
+		cluster.addEvent(&cnv2);
+		CHECK_EQUAL(2, cluster.members().size());
+		CHECK_CLOSE(0.275, cluster.cellFraction(), 1e-6);
+
+		CHECK(cluster.removeEvent(&cnv1));
+		CHECK(!cluster.removeEvent(&cnv1));
+		CHECK_EQUAL(1, cluster.members().size());
+		CHECK(cluster.members()[0] == &cnv2);
+		CHECK_CLOSE(0.3, cluster.cellFraction(), 1e-6);
+
+		other.addEvent(&cnv2);
+		other.addEvent(&cnv3);
+		cluster.merge(other);
+		CHECK_EQUAL(2, cluster.members().size());
+		CHECK_EQUAL(2, other.members().size());
+		CHECK_CLOSE(0.325, cluster.cellFraction(), 1e-6);
+
+		CHECK(cluster.removeEvent(&cnv2));
+		CHECK(cluster.removeEvent(&cnv3));
+		CHECK_EQUAL(0, cluster.members().size());
+		CHECK_CLOSE(0, cluster.cellFraction(), 1e-6);
+	}
+
+	TEST(SweepClustering) {
+		SubcloneSeeker::CNV cnvs[5];
+		double freqs[5] = {0.52, 0.2, 0.5, 0.23, 0.8};
+		unsigned long lengths[5] = {1000L, 3000L, 3000L, 1000L, 1000L};
+		for(int i=0; i<5; i++) {
+			cnvs[i].frequency = freqs[i];
+			cnvs[i].range.chrom = 1;
+			cnvs[i].range.position = 1000000L * (i+1);
+			cnvs[i].range.length = lengths[i];
+		}
+
+		std::vector<SubcloneSeeker::SomaticEvent *> events;
+		for(int i=0; i<5; i++)
+			events.push_back(&cnvs[i]);
+
+		std::vector<SubcloneSeeker::EventCluster *> clusters = SubcloneSeeker::EventCluster::sweepClustering(events, 0.05);
+
+		// by increasing, length-weighted fraction
+		CHECK_EQUAL(3, clusters.size());
+		CHECK_EQUAL(2, clusters[0]->members().size());
+		CHECK_CLOSE(0.2075, clusters[0]->cellFraction(), 1e-6);
+		CHECK_EQUAL(2, clusters[1]->members().size());
+		CHECK_CLOSE(0.505, clusters[1]->cellFraction(), 1e-6);
+		CHECK_EQUAL(1, clusters[2]->members().size());
+		CHECK_CLOSE(0.8, clusters[2]->cellFraction(), 1e-6);
+
+		// the input order does not matter
+		std::vector<SubcloneSeeker::SomaticEvent *> reversed(events.rbegin(), events.rend());
+		std::vector<SubcloneSeeker::EventCluster *> again = SubcloneSeeker::EventCluster::clustering(reversed, 0.05,
+				SubcloneSeeker::EventCluster::CLUSTERING_SWEEP);
+		CHECK_EQUAL(clusters.size(), again.size());
+		for(size_t i=0; i<clusters.size() && i<again.size(); i++) {
+			CHECK(clusters[i]->members() == again[i]->members());
+			CHECK_CLOSE(clusters[i]->cellFraction(), again[i]->cellFraction(), 1e-9);
+		}
+
+		CHECK(SubcloneSeeker::EventCluster::sweepClustering(events, 2).size() == 0);
+
+		for(size_t i=0; i<clusters.size(); i++)
+			delete clusters[i];
+		for(size_t i=0; i<again.size(); i++)
+			delete again[i];
+	}
+
 	TEST(EventClusterToDB) {
 		SubcloneSeeker::EventCluster cluster;
 		SubcloneSeeker::CNV cnv;
@@ -129,6 +209,43 @@ SUITE(testEventCluster)
 
 
 	}
+
+	TEST(EventClusterCursor) {
+		sqlite3 *database;
+		sqlite3_open(":memory:", &database);
+
+		for(int i=1; i<=3; i++) {
+			SubcloneSeeker::EventCluster cluster;
+			cluster.setSubcloneID(i == 2 ? 0 : 7);
+			SubcloneSeeker::CNV *cnv = new SubcloneSeeker::CNV();
+			cnv->range.length = 100;
+			cnv->frequency = 0.1 * i;
+			cluster.addEvent(cnv);
+			cluster.archiveObjectToDB(database);
+			delete cluster.members()[0];
+		}
+
+		// stream the clusters of subclone 7, in id order
+		SubcloneSeeker::ArchiveCursor<SubcloneSeeker::EventCluster> cursor(database, "ofSubcloneID=7");
+		SubcloneSeeker::EventCluster *first = cursor.next();
+		CHECK(first != NULL);
+		CHECK(first->getId() == 1);
+		CHECK_CLOSE(first->cellFraction(), 0.1, 1e-6);
+
+		SubcloneSeeker::EventCluster second;
+		CHECK(cursor.next(second));
+		CHECK(second.getId() == 3);
+		CHECK(second.subcloneID() == 7);
+		CHECK(cursor.next() == NULL);
+		CHECK(!cursor.failed());
+		delete first;
+
+		SubcloneSeeker::ArchiveCursor<SubcloneSeeker::EventCluster> badCursor(database, "noSuchColumn=1");
+		CHECK(badCursor.next() == NULL);
+		CHECK(badCursor.failed());
+
+		sqlite3_close(database);
+	}
 }
 
 TEST_MAIN
@@ -0,0 +1,181 @@
+/**
+ * @file Unit tests for EventInterner
+ *
+ * @see EventInterner
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "EventInterner.h"
+#include "SegmentalMutation.h"
+#include <algorithm>
+
+#include "common.h"
+
+/**
+ * A CNV that is deleted by the test
+ */
+static SubcloneSeeker::CNV *makeCNV(int chrom, unsigned long position, unsigned long length) {
+	SubcloneSeeker::CNV *cnv = new SubcloneSeeker::CNV();
+	cnv->range.chrom = chrom;
+	cnv->range.position = position;
+	cnv->range.length = length;
+	return cnv;
+}
+
+SUITE(TestEventInterner) {
+	TEST(SetOperations) {
+		SubcloneSeeker::EventSet a, b;
+		CHECK(a.empty());
+
+		a.insert(1);
+		a.insert(70);
+		a.insert(130);
+		b.insert(70);
+		b.insert(2);
+
+		CHECK_EQUAL(3, a.count());
+		CHECK(a.contains(130));
+		CHECK(!a.contains(2));
+		CHECK(!b.contains(130));
+		CHECK(a.intersects(b));
+		CHECK(!a.isSubsetOf(b));
+
+		// sets of different widths combine as if the missing words were 0
+		SubcloneSeeker::EventSet c = a;
+		c &= b;
+		CHECK_EQUAL(1, c.count());
+		CHECK(c.contains(70));
+		CHECK(c.isSubsetOf(a));
+		CHECK(c.isSubsetOf(b));
+
+		c = b;
+		c |= a;
+		CHECK_EQUAL(4, c.count());
+		CHECK(a.isSubsetOf(c));
+
+		c.subtract(a);
+		CHECK_EQUAL(1, c.count());
+		CHECK(c.contains(2));
+		c.subtract(b);
+		CHECK(c.empty());
+	}
+
+	TEST(Interning) {
+		SubcloneSeeker::CNV *cnv = makeCNV(1, 1000, 5000);
+		SubcloneSeeker::LOH loh;
+		loh.range.chrom = 1;
+		loh.range.position = 1000;
+		loh.range.length = 5000;
+
+		SubcloneSeeker::EventInterner interner(100);
+		CHECK_EQUAL(0, interner.intern(cnv));
+		CHECK_EQUAL(1, interner.intern(&loh));
+		CHECK_EQUAL(0, interner.intern(cnv));
+		CHECK_EQUAL(2, interner.size());
+		CHECK(interner.event(1) == &loh);
+
+		// a CNV is equal to itself, an LOH never is
+		std::vector<SubcloneSeeker::SomaticEvent *> events;
+		events.push_back(cnv);
+		CHECK(interner.equivalentsOf(interner.setOf(events)).contains(0));
+		events[0] = &loh;
+		CHECK(interner.equivalentsOf(interner.setOf(events)).empty());
+		CHECK(!interner.contains(events, events));
+
+		delete cnv;
+	}
+
+	TEST(MatchesPairwiseComparison) {
+		// b is within the resolution of both a and c, but a and c are not
+		SubcloneSeeker::CNV *a = makeCNV(1, 1000, 5000);
+		SubcloneSeeker::CNV *b = makeCNV(1, 1060, 5000);
+		SubcloneSeeker::CNV *c = makeCNV(1, 1120, 5000);
+		SubcloneSeeker::CNV *other = makeCNV(2, 1000, 5000);
+
+		// enough distinct events to take several words per set
+		std::vector<SubcloneSeeker::SomaticEvent *> master, unwanted;
+		for(int i=0; i<150; i++) {
+			SubcloneSeeker::CNV *filler = makeCNV(3, i * 1000, 500);
+			if(i % 2 == 0)
+				master.push_back(filler);
+			else
+				unwanted.push_back(filler);
+		}
+		master.push_back(a);
+		master.push_back(c);
+		master.push_back(other);
+		unwanted.push_back(b);
+
+		SubcloneSeeker::EventInterner interner(100);
+		std::vector<SubcloneSeeker::SomaticEvent *> diff = interner.difference(master, unwanted);
+
+		std::vector<SubcloneSeeker::SomaticEvent *> expected;
+		for(size_t i=0; i<master.size(); i++) {
+			bool found = false;
+			for(size_t j=0; j<unwanted.size(); j++)
+				if(master[i]->isEqualTo(unwanted[j], 100))
+					found = true;
+			if(!found)
+				expected.push_back(master[i]);
+		}
+		CHECK(diff == expected);
+		CHECK(std::find(diff.begin(), diff.end(), a) == diff.end());
+		CHECK(std::find(diff.begin(), diff.end(), c) == diff.end());
+		CHECK(std::find(diff.begin(), diff.end(), other) != diff.end());
+
+		std::vector<SubcloneSeeker::SomaticEvent *> ac, bOnly, ab;
+		ac.push_back(a);
+		ac.push_back(c);
+		bOnly.push_back(b);
+		ab.push_back(a);
+		ab.push_back(b);
+		CHECK(interner.contains(bOnly, ac));
+		CHECK(interner.contains(ac, bOnly));
+		CHECK(interner.contains(ab, ac));
+
+		// a and c are no closer to each other for sharing a neighbour
+		std::vector<SubcloneSeeker::SomaticEvent *> aOnly, cOnly;
+		aOnly.push_back(a);
+		cOnly.push_back(c);
+		CHECK(!interner.contains(aOnly, cOnly));
+		CHECK_EQUAL(1, interner.difference(cOnly, aOnly).size());
+
+		// ids interned after the equivalents of a set are still matched against it
+		SubcloneSeeker::CNV *late = makeCNV(1, 1010, 5000);
+		std::vector<SubcloneSeeker::SomaticEvent *> lateOnly;
+		lateOnly.push_back(late);
+		CHECK(interner.contains(aOnly, lateOnly));
+		CHECK(interner.difference(lateOnly, aOnly).empty());
+
+		for(size_t i=0; i<master.size(); i++)
+			delete master[i];
+		for(size_t i=0; i<unwanted.size(); i++)
+			delete unwanted[i];
+		delete late;
+	}
+}
+
+TEST_MAIN
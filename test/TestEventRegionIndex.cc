@@ -0,0 +1,137 @@
+/**
+ * @file Unit tests for EventRegionIndex
+ *
+ * @see EventRegionIndex
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <sqlite3/sqlite3.h>
+
+#include "EventRegionIndex.h"
+#include "EventCluster.h"
+#include "SegmentalMutation.h"
+#include "SNP.h"
+
+#include "common.h"
+
+/**
+ * Archive a cluster of CNVs, given as (chrom, position, length) triplets, into a subclone
+ */
+static SubcloneSeeker::EventCluster *archiveCNVCluster(sqlite3 *database, sqlite3_int64 subcloneID,
+		const unsigned long (*ranges)[3], size_t numRanges) {
+	SubcloneSeeker::EventCluster *cluster = new SubcloneSeeker::EventCluster();
+	for(size_t i=0; i<numRanges; i++) {
+		SubcloneSeeker::CNV *cnv = new SubcloneSeeker::CNV();
+		cnv->range.chrom = ranges[i][0];
+		cnv->range.position = ranges[i][1];
+		cnv->range.length = ranges[i][2];
+		cnv->frequency = 0.5;
+		cluster->addEvent(cnv);
+	}
+
+	cluster->setSubcloneID(subcloneID);
+	sqlite3_int64 clusterID = cluster->archiveObjectToDB(database);
+	for(size_t i=0; i<cluster->members().size(); i++) {
+		cluster->members()[i]->setClusterID(clusterID);
+		cluster->members()[i]->archiveObjectToDB(database);
+	}
+	return cluster;
+}
+
+SUITE(TestEventRegionIndex) {
+	TEST_FIXTURE(DBFixture, OverlapQuery) {
+		CHECK(SubcloneSeeker::EventRegionIndex::isAvailable());
+
+		const unsigned long ranges[][3] = {
+			{7, 54000000, 1500000},  // overlaps the start of the query
+			{7, 55500000, 100000},   // inside the query
+			{7, 56000000, 10},       // touches the end of the query
+			{7, 57000000, 1000000},  // after the query
+			{8, 55000000, 1000000}   // other chromosome
+		};
+		SubcloneSeeker::EventCluster *cluster = archiveCNVCluster(database, 3, ranges, 5);
+
+		CHECK(!SubcloneSeeker::EventRegionIndex::exists(database));
+		CHECK(SubcloneSeeker::EventRegionIndex::create(database));
+		CHECK(SubcloneSeeker::EventRegionIndex::exists(database));
+
+		SubcloneSeeker::GenomicRange query;
+		query.chrom = 7;
+		query.position = 55000000;
+		query.length = 1000000;
+
+		std::vector<SubcloneSeeker::EventRegionIndex::Hit> hits;
+		CHECK(SubcloneSeeker::EventRegionIndex::overlapping(database, query, hits));
+
+		// the index agrees with GenomicRange::overlaps
+		size_t numOverlapping = 0;
+		for(size_t i=0; i<cluster->members().size(); i++) {
+			SubcloneSeeker::CNV *cnv = dynamic_cast<SubcloneSeeker::CNV *>(cluster->members()[i]);
+			if(cnv->range.overlaps(query)) {
+				CHECK(numOverlapping < hits.size());
+				if(numOverlapping < hits.size()) {
+					CHECK(hits[numOverlapping].eventTable == "Events_CNV");
+					CHECK(hits[numOverlapping].eventID == cnv->getId());
+					CHECK(hits[numOverlapping].clusterID == cluster->getId());
+					CHECK(hits[numOverlapping].subcloneID == 3);
+				}
+				numOverlapping++;
+			}
+		}
+		CHECK(numOverlapping == 3);
+		CHECK(hits.size() == 3);
+
+		// events archived after the index is created are indexed by the triggers
+		SubcloneSeeker::SNP snp;
+		snp.location.chrom = 7;
+		snp.location.position = 55750000;
+		snp.frequency = 0.2;
+		snp.setClusterID(cluster->getId());
+		snp.archiveObjectToDB(database);
+		CHECK(SubcloneSeeker::EventRegionIndex::create(database));
+
+		SubcloneSeeker::CNV late;
+		late.range.chrom = 7;
+		late.range.position = 55900000;
+		late.range.length = 10;
+		late.frequency = 0.2;
+		late.archiveObjectToDB(database);
+
+		hits.clear();
+		CHECK(SubcloneSeeker::EventRegionIndex::overlapping(database, query, hits));
+		CHECK(hits.size() == 5);
+		CHECK(hits[3].eventID == late.getId());
+		CHECK(hits[3].clusterID == 0);
+		CHECK(hits[4].eventTable == "Events_SNP");
+		CHECK(hits[4].eventID == snp.getId());
+
+		for(size_t i=0; i<cluster->members().size(); i++)
+			delete cluster->members()[i];
+		delete cluster;
+	}
+}
+
+TEST_MAIN
@@ -0,0 +1,140 @@
+/**
+ * @file Unit tests for EventStore
+ *
+ * @see EventStore
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "EventStore.h"
+#include "SegmentalMutation.h"
+#include "SNP.h"
+
+#include "common.h"
+
+SUITE(TestEventStore) {
+	TEST(Columns) {
+		SubcloneSeeker::CNV cnv;
+		cnv.range.chrom = 2;
+		cnv.range.position = 5000;
+		cnv.range.length = 1000;
+		cnv.frequency = 0.4;
+		cnv.setClusterID(7);
+
+		SubcloneSeeker::SNP snp;
+		snp.location.chrom = 1;
+		snp.location.position = 300;
+		snp.frequency = 0.2;
+
+		SubcloneSeeker::EventStore store;
+		store.append(&cnv);
+		store.append(&snp);
+		store.append(SubcloneSeeker::SomaticEvent::KIND_LOH, 3, 100, 50, 0.9, 8);
+
+		CHECK_EQUAL(3, store.size());
+		CHECK_EQUAL(SubcloneSeeker::SomaticEvent::KIND_CNV, store.kind(0));
+		CHECK_EQUAL(SubcloneSeeker::SomaticEvent::KIND_SNP, store.kind(1));
+		CHECK_EQUAL(1000, store.weight(0));
+		CHECK_EQUAL(1, store.weight(1));
+		CHECK_EQUAL(50, store.weight(2));
+		CHECK_CLOSE(0.2, store.frequencies()[1], 1e-9);
+		CHECK_EQUAL(7, store.clusterIDs()[0]);
+
+		// existing objects are their own handles, the rest is made on demand
+		CHECK(store.event(0) == &cnv);
+		SubcloneSeeker::LOH *loh = dynamic_cast<SubcloneSeeker::LOH *>(store.event(2));
+		CHECK(loh != NULL);
+		if(loh != NULL) {
+			CHECK_EQUAL(3, loh->range.chrom);
+			CHECK_EQUAL(100, loh->range.position);
+			CHECK_EQUAL(50, loh->range.length);
+			CHECK_EQUAL(8, loh->clusterID());
+			CHECK(store.event(2) == loh);
+		}
+
+		// sorting keeps the handles with their rows
+		CHECK(!store.isSorted());
+		store.sortByPosition();
+		CHECK(store.isSorted());
+		CHECK(store.event(0) == &snp);
+		CHECK(store.event(1) == &cnv);
+		CHECK(store.event(2) == loh);
+	}
+
+	TEST(Overlaps) {
+		SubcloneSeeker::EventStore sorted, unsorted;
+		sorted.append(SubcloneSeeker::SomaticEvent::KIND_CNV, 1, 1000, 9000, 0);
+		sorted.append(SubcloneSeeker::SomaticEvent::KIND_CNV, 1, 2000, 100, 0);
+		sorted.append(SubcloneSeeker::SomaticEvent::KIND_CNV, 2, 0, 500, 0);
+		unsorted.append(SubcloneSeeker::SomaticEvent::KIND_CNV, 2, 0, 500, 0);
+		unsorted.append(SubcloneSeeker::SomaticEvent::KIND_CNV, 1, 2000, 100, 0);
+		unsorted.append(SubcloneSeeker::SomaticEvent::KIND_CNV, 1, 1000, 9000, 0);
+		CHECK(sorted.isSorted());
+		CHECK(!unsorted.isSorted());
+
+		// closed intervals, as GenomicRange::overlaps, with or without sorting
+		SubcloneSeeker::EventStore *stores[2] = {&sorted, &unsorted};
+		for(int i=0; i<2; i++) {
+			CHECK(stores[i]->overlapsAny(1, 9500, 100));
+			CHECK(stores[i]->overlapsAny(1, 10000, 10));
+			CHECK(stores[i]->overlapsAny(1, 900, 100));
+			CHECK(!stores[i]->overlapsAny(1, 10001, 10));
+			CHECK(!stores[i]->overlapsAny(1, 0, 999));
+			CHECK(stores[i]->overlapsAny(2, 500, 0));
+			CHECK(!stores[i]->overlapsAny(3, 0, 1000000));
+		}
+
+		// a long segment before a short one still decides
+		unsorted.sortByPosition();
+		CHECK(unsorted.overlapsAny(1, 5000, 10));
+	}
+
+	TEST(ContainsEqual) {
+		SubcloneSeeker::EventStore store;
+		store.append(SubcloneSeeker::SomaticEvent::KIND_CNV, 1, 100000, 50000, 0);
+		store.append(SubcloneSeeker::SomaticEvent::KIND_LOH, 1, 500000, 50000, 0);
+		store.append(SubcloneSeeker::SomaticEvent::KIND_CNV, 2, 5, 50000, 0);
+		store.sortByPosition();
+
+		CHECK(store.containsEqual(SubcloneSeeker::SomaticEvent::KIND_CNV, 1, 105000, 50000, 10000));
+		CHECK(!store.containsEqual(SubcloneSeeker::SomaticEvent::KIND_CNV, 1, 110000, 50000, 10000));
+		CHECK(!store.containsEqual(SubcloneSeeker::SomaticEvent::KIND_CNV, 1, 100000, 70000, 10000));
+		CHECK(store.containsEqual(SubcloneSeeker::SomaticEvent::KIND_CNV, 2, 0, 50000, 10000));
+		// only CNVs are ever equal
+		CHECK(!store.containsEqual(SubcloneSeeker::SomaticEvent::KIND_LOH, 1, 100000, 50000, 10000));
+		CHECK(!store.containsEqual(SubcloneSeeker::SomaticEvent::KIND_CNV, 1, 500000, 50000, 10000));
+
+		// agrees with CNV::isEqualTo
+		SubcloneSeeker::CNV a, b;
+		a.range.chrom = b.range.chrom = 1;
+		a.range.position = 100000;
+		a.range.length = 50000;
+		b.range.position = 109999;
+		b.range.length = 50000;
+		CHECK_EQUAL(a.isEqualTo(&b), store.containsEqual(&b, 10000));
+	}
+}
+
+TEST_MAIN
@@ -94,6 +94,26 @@ SUITE(testGenomicRange) {
 		CHECK(range[7] > range[0]);
 	}
 
+	TEST(BoundariesWithin) {
+		GenomicRange range1, range2;
+		range1.chrom = range2.chrom = 1;
+		range1.position = 1000;
+		range1.length = 1000;
+		range2.position = 1099;
+		range2.length = 950;
+
+		CHECK(range1.boundariesWithin(range2, 100));
+		CHECK(range2.boundariesWithin(range1, 100));
+		CHECK(not range1.boundariesWithin(range2, 99));
+
+		range2.length = 1100;
+		CHECK(not range1.boundariesWithin(range2, 100));
+
+		range2 = range1;
+		range2.chrom = 2;
+		CHECK(not range1.boundariesWithin(range2, 100));
+	}
+
 	TEST(RangeCompare) {
 		GenomicRange range;
 		range.chrom=2;
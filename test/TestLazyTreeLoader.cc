@@ -0,0 +1,92 @@
+/**
+ * @file Unit tests for LazyTreeLoader
+ *
+ * @see LazyTreeLoader
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <sqlite3/sqlite3.h>
+
+#include "LazyTreeLoader.h"
+#include "Subclone.h"
+#include "EventCluster.h"
+#include "SegmentalMutation.h"
+
+#include "common.h"
+
+SUITE(TestLazyTreeLoader) {
+	TEST_FIXTURE(DBFixture, OnDemandLoading) {
+		// root -> (a, b), each node holding a cluster of two CNVs
+		SubcloneSeeker::Subclone nodes[3];
+		SubcloneSeeker::EventCluster clusters[3];
+		SubcloneSeeker::CNV events[6];
+		for(int i=0; i<3; i++) {
+			nodes[i].setFraction(0.1 * (i+1));
+			for(int j=0; j<2; j++) {
+				events[2*i+j].range.chrom = i + 1;
+				events[2*i+j].range.length = 100;
+				events[2*i+j].frequency = 0.5;
+				clusters[i].addEvent(&events[2*i+j]);
+			}
+			nodes[i].addEventCluster(&clusters[i]);
+		}
+		nodes[0].addChild(&nodes[1]);
+		nodes[0].addChild(&nodes[2]);
+
+		SubcloneSeeker::SubcloneSaveTreeTraverser saver(database);
+		SubcloneSeeker::TreeNode::PreOrderTraverse(&nodes[0], saver);
+
+		SubcloneSeeker::LazyTreeLoader loader(database);
+		SubcloneSeeker::Subclone *root = loader.subclone(nodes[0].getId());
+		CHECK(root != NULL);
+		CHECK(loader.subclone(nodes[0].getId()) == root);
+		CHECK(loader.subclone(12345) == NULL);
+		CHECK(loader.numLoadedSubclones() == 1);
+		CHECK_CLOSE(root->fraction(), 0.1, 1e-6);
+
+		// children are read on first access, and keep their order
+		CHECK(!root->isLeaf());
+		CHECK(loader.numLoadedSubclones() == 3);
+		CHECK(root->getVecChildren().size() == 2);
+		SubcloneSeeker::Subclone *b = dynamic_cast<SubcloneSeeker::Subclone *>(root->getVecChildren()[1]);
+		CHECK(b->getId() == nodes[2].getId());
+		CHECK(b->getParent() == root);
+		CHECK(loader.numLoadedClusters() == 0);
+
+		// then clusters, then events
+		CHECK(b->vecEventCluster().size() == 1);
+		CHECK(loader.numLoadedClusters() == 1);
+		CHECK(loader.numLoadedEvents() == 0);
+		CHECK(b->vecEventCluster()[0]->members().size() == 2);
+		CHECK(loader.numLoadedEvents() == 2);
+
+		// leaves have no children to read
+		CHECK(b->isLeaf());
+		CHECK(loader.numLoadedSubclones() == 3);
+	}
+}
+
+TEST_MAIN
@@ -0,0 +1,136 @@
+/**
+ * @file Unit tests for MixtureClustering
+ *
+ * @see MixtureClustering
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "MixtureClustering.h"
+#include "EventCluster.h"
+#include "SegmentalMutation.h"
+
+#include "common.h"
+
+/**
+ * Three groups of ten equally long segments, around 0.2, 0.5 and 0.8
+ */
+static std::vector<SubcloneSeeker::SomaticEvent *> threeGroups() {
+	std::vector<SubcloneSeeker::SomaticEvent *> events;
+	double centers[3] = {0.2, 0.5, 0.8};
+	for(int i=0; i<30; i++) {
+		SubcloneSeeker::CNV *cnv = new SubcloneSeeker::CNV();
+		cnv->frequency = centers[i % 3] + 0.002 * ((i * 7) % 11 - 5);
+		cnv->range.chrom = 1;
+		cnv->range.position = 1000000L * i;
+		cnv->range.length = 1000L;
+		events.push_back(cnv);
+	}
+	return events;
+}
+
+static void freeEvents(std::vector<SubcloneSeeker::SomaticEvent *>& events) {
+	for(size_t i=0; i<events.size(); i++)
+		delete events[i];
+}
+
+SUITE(TestMixtureClustering) {
+	TEST(KMeans) {
+		std::vector<SubcloneSeeker::SomaticEvent *> events = threeGroups();
+
+		SubcloneSeeker::MixtureClustering mixture(SubcloneSeeker::MixtureClustering::MODEL_KMEANS, 0.05);
+		std::vector<SubcloneSeeker::EventCluster *> clusters = mixture.cluster(events);
+
+		CHECK_EQUAL(3, mixture.selected().k);
+		CHECK_EQUAL(3, clusters.size());
+		for(size_t i=0; i<clusters.size(); i++) {
+			CHECK_EQUAL(10, clusters[i]->memberCount());
+			CHECK_CLOSE(0.2 + 0.3 * i, clusters[i]->cellFraction(), 0.01);
+			delete clusters[i];
+		}
+
+		freeEvents(events);
+	}
+
+	TEST(GMM) {
+		std::vector<SubcloneSeeker::SomaticEvent *> events = threeGroups();
+
+		std::vector<SubcloneSeeker::EventCluster *> clusters = SubcloneSeeker::EventCluster::clustering(events, 0.05,
+				SubcloneSeeker::EventCluster::CLUSTERING_GMM);
+
+		CHECK_EQUAL(3, clusters.size());
+		for(size_t i=0; i<clusters.size(); i++) {
+			CHECK_EQUAL(10, clusters[i]->memberCount());
+			CHECK_CLOSE(0.2 + 0.3 * i, clusters[i]->cellFraction(), 0.01);
+			delete clusters[i];
+		}
+
+		freeEvents(events);
+	}
+
+	TEST(ThreadIndependence) {
+		std::vector<double> x, w;
+		for(int i=0; i<50; i++) {
+			x.push_back((i * 37 % 50) / 50.0);
+			w.push_back(1 + i % 4);
+		}
+
+		SubcloneSeeker::MixtureClustering single(SubcloneSeeker::MixtureClustering::MODEL_GMM, 0.05);
+		single.setThreads(1);
+		SubcloneSeeker::MixtureClustering::Fit one = single.fit(x, w);
+
+		SubcloneSeeker::MixtureClustering many(SubcloneSeeker::MixtureClustering::MODEL_GMM, 0.05);
+		many.setThreads(4);
+		SubcloneSeeker::MixtureClustering::Fit four = many.fit(x, w);
+
+		CHECK_EQUAL(one.k, four.k);
+		CHECK_EQUAL(one.restart, four.restart);
+		CHECK_EQUAL(one.bic, four.bic);
+	}
+
+	TEST(Degenerate) {
+		std::vector<SubcloneSeeker::SomaticEvent *> events;
+		SubcloneSeeker::MixtureClustering mixture(SubcloneSeeker::MixtureClustering::MODEL_GMM, 0.05);
+		CHECK(mixture.cluster(events).empty());
+		CHECK_EQUAL(0, mixture.selected().k);
+
+		// identical frequencies
+		SubcloneSeeker::CNV cnv1, cnv2;
+		cnv1.frequency = cnv2.frequency = 0.4;
+		cnv1.range.length = cnv2.range.length = 100L;
+		events.push_back(&cnv1);
+		events.push_back(&cnv2);
+		std::vector<SubcloneSeeker::EventCluster *> clusters = mixture.cluster(events);
+		CHECK_EQUAL(1, clusters.size());
+		if(clusters.size() == 1) {
+			CHECK_EQUAL(2, clusters[0]->memberCount());
+			CHECK_CLOSE(0.4, clusters[0]->cellFraction(), 1e-9);
+			delete clusters[0];
+		}
+	}
+}
+
+TEST_MAIN
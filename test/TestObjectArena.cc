@@ -0,0 +1,123 @@
+/**
+ * @file Unit tests for ObjectArena
+ *
+ * @see ObjectArena
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "ObjectArena.h"
+#include "EventCluster.h"
+#include "SegmentalMutation.h"
+#include <stdint.h>
+
+#include "common.h"
+
+/**
+ * Records the order in which the instances are destroyed
+ */
+struct ArenaProbe {
+	static std::vector<int> destroyed;
+	static int created;
+	int serial;
+	ArenaProbe() : serial(created++) {;}
+	~ArenaProbe() {destroyed.push_back(serial);}
+};
+
+std::vector<int> ArenaProbe::destroyed;
+int ArenaProbe::created = 0;
+
+/**
+ * An object larger than a block
+ */
+struct ArenaBlob {
+	double values[64];
+};
+
+SUITE(TestObjectArena) {
+	TEST(MakeAndReset) {
+		SubcloneSeeker::ObjectArena arena(256);
+
+		for(int i=0; i<100; i++) {
+			ArenaProbe *probe = arena.make<ArenaProbe>();
+			CHECK_EQUAL(i, probe->serial);
+		}
+		CHECK_EQUAL(100, arena.objectCount());
+		size_t capacity = arena.capacity();
+		CHECK(capacity >= 100 * sizeof(ArenaProbe));
+
+		// objects go in reverse order of creation
+		arena.reset();
+		CHECK_EQUAL(0, arena.objectCount());
+		CHECK_EQUAL(100, ArenaProbe::destroyed.size());
+		if(ArenaProbe::destroyed.size() == 100) {
+			CHECK_EQUAL(99, ArenaProbe::destroyed.front());
+			CHECK_EQUAL(0, ArenaProbe::destroyed.back());
+		}
+
+		// the blocks are reused
+		for(int i=0; i<100; i++)
+			arena.make<ArenaProbe>();
+		CHECK_EQUAL(capacity, arena.capacity());
+
+		// an oversized object gets a block of its own, aligned
+		ArenaBlob *blob = arena.make<ArenaBlob>();
+		CHECK_EQUAL(0, (uintptr_t)blob % __alignof__(ArenaBlob));
+		CHECK(arena.capacity() >= capacity + sizeof(ArenaBlob));
+
+		ArenaProbe::destroyed.clear();
+	}
+
+	TEST_FIXTURE(DBFixture, UnarchiveIntoArena) {
+		SubcloneSeeker::EventCluster cluster;
+		SubcloneSeeker::CNV cnv;
+		cnv.frequency = 0.2;
+		cnv.range.chrom = 1;
+		cnv.range.length = 1000L;
+
+		cluster.createTableInDB(database);
+		cnv.createTableInDB(database);
+		sqlite3_int64 clusterID = cluster.archiveObjectToDB(database);
+		cnv.setClusterID(clusterID);
+		cnv.archiveObjectToDB(database);
+
+		SubcloneSeeker::ObjectArena arena;
+		SubcloneSeeker::DBObjectID_vec ids(1, clusterID);
+		std::vector<SubcloneSeeker::EventCluster *> clusters = SubcloneSeeker::EventCluster::unarchiveClustersWithMembers(database, ids, &arena);
+
+		CHECK_EQUAL(1, clusters.size());
+		if(clusters.size() == 1) {
+			CHECK_EQUAL(1, clusters[0]->memberCount());
+			CHECK_CLOSE(0.2, clusters[0]->members()[0]->frequency, 1e-9);
+		}
+
+		// the cluster and its event
+		CHECK_EQUAL(2, arena.objectCount());
+		arena.reset();
+		CHECK_EQUAL(0, arena.objectCount());
+	}
+}
+
+TEST_MAIN
@@ -0,0 +1,78 @@
+/**
+ * @file Unit tests for ShardSpec
+ *
+ * @see ShardSpec
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "ShardSpec.h"
+
+#include "common.h"
+
+SUITE(TestShardSpec) {
+	TEST(Parse) {
+		SubcloneSeeker::ShardSpec shard;
+		CHECK(!shard.isSharded());
+
+		CHECK(shard.parse("2/5"));
+		CHECK(shard.index() == 2);
+		CHECK(shard.count() == 5);
+		CHECK(shard.isSharded());
+
+		CHECK(!shard.parse("5/5"));
+		CHECK(!shard.parse("1/0"));
+		CHECK(!shard.parse("1"));
+		CHECK(!shard.parse("1/2x"));
+		CHECK(shard.index() == 2);
+	}
+
+	TEST(ContiguousBlocks) {
+		const uint64_t numItems = 10;
+		SubcloneSeeker::ShardSpec shards[3];
+		shards[0].parse("0/3");
+		shards[1].parse("1/3");
+		shards[2].parse("2/3");
+
+		// every item is owned by exactly one shard, and the blocks follow each other
+		int lastOwner = 0;
+		for(uint64_t item=0; item<numItems; item++) {
+			int owners = 0, owner = -1;
+			for(int i=0; i<3; i++) {
+				if(shards[i].owns(item, numItems)) {
+					owners++;
+					owner = i;
+				}
+			}
+			CHECK(owners == 1);
+			CHECK(owner >= lastOwner);
+			lastOwner = owner;
+		}
+		CHECK(lastOwner == 2);
+	}
+}
+
+TEST_MAIN
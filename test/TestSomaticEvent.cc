@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "SomaticEvent.h"
 #include "SegmentalMutation.h"
 #include "SNP.h"
+#include "EventVisitor.h"
 
 #include "common.h"
 
@@ -200,6 +201,125 @@ SUITE(TestSomaticEvent) {
 		CHECK(snp2.location.position==1000000L);
 
 	}
+
+	TEST(KindDispatch) {
+		SubcloneSeeker::CNV cnv;
+		SubcloneSeeker::LOH loh;
+		SubcloneSeeker::SNP snp;
+		CHECK_EQUAL(SubcloneSeeker::SomaticEvent::KIND_CNV, cnv.kind());
+		CHECK_EQUAL(SubcloneSeeker::SomaticEvent::KIND_LOH, loh.kind());
+		CHECK_EQUAL(SubcloneSeeker::SomaticEvent::KIND_SNP, snp.kind());
+
+		cnv.range.chrom = 1;
+		cnv.range.position = 5000L;
+		cnv.range.length = 300L;
+		loh.range = cnv.range;
+		snp.location.chrom = 2;
+		snp.location.position = 700L;
+
+		CHECK_EQUAL(300, SubcloneSeeker::eventWeight(&cnv));
+		CHECK_EQUAL(300, SubcloneSeeker::eventWeight(&loh));
+		CHECK_EQUAL(1, SubcloneSeeker::eventWeight(&snp));
+
+		SubcloneSeeker::GenomicRange extent = SubcloneSeeker::eventExtent(&snp);
+		CHECK_EQUAL(2, extent.chrom);
+		CHECK_EQUAL(700, extent.position);
+		CHECK_EQUAL(0, extent.length);
+		CHECK(SubcloneSeeker::eventExtent(&loh) == cnv.range);
+
+		// the kind survives copies, and only CNVs are ever equal
+		SubcloneSeeker::CNV copy = cnv;
+		CHECK_EQUAL(SubcloneSeeker::SomaticEvent::KIND_CNV, copy.kind());
+		CHECK(SubcloneSeeker::eventsEqual(&cnv, &copy, 10000L));
+		CHECK(!SubcloneSeeker::eventsEqual(&cnv, &loh, 10000L));
+		CHECK(!SubcloneSeeker::eventsEqual(&loh, &loh, 10000L));
+	}
+
+	TEST_FIXTURE(DBFixture, BatchUnarchive) {
+		SubcloneSeeker::DBObjectID_vec ids;
+		for(int i=0; i<4; i++) {
+			SubcloneSeeker::CNV cnv;
+			cnv.frequency = 0.1 * (i+1);
+			cnv.range.chrom = i+1;
+			cnv.range.position = 1000000L;
+			cnv.range.length = 1000L;
+			ids.push_back(cnv.archiveObjectToDB(database));
+		}
+
+		// IN-list query, skipping one record
+		SubcloneSeeker::DBObjectID_vec wanted;
+		wanted.push_back(ids[3]);
+		wanted.push_back(ids[0]);
+		wanted.push_back(ids[2]);
+
+		std::vector<SubcloneSeeker::CNV *> cnvs = SubcloneSeeker::Archivable::unarchiveObjectsFromDB<SubcloneSeeker::CNV>(database, wanted);
+
+		CHECK(cnvs.size() == 3);
+		CHECK(cnvs[0]->getId() == ids[0]);
+		CHECK(cnvs[0]->range.chrom == 1);
+		CHECK_CLOSE(cnvs[0]->frequency, 0.1, 1e-3);
+		CHECK(cnvs[1]->getId() == ids[2]);
+		CHECK(cnvs[1]->range.chrom == 3);
+		CHECK(cnvs[2]->getId() == ids[3]);
+		CHECK(cnvs[2]->range.length == 1000L);
+
+		// range query
+		std::vector<SubcloneSeeker::CNV *> ranged = SubcloneSeeker::Archivable::unarchiveObjectsFromDB<SubcloneSeeker::CNV>(database, ids[1], ids[2]);
+
+		CHECK(ranged.size() == 2);
+		CHECK(ranged[0]->range.chrom == 2);
+		CHECK(ranged[1]->range.chrom == 3);
+	}
+
+	TEST_FIXTURE(DBFixture, EventsOfClusters) {
+		SubcloneSeeker::CNV cnv;
+		cnv.range.chrom = 1;
+		cnv.setClusterID(1);
+		cnv.archiveObjectToDB(database);
+
+		SubcloneSeeker::LOH loh;
+		loh.range.chrom = 2;
+		loh.setClusterID(2);
+		loh.archiveObjectToDB(database);
+
+		SubcloneSeeker::SNP snp;
+		snp.location.chrom = 3;
+		snp.setClusterID(1);
+		snp.archiveObjectToDB(database);
+
+		SubcloneSeeker::CNV otherCNV;
+		otherCNV.range.chrom = 4;
+		otherCNV.setClusterID(3);
+		otherCNV.archiveObjectToDB(database);
+
+		SubcloneSeeker::DBObjectID_vec clusterIDs;
+		clusterIDs.push_back(1);
+		clusterIDs.push_back(2);
+
+		SubcloneSeeker::SomaticEventPtr_vec events = SubcloneSeeker::SomaticEvent::unarchiveEventsOfClusters(database, clusterIDs);
+
+		CHECK(events.size() == 3);
+
+		int numCNV = 0, numLOH = 0, numSNP = 0;
+		for(size_t i=0; i<events.size(); i++) {
+			if(dynamic_cast<SubcloneSeeker::CNV *>(events[i]) != NULL) {
+				numCNV++;
+				CHECK(events[i]->clusterID() == 1);
+			}
+			else if(dynamic_cast<SubcloneSeeker::LOH *>(events[i]) != NULL) {
+				numLOH++;
+				CHECK(events[i]->clusterID() == 2);
+			}
+			else if(dynamic_cast<SubcloneSeeker::SNP *>(events[i]) != NULL) {
+				numSNP++;
+				CHECK(events[i]->clusterID() == 1);
+			}
+		}
+
+		CHECK(numCNV == 1);
+		CHECK(numLOH == 1);
+		CHECK(numSNP == 1);
+	}
 }
 
 int main() {
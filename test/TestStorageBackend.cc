@@ -0,0 +1,169 @@
+/**
+ * @file Unit tests for the storage backends
+ *
+ * @see StorageBackend
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include <iostream>
+#include <sqlite3/sqlite3.h>
+#include <cstdio>
+
+#include "MemoryBackend.h"
+#include "SQLiteBackend.h"
+#include "Subclone.h"
+#include "EventCluster.h"
+#include "SegmentalMutation.h"
+#include "SNP.h"
+#include "TreeNode.h"
+
+#include "common.h"
+
+/**
+ * Save a two level tree into a backend, and load it back
+ */
+static void checkTreeRoundTrip(SubcloneSeeker::StorageBackend& backend) {
+	SubcloneSeeker::Subclone root, child;
+	SubcloneSeeker::EventCluster cluster;
+	SubcloneSeeker::CNV cnv;
+	SubcloneSeeker::SNP snp;
+
+	cnv.frequency = 0.6; cnv.range.chrom = 1; cnv.range.position = 100; cnv.range.length = 1000L;
+	snp.frequency = 0.6; snp.location.chrom = 3; snp.location.position = 300;
+	cluster.addEvent(&cnv);
+	cluster.addEvent(&snp);
+
+	root.setFraction(0.4); root.setTreeFraction(1);
+	child.setFraction(0.6); child.setTreeFraction(0.6); child.addEventCluster(&cluster);
+	root.addChild(&child);
+
+	SubcloneSeeker::SubcloneSaveTreeTraverser saver(backend);
+	SubcloneSeeker::TreeNode::PreOrderTraverse(&root, saver);
+
+	std::vector<sqlite3_int64> rootIDs = SubcloneSeeker::SubcloneLoadTreeTraverser::rootNodes(backend);
+	CHECK(rootIDs.size() == 1);
+	CHECK(SubcloneSeeker::SubcloneLoadTreeTraverser::nodesOfParentID(backend, rootIDs[0]).size() == 1);
+
+	SubcloneSeeker::Subclone *newRoot = new SubcloneSeeker::Subclone();
+	CHECK(newRoot->unarchiveObject(backend, rootIDs[0]));
+	SubcloneSeeker::SubcloneLoadTreeTraverser loader(backend);
+	SubcloneSeeker::TreeNode::PreOrderTraverse(newRoot, loader);
+
+	CHECK_CLOSE(newRoot->fraction(), 0.4, 1e-6);
+	CHECK(newRoot->getVecChildren().size() == 1);
+	SubcloneSeeker::Subclone *newChild = dynamic_cast<SubcloneSeeker::Subclone *>(newRoot->getVecChildren()[0]);
+	CHECK_CLOSE(newChild->treeFraction(), 0.6, 1e-6);
+	CHECK(newChild->isLeaf());
+	CHECK(newChild->vecEventCluster().size() == 1);
+	CHECK(newChild->vecEventCluster()[0]->members().size() == 2);
+
+	SubcloneSeeker::CNV *newCNV = dynamic_cast<SubcloneSeeker::CNV *>(newChild->vecEventCluster()[0]->members()[0]);
+	CHECK(newCNV != NULL);
+	CHECK(newCNV->range.position == 100);
+	CHECK(newCNV->range.length == 1000);
+	SubcloneSeeker::SNP *newSNP = dynamic_cast<SubcloneSeeker::SNP *>(newChild->vecEventCluster()[0]->members()[1]);
+	CHECK(newSNP != NULL);
+	CHECK(newSNP->location.chrom == 3);
+}
+
+SUITE(TestStorageBackend) {
+	TEST(MemoryBackendArchive) {
+		SubcloneSeeker::MemoryBackend backend;
+		SubcloneSeeker::CNV cnv, newCNV;
+
+		cnv.frequency = 0.3; cnv.range.chrom = 2; cnv.range.position = 200; cnv.range.length = 50L;
+		CHECK(!cnv.tableExists(backend));
+		CHECK(cnv.archiveObject(backend) == 1);
+		CHECK(cnv.tableExists(backend));
+
+		// archiving again updates the existing record
+		cnv.range.length = 60L;
+		CHECK(cnv.archiveObject(backend) == 1);
+		CHECK(cnv.vecAllObjectsID(backend).size() == 1);
+
+		CHECK(newCNV.unarchiveObject(backend, 1));
+		CHECK(newCNV.getId() == 1);
+		CHECK(newCNV.range.chrom == 2);
+		CHECK(newCNV.range.length == 60);
+		CHECK_CLOSE(newCNV.frequency, 0.3, 1e-6);
+		CHECK(!newCNV.unarchiveObject(backend, 2));
+	}
+
+	TEST(MemoryBackendTree) {
+		SubcloneSeeker::MemoryBackend backend;
+		checkTreeRoundTrip(backend);
+	}
+
+	TEST(SQLiteBackendTree) {
+		sqlite3 *database;
+		CHECK(sqlite3_open(":memory:", &database) == SQLITE_OK);
+		SubcloneSeeker::SQLiteBackend backend(database, true);
+		checkTreeRoundTrip(backend);
+	}
+
+	TEST(SQLiteWrappersKeepNoStatements) {
+		sqlite3 *database;
+		CHECK(sqlite3_open(":memory:", &database) == SQLITE_OK);
+
+		SubcloneSeeker::EventCluster cluster, newCluster;
+		cluster.setCellFraction(0.5);
+		sqlite3_int64 id = cluster.archiveObjectToDB(database);
+		CHECK(id > 0);
+		CHECK(cluster.tableExistsInDB(database));
+		CHECK(newCluster.unarchiveObjectFromDB(database, id));
+		CHECK(newCluster.vecAllObjectsID(database).size() == 1);
+
+		// the sqlite3* methods leave nothing prepared behind
+		CHECK(sqlite3_close(database) == SQLITE_OK);
+	}
+
+	TEST(BinaryFileBackendPersistence) {
+		{
+			SubcloneSeeker::BinaryFileBackend backend;
+			CHECK(backend.open("test.ssarchive"));
+			checkTreeRoundTrip(backend);
+			CHECK(backend.save());
+		}
+
+		CHECK(SubcloneSeeker::BinaryFileBackend::isBackendFile("test.ssarchive"));
+
+		SubcloneSeeker::BinaryFileBackend backend;
+		CHECK(backend.open("test.ssarchive", true));
+		std::vector<sqlite3_int64> rootIDs = SubcloneSeeker::SubcloneLoadTreeTraverser::rootNodes(backend);
+		CHECK(rootIDs.size() == 1);
+
+		SubcloneSeeker::SNP snp;
+		CHECK(snp.vecAllObjectsID(backend).size() == 1);
+		CHECK(snp.unarchiveObject(backend, snp.vecAllObjectsID(backend)[0]));
+		CHECK(snp.location.position == 300);
+
+		CHECK(!backend.open("test.ssarchive.missing", true));
+		remove("test.ssarchive");
+	}
+}
+
+TEST_MAIN
@@ -35,6 +35,8 @@ THE SOFTWARE.
 
 #include "Subclone.h"
 #include "EventCluster.h"
+#include "SegmentalMutation.h"
+#include "SNP.h"
 
 #include "common.h"
 
@@ -55,6 +57,32 @@ SUITE(TestSubclone) {
 		CHECK(subclone.vecEventCluster()[0] == &cluster);
 	}
 
+	TEST(AppendEvents) {
+		SubcloneSeeker::Subclone subclone;
+		SubcloneSeeker::EventCluster cluster1, cluster2;
+		SubcloneSeeker::CNV cnv1, cnv2, cnv3;
+
+		cluster1.addEvent(&cnv1);
+		cluster1.addEvent(&cnv2);
+		cluster2.addEvent(&cnv3);
+		subclone.addEventCluster(&cluster1);
+		subclone.addEventCluster(&cluster2);
+
+		CHECK_EQUAL(2, cluster1.memberCount());
+		CHECK(&cluster1.members() == &cluster1.members());
+		CHECK(*cluster1.beginMembers() == &cnv1);
+		CHECK(cluster1.endMembers() - cluster1.beginMembers() == 2);
+
+		std::vector<SubcloneSeeker::SomaticEvent *> events(1, (SubcloneSeeker::SomaticEvent *)NULL);
+		const SubcloneSeeker::Subclone& readOnly = subclone;
+		readOnly.appendEvents(events);
+		CHECK_EQUAL(4, events.size());
+		CHECK(events[0] == NULL);
+		CHECK(events[1] == &cnv1);
+		CHECK(events[2] == &cnv2);
+		CHECK(events[3] == &cnv3);
+	}
+
 	TEST_FIXTURE(DBFixture, SubcloneToDB) {
 		SubcloneSeeker::Subclone root, child1, child2, child11;
 
@@ -112,6 +140,100 @@ SUITE(TestSubclone) {
 		CHECK_CLOSE(newChild11->fraction(), 0.1, 1e-3);
 		CHECK(newChild11->isLeaf());
 	}
+
+	TEST_FIXTURE(DBFixture, SubcloneEventsToDB) {
+		SubcloneSeeker::Subclone root, child;
+		SubcloneSeeker::EventCluster cluster;
+		SubcloneSeeker::CNV cnv;
+		SubcloneSeeker::LOH loh;
+		SubcloneSeeker::SNP snp;
+
+		cnv.frequency = 0.4;
+		cnv.range.chrom = 1;
+		cnv.range.length = 1000L;
+		loh.frequency = 0.4;
+		loh.range.chrom = 2;
+		loh.range.length = 1000L;
+		snp.frequency = 0.4;
+		snp.location.chrom = 3;
+		cluster.addEvent(&cnv);
+		cluster.addEvent(&loh);
+		cluster.addEvent(&snp);
+
+		root.setFraction(0.6);
+		child.setFraction(0.4);
+		child.addEventCluster(&cluster);
+		root.addChild(&child);
+
+		// write
+		SubcloneSeeker::SubcloneSaveTreeTraverser stt(database);
+		SubcloneSeeker::TreeNode::PreOrderTraverse(&root, stt);
+
+		// read
+		std::vector<sqlite3_int64> rootNodes = SubcloneSeeker::SubcloneLoadTreeTraverser::rootNodes(database);
+		CHECK(rootNodes.size() == 1);
+
+		SubcloneSeeker::Subclone *newRoot = new SubcloneSeeker::Subclone();
+		newRoot->unarchiveObjectFromDB(database, rootNodes[0]);
+
+		SubcloneSeeker::SubcloneLoadTreeTraverser ltt(database);
+		SubcloneSeeker::TreeNode::PreOrderTraverse(newRoot, ltt);
+
+		CHECK(newRoot->getVecChildren().size() == 1);
+		SubcloneSeeker::Subclone *newChild = dynamic_cast<SubcloneSeeker::Subclone *>(newRoot->getVecChildren()[0]);
+
+		CHECK(newChild->vecEventCluster().size() == 1);
+		CHECK(newChild->vecEventCluster()[0]->members().size() == 3);
+	}
+
+	TEST_FIXTURE(DBFixture, SharedClustersToDB) {
+		SubcloneSeeker::Subclone root1, child1, root2, child2;
+		SubcloneSeeker::EventCluster cluster;
+		SubcloneSeeker::CNV cnv;
+
+		cnv.frequency = 0.4;
+		cnv.range.chrom = 1;
+		cnv.range.length = 1000L;
+		cluster.addEvent(&cnv);
+
+		root1.addChild(&child1);
+		child1.addEventCluster(&cluster);
+		root2.addChild(&child2);
+		child2.addEventCluster(&cluster);
+
+		// write two trees sharing the same cluster
+		SubcloneSeeker::SubcloneSaveTreeTraverser stt(database, true);
+		SubcloneSeeker::TreeNode::PreOrderTraverse(&root1, stt);
+		SubcloneSeeker::TreeNode::PreOrderTraverse(&root2, stt);
+
+		CHECK(cluster.getId() != 0);
+
+		sqlite3_stmt *statement;
+		sqlite3_prepare_v2(database, "SELECT (SELECT COUNT(*) FROM Clusters), (SELECT COUNT(*) FROM Events_CNV), (SELECT COUNT(*) FROM SubcloneClusters);", -1, &statement, 0);
+		CHECK(sqlite3_step(statement) == SQLITE_ROW);
+		CHECK(sqlite3_column_int(statement, 0) == 1);
+		CHECK(sqlite3_column_int(statement, 1) == 1);
+		CHECK(sqlite3_column_int(statement, 2) == 2);
+		sqlite3_finalize(statement);
+
+		// read both trees back
+		std::vector<sqlite3_int64> rootNodes = SubcloneSeeker::SubcloneLoadTreeTraverser::rootNodes(database);
+		CHECK(rootNodes.size() == 2);
+
+		SubcloneSeeker::SubcloneLoadTreeTraverser ltt(database);
+		for(size_t i=0; i<rootNodes.size(); i++) {
+			SubcloneSeeker::Subclone *newRoot = new SubcloneSeeker::Subclone();
+			newRoot->unarchiveObjectFromDB(database, rootNodes[i]);
+			SubcloneSeeker::TreeNode::PreOrderTraverse(newRoot, ltt);
+
+			CHECK(newRoot->vecEventCluster().size() == 0);
+			CHECK(newRoot->getVecChildren().size() == 1);
+
+			SubcloneSeeker::Subclone *newChild = dynamic_cast<SubcloneSeeker::Subclone *>(newRoot->getVecChildren()[0]);
+			CHECK(newChild->vecEventCluster().size() == 1);
+			CHECK(newChild->vecEventCluster()[0]->members().size() == 1);
+		}
+	}
 }
 
 TEST_MAIN
@@ -0,0 +1,99 @@
+/**
+ * @file Unit tests for TableSchema
+ *
+ * @see TableSchema
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "TableSchema.h"
+#include "ArchiveRecord.h"
+#include "SQLiteBackend.h"
+#include "MemoryBackend.h"
+
+#include "common.h"
+
+SUITE(TestTableSchema) {
+	TEST(GeneratedSQL) {
+		static const SubcloneSeeker::ArchiveField fields[] = {
+			{"fraction", "REAL NOT NULL", false},
+			{"parentId", "INTEGER NULL", true}
+		};
+		SubcloneSeeker::TableSchema schema("Nodes", fields);
+
+		CHECK(schema.name == "Nodes");
+		CHECK(schema.columns.size() == 2);
+		CHECK(schema.columnIndex("parentId") == 1);
+		CHECK(schema.columnIndex("id") == -1);
+		CHECK(schema.indexedColumns.size() == 1);
+		CHECK(schema.indexedColumns[0] == "parentId");
+
+		CHECK_EQUAL(", fraction REAL NOT NULL, parentId INTEGER NULL", schema.createColumnsSQL);
+		CHECK_EQUAL("INSERT INTO Nodes (fraction, parentId) VALUES (?, ?);", schema.insertSQL);
+		CHECK_EQUAL("UPDATE Nodes SET fraction=?, parentId=? WHERE id=?;", schema.updateSQL);
+		CHECK_EQUAL("SELECT fraction, parentId FROM Nodes WHERE id=?;", schema.selectSQL);
+	}
+
+	TEST(MismatchedRecordRejected) {
+		static const SubcloneSeeker::ArchiveField fields[] = {
+			{"fraction", "REAL NULL", false},
+			{"weights", "BLOB NULL", false}
+		};
+		SubcloneSeeker::TableSchema schema("Nodes", fields);
+
+		sqlite3 *database;
+		CHECK(sqlite3_open(":memory:", &database) == SQLITE_OK);
+		SubcloneSeeker::SQLiteBackend backend(database, true);
+		CHECK(backend.createTable(schema));
+
+		std::vector<double> weights(3, 0.5);
+		SubcloneSeeker::ArchiveRecord full;
+		full.appendReal(0.25);
+		full.appendVector(weights);
+		sqlite3_int64 id = backend.insertRecord(schema, full);
+		CHECK(id > 0);
+
+		// a record short of a column is refused, not completed by the previous bindings
+		SubcloneSeeker::ArchiveRecord partial;
+		partial.appendReal(0.75);
+		CHECK(backend.insertRecord(schema, partial) < 0);
+		CHECK(!backend.updateRecord(schema, id, partial));
+		CHECK(backend.allRecordIDs(schema).size() == 1);
+
+		SubcloneSeeker::ArchiveRecord fetched;
+		CHECK(backend.fetchRecord(schema, id, fetched));
+		CHECK_CLOSE(0.25, fetched.realAt(0), 1e-9);
+		std::vector<double> fetchedWeights;
+		fetched.vectorAt(1, fetchedWeights);
+		CHECK(fetchedWeights == weights);
+
+		SubcloneSeeker::MemoryBackend memory;
+		CHECK(memory.createTable(schema));
+		CHECK(memory.insertRecord(schema, partial) < 0);
+	}
+}
+
+TEST_MAIN
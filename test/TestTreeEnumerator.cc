@@ -0,0 +1,100 @@
+/**
+ * @file Unit tests for LazyTreeLoader
+ *
+ * @see LazyTreeLoader
+ * @author Yi Qiao
+ */
+
+#include "TreeEnumerator.h"
+#include "Subclone.h"
+#include "EventCluster.h"
+#include "ShardSpec.h"
+
+#include "common.h"
+
+/**
+ * Clusters of fractions 0.2, 0.6 and 0.3, giving 3! = 6 trees of which only the
+ * one with all three under the root is not viable
+ */
+static std::vector<SubcloneSeeker::EventCluster> testClusters() {
+	std::vector<SubcloneSeeker::EventCluster> clusters(3);
+	clusters[0].setCellFraction(0.2);
+	clusters[1].setCellFraction(0.6);
+	clusters[2].setCellFraction(0.3);
+	for(size_t i=0; i<clusters.size(); i++)
+		clusters[i].setId(i+1);
+	SubcloneSeeker::TreeEnumerator::sortForPlacement(clusters);
+	return clusters;
+}
+
+SUITE(TestTreeEnumerator) {
+	TEST(AllTrees) {
+		std::vector<SubcloneSeeker::EventCluster> clusters = testClusters();
+		CHECK(clusters[0].getId() == 2);
+		CHECK(clusters[2].getId() == 1);
+
+		SubcloneSeeker::TreeEnumerator enumerator(clusters);
+		CHECK(enumerator.nodes().size() == 3);
+		CHECK(!enumerator.isViable());
+
+		int numViable = 0;
+		while(enumerator.next()) {
+			if(enumerator.isViable()) {
+				numViable++;
+				CHECK_CLOSE(enumerator.root()->treeFraction(), 1, 1e-6);
+			}
+			else {
+				// the first tree puts everything under the root
+				CHECK(enumerator.numTrees() == 1);
+				CHECK(enumerator.root()->getVecChildren().size() == 3);
+			}
+
+			// the last tree is a chain
+			if(enumerator.numTrees() == 6) {
+				SubcloneSeeker::TreeNode *node = enumerator.root();
+				for(size_t i=0; i<3; i++) {
+					CHECK(node->getVecChildren().size() == 1);
+					node = node->getVecChildren()[0];
+				}
+				CHECK(node->isLeaf());
+			}
+		}
+		CHECK(enumerator.numTrees() == 6);
+		CHECK(numViable == 5);
+		CHECK(!enumerator.next());
+	}
+
+	TEST(GroupedClusters) {
+		std::vector<SubcloneSeeker::EventCluster> clusters = testClusters();
+		clusters.push_back(SubcloneSeeker::EventCluster());
+		clusters.back().setCellFraction(0.295);
+		SubcloneSeeker::TreeEnumerator::sortForPlacement(clusters);
+
+		SubcloneSeeker::TreeEnumerator enumerator(clusters);
+		CHECK(enumerator.nodes().size() == 3);
+		CHECK(enumerator.nodes()[1]->vecEventCluster().size() == 2);
+
+		std::vector<SubcloneSeeker::EventCluster> none;
+		SubcloneSeeker::TreeEnumerator empty(none);
+		CHECK(!empty.next());
+	}
+
+	TEST(Shards) {
+		std::vector<SubcloneSeeker::EventCluster> clusters = testClusters();
+		uint64_t numTrees = 0;
+		for(int i=0; i<2; i++) {
+			SubcloneSeeker::ShardSpec shard;
+			CHECK(shard.parse(i == 0 ? "0/2" : "1/2"));
+
+			SubcloneSeeker::TreeEnumerator enumerator(clusters);
+			enumerator.setShard(shard);
+			while(enumerator.next())
+				;
+			CHECK(enumerator.numTrees() == 3);
+			numTrees += enumerator.numTrees();
+		}
+		CHECK(numTrees == 6);
+	}
+}
+
+TEST_MAIN
@@ -0,0 +1,145 @@
+/**
+ * @file Unit tests for TreeSetFile
+ *
+ * @see TreeSetFile
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include <iostream>
+#include <sqlite3/sqlite3.h>
+#include <cstdio>
+
+#include "TreeSetFile.h"
+#include "Subclone.h"
+#include "EventCluster.h"
+#include "SegmentalMutation.h"
+#include "SNP.h"
+
+#include "common.h"
+
+SUITE(TestTreeSetFile) {
+	TEST(TreeSetFileRoundTrip) {
+		SubcloneSeeker::Subclone root1, child1, child2, root2, child3;
+		SubcloneSeeker::EventCluster clusterA, clusterB;
+		SubcloneSeeker::CNV cnv;
+		SubcloneSeeker::LOH loh;
+		SubcloneSeeker::SNP snp;
+
+		cnv.setId(11); cnv.frequency = 0.6; cnv.range.chrom = 1; cnv.range.position = 100; cnv.range.length = 1000L;
+		loh.setId(12); loh.frequency = 0.6; loh.range.chrom = 2; loh.range.position = 200; loh.range.length = 2000L;
+		snp.setId(13); snp.frequency = 0.3; snp.location.chrom = 3; snp.location.position = 300;
+		clusterA.addEvent(&cnv);
+		clusterA.addEvent(&loh);
+		clusterB.addEvent(&snp);
+		clusterA.setId(5);
+		clusterB.setId(6);
+
+		// two trees sharing cluster A
+		root1.setId(20); root1.setFraction(0.4); root1.setTreeFraction(1);
+		child1.setId(21); child1.setFraction(0.3); child1.setTreeFraction(0.6); child1.addEventCluster(&clusterA);
+		child2.setId(22); child2.setFraction(0.3); child2.setTreeFraction(0.3); child2.addEventCluster(&clusterB);
+		root1.addChild(&child1);
+		child1.addChild(&child2);
+
+		root2.setId(10); root2.setFraction(0.4); root2.setTreeFraction(1);
+		child3.setId(11); child3.setFraction(0.6); child3.setTreeFraction(0.6); child3.addEventCluster(&clusterA);
+		root2.addChild(&child3);
+
+		std::vector<SubcloneSeeker::Subclone *> roots;
+		roots.push_back(&root1);
+		roots.push_back(&root2);
+
+		// write
+		CHECK(SubcloneSeeker::TreeSetFile::write("test.treeset", roots));
+		CHECK(SubcloneSeeker::TreeSetFile::isTreeSetFile("test.treeset"));
+
+		// read in place
+		SubcloneSeeker::TreeSetFile treeSet;
+		CHECK(treeSet.open("test.treeset"));
+		CHECK(treeSet.numTrees() == 2);
+		CHECK(treeSet.numClusters() == 2);
+		CHECK(treeSet.rootIDs().size() == 2);
+		CHECK(treeSet.rootIDs()[0] == 10);
+		CHECK(treeSet.rootIDs()[1] == 20);
+		CHECK(treeSet.treeWithRootID(15) == NULL);
+
+		const SubcloneSeeker::TreeSetFile::TreeRecord *tree = treeSet.treeWithRootID(20);
+		CHECK(tree != NULL);
+		CHECK(tree->nodeCount == 3);
+		const SubcloneSeeker::TreeSetFile::NodeRecord *nodes = treeSet.nodesOfTree(*tree);
+		CHECK(nodes[0].parent == -1);
+		CHECK(nodes[1].parent == 0);
+		CHECK(nodes[2].parent == 1);
+		CHECK(nodes[2].numPlacements == 1);
+		const SubcloneSeeker::TreeSetFile::ClusterRecord& clusterRecord = treeSet.cluster(treeSet.placementsOfNode(nodes[2])[0]);
+		CHECK(clusterRecord.id == 6);
+		CHECK(treeSet.eventsOfCluster(clusterRecord)[0].type == SubcloneSeeker::TreeSetFile::EVENT_SNP);
+
+		// expand
+		SubcloneSeeker::Subclone *newRoot = treeSet.expandTree(20);
+		CHECK(newRoot != NULL);
+		CHECK(newRoot->getId() == 20);
+		CHECK_CLOSE(newRoot->fraction(), 0.4, 1e-6);
+		CHECK(newRoot->getVecChildren().size() == 1);
+
+		SubcloneSeeker::Subclone *newChild1 = dynamic_cast<SubcloneSeeker::Subclone *>(newRoot->getVecChildren()[0]);
+		CHECK(newChild1->getId() == 21);
+		CHECK_CLOSE(newChild1->treeFraction(), 0.6, 1e-6);
+		CHECK(newChild1->vecEventCluster().size() == 1);
+		CHECK(newChild1->vecEventCluster()[0]->getId() == 5);
+		CHECK(newChild1->vecEventCluster()[0]->members().size() == 2);
+
+		SubcloneSeeker::CNV *newCNV = dynamic_cast<SubcloneSeeker::CNV *>(newChild1->vecEventCluster()[0]->members()[0]);
+		CHECK(newCNV != NULL);
+		CHECK(newCNV->getId() == 11);
+		CHECK(newCNV->range.chrom == 1);
+		CHECK(newCNV->range.position == 100);
+		CHECK(newCNV->range.length == 1000);
+		CHECK(dynamic_cast<SubcloneSeeker::LOH *>(newChild1->vecEventCluster()[0]->members()[1]) != NULL);
+
+		SubcloneSeeker::Subclone *newChild2 = dynamic_cast<SubcloneSeeker::Subclone *>(newChild1->getVecChildren()[0]);
+		CHECK(newChild2->isLeaf());
+		SubcloneSeeker::SNP *newSNP = dynamic_cast<SubcloneSeeker::SNP *>(newChild2->vecEventCluster()[0]->members()[0]);
+		CHECK(newSNP != NULL);
+		CHECK(newSNP->location.position == 300);
+		CHECK_CLOSE(newSNP->frequency, 0.3, 1e-6);
+
+		// clusters are shared among the expanded trees
+		SubcloneSeeker::Subclone *otherRoot = treeSet.expandTree(10);
+		CHECK(otherRoot != NULL);
+		SubcloneSeeker::Subclone *newChild3 = dynamic_cast<SubcloneSeeker::Subclone *>(otherRoot->getVecChildren()[0]);
+		CHECK(newChild3->vecEventCluster()[0] == newChild1->vecEventCluster()[0]);
+
+		treeSet.close();
+		CHECK(treeSet.numTrees() == 0);
+		CHECK(!treeSet.open("test.treeset.missing"));
+
+		remove("test.treeset");
+	}
+}
+
+TEST_MAIN
@@ -0,0 +1,95 @@
+/**
+ * @file Unit tests for TreeSummary
+ *
+ * @see TreeSummary
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include <iostream>
+#include <sqlite3/sqlite3.h>
+#include <cstdio>
+
+#include "TreeSummary.h"
+#include "TreeNode.h"
+
+#include "common.h"
+
+SUITE(TestTreeSummary) {
+	TEST_FIXTURE(DBFixture, TreeSummaryToDB) {
+		SubcloneSeeker::TreeNode root, child1, child2, child11, child12;
+
+		root.addChild(&child1);
+		root.addChild(&child2);
+		child1.addChild(&child11);
+		child1.addChild(&child12);
+
+		SubcloneSeeker::TreeSummary deepTree;
+		deepTree.summarize(&root);
+		CHECK(deepTree.nodeCount() == 5);
+		CHECK(deepTree.depth() == 3);
+		CHECK(deepTree.leafCount() == 3);
+		CHECK(!deepTree.hasScore());
+
+		SubcloneSeeker::TreeSummary flatTree;
+		flatTree.summarize(&child1);
+		CHECK(flatTree.nodeCount() == 3);
+		CHECK(flatTree.depth() == 2);
+		CHECK(flatTree.leafCount() == 2);
+
+		// write
+		deepTree.setRoot(7, SubcloneSeeker::TreeSummary::ENCODING_SUBCLONES);
+		deepTree.setScore(0.5);
+		CHECK(deepTree.archiveObjectToDB(database) > 0);
+		flatTree.setRoot(3, SubcloneSeeker::TreeSummary::ENCODING_COMPACT);
+		CHECK(flatTree.archiveObjectToDB(database) > 0);
+
+		// read, sorted and filtered
+		std::vector<SubcloneSeeker::TreeSummary *> summaries = SubcloneSeeker::TreeSummary::summariesFromDB(database, "depth");
+		CHECK(summaries.size() == 2);
+		CHECK(summaries[0]->rootID() == 3);
+		CHECK(summaries[0]->encoding() == SubcloneSeeker::TreeSummary::ENCODING_COMPACT);
+		CHECK(!summaries[0]->hasScore());
+		CHECK(summaries[1]->rootID() == 7);
+		CHECK(summaries[1]->depth() == 3);
+		CHECK(summaries[1]->hasScore());
+		CHECK_CLOSE(summaries[1]->score(), 0.5, 1e-6);
+		for(size_t i=0; i<summaries.size(); i++)
+			delete summaries[i];
+
+		summaries = SubcloneSeeker::TreeSummary::summariesFromDB(database, "rootID", 2);
+		CHECK(summaries.size() == 1);
+		CHECK(summaries[0]->rootID() == 3);
+		delete summaries[0];
+
+		summaries = SubcloneSeeker::TreeSummary::summariesFromDB(database, "rootID; DROP TABLE Trees");
+		CHECK(summaries.size() == 0);
+		CHECK(SubcloneSeeker::TreeSummary::isSortKey("score"));
+		CHECK(!SubcloneSeeker::TreeSummary::isSortKey("bogus"));
+	}
+}
+
+TEST_MAIN
@@ -0,0 +1,63 @@
+/**
+ * @file Unit tests for LazyTreeLoader
+ *
+ * @see LazyTreeLoader
+ * @author Yi Qiao
+ */
+
+#include <sqlite3/sqlite3.h>
+
+#include "ViableTreesTable.h"
+#include "EventCluster.h"
+
+#include "common.h"
+
+/**
+ * Run a query returning a single integer
+ */
+static sqlite3_int64 queryInteger(sqlite3 *database, const char *query) {
+	sqlite3_stmt *statement;
+	sqlite3_int64 value = -1;
+	if(sqlite3_prepare_v2(database, query, -1, &statement, 0) == SQLITE_OK) {
+		if(sqlite3_step(statement) == SQLITE_ROW)
+			value = sqlite3_column_int64(statement, 0);
+		sqlite3_finalize(statement);
+	}
+	return value;
+}
+
+SUITE(TestViableTreesTable) {
+	TEST_FIXTURE(DBFixture, QueryTrees) {
+		// 3! = 6 trees, of which only the one with all clusters under the root is not viable
+		double fractions[] = {0.2, 0.6, 0.3};
+		for(int i=0; i<3; i++) {
+			SubcloneSeeker::EventCluster cluster;
+			cluster.setCellFraction(fractions[i]);
+			CHECK(cluster.archiveObjectToDB(database) == i+1);
+		}
+
+		sqlite3 *query;
+		CHECK(sqlite3_open(":memory:", &query) == SQLITE_OK);
+		CHECK(SubcloneSeeker::ViableTreesTable::registerModule(query));
+		CHECK(sqlite3_exec(query, "CREATE VIRTUAL TABLE temp.trees USING viable_trees('test.sqlite');", NULL, NULL, NULL) == SQLITE_OK);
+
+		CHECK(queryInteger(query, "SELECT COUNT(DISTINCT tree_id) FROM trees;") == 5);
+		CHECK(queryInteger(query, "SELECT COUNT(*) FROM trees;") == 20);
+		CHECK(queryInteger(query, "SELECT COUNT(*) FROM trees WHERE parent IS NULL AND cluster_id IS NULL AND depth = 0;") == 5);
+
+		// the 0.6 cluster is always placed under the root, and a chain is 4 levels deep
+		CHECK(queryInteger(query, "SELECT COUNT(*) FROM trees WHERE cluster_id = 2 AND parent = 0;") == 5);
+		CHECK(queryInteger(query, "SELECT COUNT(DISTINCT tree_id) FROM trees WHERE tree_depth = 4;") == 1);
+
+		// the 0.2 cluster sits under the 0.6 one (node 1) in two trees
+		CHECK(queryInteger(query, "SELECT COUNT(*) FROM trees c JOIN trees p ON p.tree_id = c.tree_id "
+					"AND p.node = c.parent WHERE c.cluster_id = 1 AND p.cluster_id = 2;") == 2);
+
+		// a missing cluster database is an error
+		CHECK(sqlite3_exec(query, "CREATE VIRTUAL TABLE temp.none USING viable_trees('missing.sqlite');", NULL, NULL, NULL) != SQLITE_OK);
+
+		sqlite3_close(query);
+	}
+}
+
+TEST_MAIN
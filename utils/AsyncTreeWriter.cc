@@ -0,0 +1,118 @@
+/**
+ * @file AsyncTreeWriter.cc
+ * Implementation of the asynchronous tree writer used by ssmain
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "AsyncTreeWriter.h"
+#include "Subclone.h"
+#include <chrono>
+
+AsyncTreeWriter::AsyncTreeWriter(sqlite3 *database, bool compactTrees, std::vector<EventCluster>& clusters, size_t capacity):
+	_database(database), _backend(database), _compactTrees(compactTrees), _queue(capacity), _closing(false), _numStalls(0)
+{
+	for(size_t i=0; i<clusters.size(); i++)
+		_clusters[clusters[i].getId()] = &clusters[i];
+}
+
+void AsyncTreeWriter::start() {
+	_thread = std::thread(&AsyncTreeWriter::run, this);
+}
+
+void AsyncTreeWriter::submit(PendingTree& pending) {
+	// back-pressure: wait for the writer to make room
+	if(_queue.tryPush(pending))
+		return;
+
+	_numStalls++;
+	while(!_queue.tryPush(pending))
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+void AsyncTreeWriter::close() {
+	if(!_thread.joinable())
+		return;
+	_closing.store(true, std::memory_order_release);
+	_thread.join();
+}
+
+void AsyncTreeWriter::run() {
+	PendingTree pending;
+	size_t numInTransaction = 0;
+
+	while(true) {
+		// read the flag first, so that no tree submitted before closing is missed
+		bool closing = _closing.load(std::memory_order_acquire);
+
+		if(_queue.tryPop(pending)) {
+			if(numInTransaction == 0)
+				sqlite3_exec(_database, "BEGIN TRANSACTION;", 0, 0, 0);
+
+			writeTree(pending);
+
+			if(++numInTransaction == TransactionSize) {
+				sqlite3_exec(_database, "COMMIT TRANSACTION;", 0, 0, 0);
+				numInTransaction = 0;
+			}
+			continue;
+		}
+
+		// queue ran dry, commit what has been written so far
+		if(numInTransaction > 0) {
+			sqlite3_exec(_database, "COMMIT TRANSACTION;", 0, 0, 0);
+			numInTransaction = 0;
+		}
+
+		if(closing)
+			break;
+
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+}
+
+void AsyncTreeWriter::writeTree(PendingTree& pending) {
+	if(_compactTrees) {
+		pending.tree.setId(0);
+		pending.summary.setRoot(pending.tree.archiveObject(_backend), TreeSummary::ENCODING_COMPACT);
+	}
+	else {
+		Subclone *root = pending.tree.expandTree(_clusters);
+		if(root == NULL)
+			return;
+
+		SubcloneSaveTreeTraverser stt(_database, true);
+		TreeNode::PreOrderTraverse(root, stt);
+		pending.summary.setRoot(root->getId(), TreeSummary::ENCODING_SUBCLONES);
+
+		// the clusters belong to the enumeration
+		SubcloneFreeTreeTraverser deleter(false);
+		TreeNode::PostOrderTraverse(root, deleter);
+	}
+
+	pending.summary.setId(0);
+	pending.summary.archiveObject(_backend);
+}
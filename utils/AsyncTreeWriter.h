@@ -0,0 +1,188 @@
+/**
+ * @file AsyncTreeWriter.h
+ * A writer thread persisting viable trees while ssmain keeps enumerating.
+ * The enumeration thread packs each viable tree into a CompactTree and hands
+ * it over through a bounded single-producer single-consumer ring buffer; the
+ * writer thread owns the output database connection and drains the buffer.
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef ASYNC_TREE_WRITER_H
+#define ASYNC_TREE_WRITER_H
+
+#include "CompactTree.h"
+#include "TreeSummary.h"
+#include "EventCluster.h"
+#include "SQLiteBackend.h"
+#include <sqlite3/sqlite3.h>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <thread>
+
+using namespace SubcloneSeeker;
+
+/**
+ * @brief A bounded lock-free queue for exactly one producer and one consumer thread
+ *
+ * The capacity is rounded up to a power of two. Each side only writes its own
+ * position counter, so no lock is needed; the release/acquire pairs make a slot's
+ * content visible before the slot is published to the other side.
+ */
+template <class T>
+class SPSCQueue {
+	protected:
+		std::vector<T> _slots; /**< the ring storage */
+		size_t _mask; /**< capacity - 1 */
+		std::atomic<size_t> _head; /**< position of the next slot to be read, written by the consumer */
+		std::atomic<size_t> _tail; /**< position of the next slot to be written, written by the producer */
+
+	public:
+		/**
+		 * Constructor
+		 *
+		 * @param capacity The minimum number of items the queue can hold
+		 */
+		SPSCQueue(size_t capacity): _head(0), _tail(0) {
+			size_t size = 1;
+			while(size < capacity)
+				size <<= 1;
+			_slots.resize(size);
+			_mask = size - 1;
+		}
+
+		/**
+		 * Move an item into the queue, called by the producer only
+		 *
+		 * @param item The item to be queued. Its content is moved away on success
+		 * @return false if the queue is full
+		 */
+		bool tryPush(T& item) {
+			size_t tail = _tail.load(std::memory_order_relaxed);
+			if(tail - _head.load(std::memory_order_acquire) > _mask)
+				return false;
+			_slots[tail & _mask] = std::move(item);
+			_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * Move the oldest item out of the queue, called by the consumer only
+		 *
+		 * @param item Receives the item
+		 * @return false if the queue is empty
+		 */
+		bool tryPop(T& item) {
+			size_t head = _head.load(std::memory_order_relaxed);
+			if(head == _tail.load(std::memory_order_acquire))
+				return false;
+			item = std::move(_slots[head & _mask]);
+			_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+};
+
+/**
+ * @brief A viable tree waiting to be written
+ */
+struct PendingTree {
+	CompactTree tree; /**< the tree, with cluster ids referring to the output database */
+	TreeSummary summary; /**< its summary, the root is filled in by the writer */
+};
+
+/**
+ * @brief The writer thread owning the output database connection
+ *
+ * All clusters must already be archived in the output database (shared cluster
+ * mode), as the queued trees only refer to them by id. Writes are grouped into
+ * transactions, committed whenever the queue runs dry or a batch is full.
+ */
+class AsyncTreeWriter {
+	protected:
+		sqlite3 *_database; /**< the output connection, only used by the writer thread once started */
+		SQLiteBackend _backend; /**< the output connection as a backend, keeping its statements prepared */
+		bool _compactTrees; /**< write CompactTrees records instead of Subclones rows */
+		std::map<sqlite3_int64, EventCluster *> _clusters; /**< the archived clusters, by id */
+		SPSCQueue<PendingTree> _queue; /**< trees handed over by the enumeration */
+		std::atomic<bool> _closing; /**< set when no more trees will be submitted */
+		std::thread _thread; /**< the writer thread */
+		size_t _numStalls; /**< number of times the producer found the queue full */
+
+		/**
+		 * The body of the writer thread
+		 */
+		void run();
+
+		/**
+		 * Write one tree and its summary
+		 */
+		void writeTree(PendingTree& pending);
+
+	public:
+		static const size_t TransactionSize = 256; /**< max number of trees per transaction */
+
+		/**
+		 * Constructor
+		 *
+		 * @param database The output database, in which the clusters have been archived
+		 * @param compactTrees Whether trees are written as CompactTrees records
+		 * @param clusters The archived clusters. They must outlive the writer and not be modified meanwhile
+		 * @param capacity The number of trees that can be queued before submit blocks
+		 */
+		AsyncTreeWriter(sqlite3 *database, bool compactTrees, std::vector<EventCluster>& clusters, size_t capacity = 1024);
+
+		/**
+		 * Destructor, flushes the queue if close has not been called
+		 */
+		~AsyncTreeWriter() {close();}
+
+		/**
+		 * Start the writer thread
+		 */
+		void start();
+
+		/**
+		 * Queue a tree for writing, waiting for room if the queue is full
+		 *
+		 * @param pending The tree to be written. Its content is moved away
+		 */
+		void submit(PendingTree& pending);
+
+		/**
+		 * Write everything still queued, then stop the writer thread
+		 */
+		void close();
+
+		/**
+		 * The number of times submit had to wait for the writer
+		 *
+		 * @return the stall count
+		 */
+		size_t numStalls() const {return _numStalls;}
+};
+
+#endif
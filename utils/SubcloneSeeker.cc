@@ -29,104 +29,257 @@ THE SOFTWARE.
 #include <algorithm>
 #include <numeric>
 #include <cmath>
+#include <cstdlib>
+#include <getopt.h>
+#include <csignal>
+#include <ctime>
 
 #include "EventCluster.h"
 #include "Subclone.h"
 #include "SegmentalMutation.h"
-
-#define EPISLON (0.01)
+#include "CompactTree.h"
+#include "TreeSummary.h"
+#include "AsyncTreeWriter.h"
+#include "DBConnection.h"
+#include "StorageBackend.h"
+#include "SQLiteBackend.h"
+#include "ShardSpec.h"
+#include "EventRegionIndex.h"
+#include "TreeEnumerator.h"
+#include "CohortDB.h"
 
 sqlite3 *res_database;
+StorageBackend *res_backend;
 
 static int _num_solutions;
 static std::vector<int> _tree_depth;
+static bool _share_clusters;
+static bool _compact_trees;
+static AsyncTreeWriter *_writer;
+static time_t _deadline;
+static volatile sig_atomic_t _stop_enumeration;
+
+// Sharding, see TreeEnumerator::setShard
+static ShardSpec _shard;
+
+/**
+ * Stop the enumeration on interruption, so that the trees found so far are flushed
+ */
+extern "C" void stopEnumeration(int) {
+	_stop_enumeration = 1;
+}
 
 using namespace SubcloneSeeker;
 
-int treeDepth(TreeNode *root) {
-	if(root->isLeaf())
-		return 1;
-
-	int max_subtree_depth = 0;
-	for(size_t i=0; i<root->getVecChildren().size(); i++) {
-		int subtree_depth = treeDepth(root->getVecChildren()[i]);
-		if(subtree_depth > max_subtree_depth)
-			max_subtree_depth = subtree_depth;
-	}
-	return 1+max_subtree_depth;
+void TreeOutput(Subclone * root, bool viable);
+
+void usage(const char *progName) {
+	std::cerr<<"Usage: "<<progName<<" [Options] <cluster-archive-sqlite-db> [output-db]"<<std::endl;
+	std::cerr<<"Options:"<<std::endl;
+	std::cerr<<"\t-s\t\t\tStore clusters and events once, shared by all trees"<<std::endl;
+	std::cerr<<"\t-c\t\t\tStore each tree as one compact parent-vector record (implies -s)"<<std::endl;
+	std::cerr<<"\t-a\t\t\tWrite trees from a separate thread while enumerating (implies -s)"<<std::endl;
+	std::cerr<<"\t-T <seconds>\t\tStop enumerating after the given time, keeping the trees found so far"<<std::endl;
+	std::cerr<<"\t-P <profile>\t\tConnection profile: default, bulk-write or read-analysis"<<std::endl;
+	std::cerr<<"\t-S <backend>\t\tStorage of the output: sqlite, or file for a binary archive (no -s, -c or -a)"<<std::endl;
+	std::cerr<<"\t-R\t\t\tIndex the genomic region of the output events, for treeprint -q"<<std::endl;
+	std::cerr<<"\t-k <sample>\t\tRead the clusters of, and write the trees as, a sample of cohort databases"<<std::endl;
+	std::cerr<<"\t--shard <i/N>\t\tOnly enumerate the i-th of N slices of the trees (0 <= i < N), see treedb-merge"<<std::endl;
+	std::cerr<<"\t-h\t\t\tPrint this message"<<std::endl;
+	exit(0);
 }
 
-void TreeEnumeration(Subclone * root, std::vector<EventCluster> vecClusters, size_t symIdx);
-void TreeAssessment(Subclone * root, std::vector<EventCluster> vecClusters);
-
 int main(int argc, char* argv[])
 {
+	char *progName = argv[0];
+	_share_clusters = false;
+	_compact_trees = false;
+	bool asyncWriter = false;
+	bool regionIndex = false;
+	const char *sample = NULL;
+	DBConnection::Profile profile = DBConnection::PROFILE_DEFAULT;
+	StorageBackend::Kind outputKind = StorageBackend::KIND_SQLITE;
+
+	enum {OPT_SHARD = 256};
+	static struct option longOptions[] = {
+		{"shard", required_argument, NULL, OPT_SHARD},
+		{NULL, 0, NULL, 0}
+	};
 
-	if(argc < 2) {
-		std::cerr<<"Usage: "<<argv[0]<<" <cluster-archive-sqlite-db> [output-db]"<<std::endl;
-		return(0);
+	int c;
+	while((c = getopt_long(argc, argv, "scaT:P:S:Rk:h", longOptions, NULL)) != -1) {
+		switch(c) {
+			case 's':
+				_share_clusters = true; break;
+			case 'c':
+				_compact_trees = true;
+				_share_clusters = true;
+				break;
+			case 'a':
+				asyncWriter = true;
+				_share_clusters = true;
+				break;
+			case 'T':
+				_deadline = time(NULL) + atoi(optarg);
+				break;
+			case 'P':
+				if(!DBConnection::profileFromName(optarg, profile)) {
+					std::cerr<<"Unknown connection profile "<<optarg<<std::endl;
+					usage(progName);
+				}
+				break;
+			case 'S':
+				// a memory backend would be discarded on exit
+				if(!StorageBackend::kindFromName(optarg, outputKind) || outputKind == StorageBackend::KIND_MEMORY) {
+					std::cerr<<"Unknown storage backend "<<optarg<<std::endl;
+					usage(progName);
+				}
+				break;
+			case 'R':
+				regionIndex = true; break;
+			case 'k':
+				sample = optarg; break;
+			case OPT_SHARD:
+				if(!_shard.parse(optarg)) {
+					std::cerr<<"Invalid shard "<<optarg<<std::endl;
+					usage(progName);
+				}
+				break;
+			case 'h':
+				usage(progName); break;
+			default:
+				std::cerr<<"Unrecognized option "<<(char)c<<std::endl;
+				usage(progName);
+				break;
+		}
+	}
+
+	argc -= optind; argv += optind;
+
+	if(argc < 1) {
+		usage(progName);
+	}
+
+	// shared clusters, compact trees and region indices rely on sqlite3 tables
+	if(outputKind != StorageBackend::KIND_SQLITE && (_share_clusters || regionIndex)) {
+		std::cerr<<"Options -s, -c, -a and -R require the sqlite backend"<<std::endl;
+		usage(progName);
+	}
+
+	if(sample != NULL && (outputKind != StorageBackend::KIND_SQLITE || regionIndex)) {
+		std::cerr<<"Option -k requires the sqlite backend, and cannot be combined with -R"<<std::endl;
+		usage(progName);
 	}
 
 	res_database=NULL;
+	res_backend=NULL;
+
+	// the input may be a sqlite3 database or a binary archive
+	StorageBackend *input = StorageBackend::open(argv[0], StorageBackend::kindOfFile(argv[0]), true, profile);
+	if(input == NULL) {
+		std::cerr<<"Unable to open database "<<argv[0]<<std::endl;
+		return(1);
+	}
 
-	sqlite3 *database;
-	int rc;
-	rc = sqlite3_open_v2(argv[1], &database, SQLITE_OPEN_READONLY, NULL);
-	if(rc != SQLITE_OK) {
-		std::cerr<<"Unable to open database "<<argv[1]<<std::endl;
+	// the clusters may come from a database of their own, or from a cohort
+	SQLiteBackend *sqliteInput = dynamic_cast<SQLiteBackend *>(input);
+	if(sample != NULL && sqliteInput != NULL && CohortDB::isCohort(sqliteInput->database()) &&
+			!CohortDB::enterSample(sqliteInput->database(), sample)) {
+		std::cerr<<"Sample "<<sample<<" not found in "<<argv[0]<<std::endl;
 		return(1);
 	}
 
 	// load mutation clusters
 	EventCluster dummyCluster;
-	std::vector<sqlite3_int64> clusterIDs = dummyCluster.vecAllObjectsID(database);
+	std::vector<sqlite3_int64> clusterIDs = dummyCluster.vecAllObjectsID(*input);
 
 	if(clusterIDs.size() == 0) {
 		std::cerr<<"Event cluster list is empty!"<<std::endl;
 		return(1);
 	}
 
-	std::vector<EventCluster> vecClusters;
-	for(size_t i=0; i<clusterIDs.size(); i++) {
-		EventCluster newCluster;
-		newCluster.unarchiveObjectFromDB(database, clusterIDs[i]);
-
-		// load CNV events
-		CNV dummyCNV;
-		DBObjectID_vec memberCNV_IDs = dummyCNV.allObjectsOfCluster(database, newCluster.getId());
-		for(size_t j=0; j<memberCNV_IDs.size(); j++) {
-			CNV *newCNV = new CNV();
-			newCNV->unarchiveObjectFromDB(database, memberCNV_IDs[j]);
-			newCluster.addEvent(newCNV, false);
-		}
-
-		vecClusters.push_back(newCluster);
-	}
+	// load the clusters together with all their member events. The events are
+	// shared by every enumerated tree, and released with the arena at the end
+	ObjectArena loadArena;
+	EventClusterPtr_vec loadedClusters = EventCluster::unarchiveClustersWithMembers(*input, clusterIDs, &loadArena);
 
-	sqlite3_close(database);
+	std::vector<EventCluster> vecClusters;
+	for(size_t i=0; i<loadedClusters.size(); i++)
+		vecClusters.push_back(*loadedClusters[i]);
 
-	std::sort(vecClusters.begin(), vecClusters.end());
-	std::reverse(vecClusters.begin(), vecClusters.end());
+	delete input;
 
-	// Mutation list read. Start to enumerate trees
-	// 1. Create a node contains no mutation (symId = 0).
-	// this node will act as the root of the trees
-	Subclone *root = new Subclone();
-	root->setFraction(-1);
-	root->setTreeFraction(-1);
+	TreeEnumerator::sortForPlacement(vecClusters);
 
 	if(argc >= 2) {
-		int rc = sqlite3_open(argv[2], &res_database);
-		if(rc != SQLITE_OK ) {
+		res_backend = StorageBackend::open(argv[1], outputKind, false, profile);
+		if(res_backend == NULL) {
 			std::cerr<<"Unable to open result database for writting."<<std::endl;
 			return(1);
 		}
+
+		SQLiteBackend *sqliteBackend = dynamic_cast<SQLiteBackend *>(res_backend);
+		if(sqliteBackend != NULL)
+			res_database = sqliteBackend->database();
+
+		if(sample != NULL && !CohortDB::enterSample(res_database, sample)) {
+			std::cerr<<"Unable to write sample "<<sample<<" into a cohort database"<<std::endl;
+			return(1);
+		}
+
+		// In shared mode, write every cluster and its events once, up front. The
+		// clusters keep their new ids, so that the trees only link to them.
+		if(_share_clusters) {
+			Subclone::createClusterLinkTableInDB(res_database);
+			for(size_t i=0; i<vecClusters.size(); i++) {
+				vecClusters[i].setId(0);
+				vecClusters[i].setSubcloneID(0);
+				sqlite3_int64 newClusterID = vecClusters[i].archiveObject(*res_backend);
+				for(EventCluster::member_iterator it = vecClusters[i].beginMembers(); it != vecClusters[i].endMembers(); it++) {
+					(*it)->setId(0);
+					(*it)->setClusterID(newClusterID);
+					(*it)->archiveObject(*res_backend);
+				}
+			}
+		}
 	}
 	
-	TreeEnumeration(root, vecClusters, 0);	
+	// the writer thread owns the output connection until it is closed
+	if(res_database != NULL && asyncWriter) {
+		_writer = new AsyncTreeWriter(res_database, _compact_trees, vecClusters);
+		_writer->start();
+	}
+
+	signal(SIGINT, stopEnumeration);
+	signal(SIGTERM, stopEnumeration);
+
+	// Mutation list read. Start to enumerate trees, built from the clusters as
+	// they are now, with the ids of the shared mode
+	TreeEnumerator enumerator(vecClusters);
+	if(_shard.isSharded())
+		enumerator.setShard(_shard);
+
+	while(!_stop_enumeration && enumerator.next()) {
+		TreeOutput(enumerator.root(), enumerator.isViable());
+		if(_deadline != 0 && time(NULL) >= _deadline)
+			_stop_enumeration = 1;
+	}
 
-	if(res_database != NULL) 
-		sqlite3_close(res_database);
+	if(_stop_enumeration)
+		std::cerr<<"Enumeration stopped early, keeping the trees found so far"<<std::endl;
+
+	if(_writer != NULL) {
+		_writer->close();
+		if(_writer->numStalls() > 0)
+			std::cerr<<"Enumeration waited for the writer "<<_writer->numStalls()<<" times"<<std::endl;
+		delete _writer;
+	}
+
+	if(res_database != NULL && regionIndex && !EventRegionIndex::create(res_database))
+		std::cerr<<"Unable to index the event regions of the result database"<<std::endl;
+
+	// closes the output database, or saves the archive
+	delete res_backend;
 
 	if(_tree_depth.size()> 0)
 		std::cout<<_num_solutions<<"\t"<<std::accumulate(_tree_depth.begin(), _tree_depth.end(), 0)/float(_tree_depth.size())<<std::endl;
@@ -156,181 +309,48 @@ class TreePrintTraverser: public TreeTraverseDelegate {
 		}
 };
 
-// This function will recursively construct all possible tree structures
-// using the given mutation list, starting with the mutation identified by symIdx
-//
-// The idea behind this is quite simple. If a node is not the last symbol on the 
-// mutation list, it will try to add this particular node to every other existing
-// node's children list. After one addition, the traverser calls the TreeEnumeration
-// again but with a incremented symIdx, so that the next symbol can be treated in the
-// same way. When the last symbol has been reached, the tree is printed out, in both
-// Pre-Order and Post-Order, by the TreePrintTraverser class, so that each tree can be 
-// uniquely identified.
-
-void TreeEnumeration(Subclone * root, std::vector<EventCluster> vecClusters, size_t symIdx)
-{	
-	// Tree Enum Traverser. It will check if the last symbol has been
-	// treated or not. If yes, the tree is complete and it will call
-	// TreeAssessment to assess the viability of the tree; If no, it 
-	// will add the current untreated symbol as a children to the node 
-	// that is given to it, and call TreeEnumeration again to go into 
-	// one more level of the recursion.
-	class TreeEnumTraverser : public TreeTraverseDelegate {
-	protected:
-		// Some state variables that the TreeEnumeration
-		// function needs to expose to the traverser
-		std::vector<EventCluster>& _vecClusters;
-		size_t _symIdx;
-		Subclone *_floatNode;
-		Subclone *_root;
-		
-	public:
-		
-		TreeEnumTraverser(std::vector<EventCluster>& vecClusters,
-						  size_t symIdx,
-						  Subclone *floatNode,
-						  Subclone *root):
-						_vecClusters(vecClusters), _symIdx(symIdx), 
-						_floatNode(floatNode), _root(root) {;}
-								
-		
-		virtual void processNode(TreeNode * node) {
-			Subclone *clone = dynamic_cast<Subclone *>(node);
-			
-			// Add the floating node as the chilren of the current node
-			clone->addChild(_floatNode);
-			
-			// Move on to the next symbol
-			TreeEnumeration(_root, _vecClusters, _symIdx);
-			
-			// Remove the child
-			node->removeChild(_floatNode);
-		}
-	};
-
-	if(symIdx == vecClusters.size()) {
-		TreeAssessment(root, vecClusters);
-		return;
-	}
-
-	// Create the new tree node
-	Subclone *newClone = new Subclone();
-	newClone->setFraction(-1);
-	newClone->setTreeFraction(-1);
-	newClone->addEventCluster(&vecClusters[symIdx]);
-
-	// add more cluster into the same subclone if they share
-	// the same frequency. This is unlikely to happen if
-	// the clusters are generated from a clustering algorithm
-	// run on the raw data. But when using external dataset this
-	// could be possible
-	float currentFraction = vecClusters[symIdx].cellFraction();
-	symIdx++;
-
-	while(symIdx < vecClusters.size() && 
-			fabs(vecClusters[symIdx].cellFraction() - currentFraction) < EPISLON) {
-		newClone->addEventCluster(&vecClusters[symIdx]);
-		symIdx++;
-	}
-
-	// Configure the tree traverser
-	TreeEnumTraverser TreeEnumTraverserObj(vecClusters, symIdx, newClone, root);
-	
-	// Traverse the tree
-	TreeNode::PreOrderTraverse(root, TreeEnumTraverserObj);
-	
-	delete newClone;
-}
-
-void TreeAssessment(Subclone * root, std::vector<EventCluster> vecClusters)
+// Report a complete tree, assessed by the TreeEnumerator, and save it if it is viable
+void TreeOutput(Subclone * root, bool viable)
 {
-	class FracAsnTraverser : public TreeTraverseDelegate {
-	protected:
-		std::vector<EventCluster>& _vecClusters;
-		
-	public:
-		FracAsnTraverser(std::vector<EventCluster>& vecClusters): _vecClusters(vecClusters) {;}
-		virtual void processNode(TreeNode * node) {
+	if(viable) {
+		TreePrintTraverser printTraverser;
+		std::cerr<<"Viable Tree! Pre-Orer: ";
+		TreeNode::PreOrderTraverse(root, printTraverser);
+		std::cerr<<std::endl;
 
-			Subclone *clone = dynamic_cast<Subclone *>(node);
+		TreeSummary summary;
+		summary.summarize(root);
 
-			if(node->isLeaf()) {
-				// direct assign
-				((Subclone *)node)->setFraction(((Subclone *)node)->vecEventCluster()[0]->cellFraction());
-				((Subclone *)node)->setTreeFraction(((Subclone *)node)->vecEventCluster()[0]->cellFraction());
+		// save tree to database, together with its summary
+		if(_writer != NULL) {
+			PendingTree pending;
+			pending.tree.encodeTree(root);
+			pending.summary = summary;
+			_writer->submit(pending);
+		}
+		else if(res_backend != NULL) {
+			if(_compact_trees) {
+				CompactTree compactTree;
+				compactTree.encodeTree(root);
+				summary.setRoot(compactTree.archiveObject(*res_backend), TreeSummary::ENCODING_COMPACT);
 			}
 			else {
-				// intermediate node. assign it's mutation fraction - subtree_fraction
-				// actually, if it's root, assign 1
-				if(clone->isRoot()) 
-					clone->setTreeFraction(1);
-				else 
-					clone->setTreeFraction(clone->vecEventCluster()[0]->cellFraction());
-				
-				assert(clone->treeFraction() >= -EPISLON && clone->treeFraction() <= 1 + EPISLON);
-							
-				double childrenFraction = 0;
-				for(size_t i=0; i<node->getVecChildren().size(); i++) 
-					childrenFraction += ((Subclone *)node->getVecChildren()[i])->treeFraction();
-									
-				double nodeFraction = ((Subclone *)node)->treeFraction() - childrenFraction;
-
-				if(nodeFraction < EPISLON && nodeFraction > -EPISLON)
-					nodeFraction = 0;
-				
-				// check tree viability
-				if(nodeFraction < -EPISLON) {
-					terminate();
+				// the shared mode links clusters through a sqlite3 join table
+				if(_share_clusters) {
+					SubcloneSaveTreeTraverser stt(res_database, true);
+					TreeNode::PreOrderTraverse(root, stt);
 				}
 				else {
-					((Subclone *)node)->setFraction(nodeFraction);
-					assert(((Subclone *)node)->fraction() >= -EPISLON && ((Subclone *)node)->fraction() <= 1+EPISLON);
+					SubcloneSaveTreeTraverser stt(*res_backend);
+					TreeNode::PreOrderTraverse(root, stt);
 				}
+				summary.setRoot(root->getId(), TreeSummary::ENCODING_SUBCLONES);
 			}
-		}
-	};
-	
-	// Fraction Reset Traverser. This will go through the nodes and
-	// reset the fraction to uninitialized state so that the same nodes
-	// can be used for another structure's evaluation
-	class NodeResetTraverser : public TreeTraverseDelegate {
-	public:
-		virtual void processNode(TreeNode * node) {
-			((Subclone *)node)->setFraction(-1);
-			((Subclone *)node)->setTreeFraction(-1);
-			((Subclone *)node)->setParentId(0);
-			((Subclone *)node)->setId(0);
-
-		}
-	};
-		
-	// check if the root is sane
-	if(root == NULL)
-		return;
-
-	// reset node and tree fractions
-	NodeResetTraverser nrTraverser;
-	TreeNode::PreOrderTraverse(root, nrTraverser);
-
-	// calcuate tree fractions
-	FracAsnTraverser fracTraverser(vecClusters);
-	TreeNode::PostOrderTraverse(root, fracTraverser);
-	
-	// if the tree is viable, output it
-	if(root->fraction() >= -EPISLON) {
-		TreePrintTraverser printTraverser;
-		std::cerr<<"Viable Tree! Pre-Orer: ";
-		TreeNode::PreOrderTraverse(root, printTraverser);
-		std::cerr<<std::endl;
-
-		// save tree to database
-		if(res_database != NULL) {
-			SubcloneSaveTreeTraverser stt(res_database);
-			TreeNode::PreOrderTraverse(root, stt);
+			summary.archiveObject(*res_backend);
 		}
 
 		_num_solutions++;
-		_tree_depth.push_back(treeDepth(root));
+		_tree_depth.push_back(summary.depth());
 	}
 	else
 	{
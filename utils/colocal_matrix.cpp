@@ -7,6 +7,7 @@
 #include "EventCluster.h"
 #include "SomaticEvent.h"
 #include "Subclone.h"
+#include "TreeSetFile.h"
 
 using namespace std;
 using namespace SubcloneSeeker;
@@ -89,32 +90,75 @@ class CoexistanceTraverseDelegate : public TreeTraverseDelegate {
 int main(int argc, char* argv[])
 {
 	if(argc<2) {
-		cout<<"Usage: "<<argv[0]<<" <subclone-sqlite-db>"<<endl;
+		cout<<"Usage: "<<argv[0]<<" <subclone-sqlite-db or tree-set file>"<<endl;
 		exit(0);
 	}
 
-	// Open database connection
-	sqlite3 *dbh;
-	if(sqlite3_open_v2(argv[1], &dbh, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
-		cerr<<"Unable to open database file "<<argv[1]<<endl;
-		exit(1);
+	// Open database connection, or map the tree-set file
+	sqlite3 *dbh = NULL;
+	TreeSetFile treeSet;
+
+	if(TreeSetFile::isTreeSetFile(argv[1])) {
+		if(!treeSet.open(argv[1])) {
+			cerr<<"Unable to open tree-set file "<<argv[1]<<endl;
+			exit(1);
+		}
+	}
+	else {
+		if(sqlite3_open_v2(argv[1], &dbh, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
+			cerr<<"Unable to open database file "<<argv[1]<<endl;
+			exit(1);
+		}
 	}
 
 	CoexistanceTraverseDelegate ctd;
-	SubcloneLoadTreeTraverser loadTraverser(dbh);
-
-	DBObjectID_vec rootIDs = SubcloneLoadTreeTraverser::rootNodes(dbh);
-
-	cout<<rootIDs.size()<<endl;
-
-	DBObjectID_vec::const_iterator it;
-	for(it = rootIDs.begin(); it != rootIDs.end(); it++) {
-		Subclone *root = new Subclone();
-		assert(preceedingStack.size() == 0);
-		root->unarchiveObjectFromDB(dbh, *it);
-		TreeNode::PreOrderTraverse(root, loadTraverser);
-		TreeNode::PreOrderTraverse(root, ctd);
+	size_t numTrees = 0;
+
+	if(dbh == NULL) {
+		DBObjectID_vec rootIDs = treeSet.rootIDs();
+		DBObjectID_vec::const_iterator it;
+		for(it = rootIDs.begin(); it != rootIDs.end(); it++) {
+			assert(preceedingStack.size() == 0);
+			Subclone *root = treeSet.expandTree(*it);
+			TreeNode::PreOrderTraverse(root, ctd);
+
+			// the clusters belong to the tree-set file
+			SubcloneFreeTreeTraverser freeTraverser(false);
+			TreeNode::PostOrderTraverse(root, freeTraverser);
+			numTrees++;
+		}
+	}
+	else if(SubcloneLoadTreeTraverser::isCompactDB(dbh)) {
+		// each tree is one record, expanded on demand
+		DBObjectID_vec rootIDs = SubcloneLoadTreeTraverser::rootNodes(dbh);
+		for(size_t i=0; i<rootIDs.size(); i++) {
+			assert(preceedingStack.size() == 0);
+			Subclone *root = SubcloneLoadTreeTraverser::loadTree(dbh, rootIDs[i]);
+			if(root == NULL)
+				continue;
+			TreeNode::PreOrderTraverse(root, ctd);
+
+			SubcloneFreeTreeTraverser freeTraverser;
+			TreeNode::PostOrderTraverse(root, freeTraverser);
+			numTrees++;
+		}
 	}
+	else {
+		// stream the roots, holding one tree in memory at a time
+		ArchiveCursor<Subclone> cursor(dbh, "parentId IS NULL");
+		SubcloneLoadTreeTraverser loadTraverser(dbh);
+		for(Subclone *root = cursor.next(); root != NULL; root = cursor.next()) {
+			assert(preceedingStack.size() == 0);
+			TreeNode::PreOrderTraverse(root, loadTraverser);
+			TreeNode::PreOrderTraverse(root, ctd);
+
+			SubcloneFreeTreeTraverser freeTraverser;
+			TreeNode::PostOrderTraverse(root, freeTraverser);
+			numTrees++;
+		}
+	}
+
+	cout<<numTrees<<endl;
 
 	map< int, map<int, int> >::const_iterator it1;
 	map<int, int>::const_iterator it2;
@@ -125,5 +169,6 @@ int main(int argc, char* argv[])
 		}
 	}
 
-	sqlite3_close(dbh);
+	if(dbh != NULL)
+		sqlite3_close(dbh);
 }
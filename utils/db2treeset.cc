@@ -0,0 +1,112 @@
+/**
+ * @file db2treeset.cc
+ * Converts a subclone database, in either the row or the compact format,
+ * into a binary tree-set file that treeprint, treemerge and colocal_matrix
+ * can map directly.
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "Subclone.h"
+#include "TreeSetFile.h"
+#include "DBConnection.h"
+#include "CohortDB.h"
+#include <sqlite3/sqlite3.h>
+#include <iostream>
+#include <cstdlib>
+#include <getopt.h>
+
+using namespace SubcloneSeeker;
+
+void usage(const char *progName) {
+	std::cout<<"Usage: "<<progName<<" [Options] <subclone-sqlite-db> <tree-set file>"<<std::endl;
+	std::cout<<"Options:"<<std::endl;
+	std::cout<<"\t-P <profile>\t\tConnection profile: default, bulk-write or read-analysis"<<std::endl;
+	std::cout<<"\t-k <sample>\t\tOnly read the given sample of a cohort database"<<std::endl;
+	std::cout<<"\t-h\t\t\tPrint this message"<<std::endl;
+	exit(0);
+}
+
+int main(int argc, char* argv[]) {
+	char *progName = argv[0];
+	DBConnection::Profile profile = DBConnection::PROFILE_DEFAULT;
+	const char *sample = NULL;
+
+	int c;
+	while((c = getopt(argc, argv, "P:k:h")) != -1) {
+		switch(c) {
+			case 'P':
+				if(!DBConnection::profileFromName(optarg, profile)) {
+					std::cerr<<"Unknown connection profile "<<optarg<<std::endl;
+					usage(progName);
+				}
+				break;
+			case 'k':
+				sample = optarg;
+				break;
+			case 'h':
+			default:
+				usage(progName);
+				break;
+		}
+	}
+
+	argc -= optind; argv += optind;
+
+	if(argc < 2) {
+		usage(progName);
+	}
+
+	sqlite3 *database;
+	if(DBConnection::open(argv[0], &database, SQLITE_OPEN_READONLY, profile) != SQLITE_OK) {
+		std::cerr<<"Unable to open database "<<argv[0]<<std::endl;
+		return(1);
+	}
+
+	if(sample != NULL && !CohortDB::enterSample(database, sample)) {
+		std::cerr<<"Sample "<<sample<<" not found in "<<argv[0]<<std::endl;
+		return(1);
+	}
+
+	// trees stored in the compact format keep their record id as the tree id
+	std::vector<Subclone *> roots;
+	DBObjectID_vec rootIDs = SubcloneLoadTreeTraverser::rootNodes(database);
+	for(size_t i=0; i<rootIDs.size(); i++) {
+		Subclone *root = SubcloneLoadTreeTraverser::loadTree(database, rootIDs[i]);
+		if(root != NULL)
+			roots.push_back(root);
+	}
+
+	sqlite3_close(database);
+
+	if(!TreeSetFile::write(argv[1], roots)) {
+		std::cerr<<"Unable to write tree-set file "<<argv[1]<<std::endl;
+		return(1);
+	}
+
+	std::cerr<<roots.size()<<" trees written"<<std::endl;
+	return 0;
+}
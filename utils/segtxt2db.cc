@@ -39,6 +39,13 @@ THE SOFTWARE.
 #include "SomaticEvent.h"
 #include "SegmentalMutation.h"
 #include "EventCluster.h"
+#include "EventStore.h"
+#include "Dendrogram.h"
+#include "BootstrapStability.h"
+#include "DBConnection.h"
+#include "StorageBackend.h"
+#include "SQLiteBackend.h"
+#include "CohortDB.h"
 #include "RefGenome.h"
 
 #define _EPISLON 1e-3
@@ -57,9 +64,21 @@ static unsigned long _min_length;
 
 using namespace SubcloneSeeker;
 
+static DBConnection::Profile _profile;
+static StorageBackend::Kind _backend_kind;
+static const char *_sample;
+static EventCluster::ClusteringEngine _engine;
+static size_t _cluster_count;
+static bool _sweep_report;
+static size_t _bootstrap_replicates;
+static double _bootstrap_noise;
+static bool _recut;
+
 void SegmentalMeanCorrection(std::vector<EventCluster *>& clusters);
 void SegmentalMean2Frequency(std::vector<EventCluster *>& clusters);
 double SegmentalMeanModal(const EventClusterPtr_vec& clusters);
+void printSweep(const Dendrogram& dendrogram);
+int recutStoredDendrogram(const char *filename);
 void printClusters(std::vector<EventCluster *>& clusters)  {
 	for(size_t i=0; i<clusters.size(); i++) {
 		for(size_t j=0; j<clusters[i]->members().size(); j++) {
@@ -77,6 +96,7 @@ void printClusters(std::vector<EventCluster *>& clusters)  {
 
 void usage() {
 	std::cout<<"Usage: "<<_prog_name<<" <seg.txt file> <result database>"<<std::endl;
+	std::cout<<"       "<<_prog_name<<" -R [-t threshold | -K count] [-W] <result database>"<<std::endl;
 	std::cout<<"\t\t Options:"<<std::endl;
 	std::cout<<"\t\t -p purity\t[default = 1]\t\tA number between 0-1 specifying the purity of the sample"<<std::endl;
 	std::cout<<"\t\t -q ploidy\t[default = 2]\t\tA integer number specifying the ploidy of the copy number neutral regions"<<std::endl;
@@ -84,7 +104,16 @@ void usage() {
 	std::cout<<"\t\t -m \t\t\t\t\tFraction correction by modal value"<<std::endl;
 	std::cout<<"\t\t -r mask-file\t\t\t\tA mask file for regions to exclude"<<std::endl;
 	std::cout<<"\t\t -t threshold\t[default = 0.05]\tThe ratio threshold for merging two segments into a cluster"<<std::endl;
+	std::cout<<"\t\t -c engine\t[default=greedy]\tClustering of the segments: greedy, sweep for an order independent single pass, kmeans/gmm to choose the number of clusters by BIC, or hierarchical"<<std::endl;
+	std::cout<<"\t\t -K count\t\t\t\tCut the hierarchical clustering into count clusters instead of at the threshold"<<std::endl;
+	std::cout<<"\t\t -W \t\t\t\t\tReport the number of clusters at every threshold of the hierarchical clustering"<<std::endl;
+	std::cout<<"\t\t -R \t\t\t\t\tReport the clusters of the hierarchical clustering stored in the result database, cut again without reclustering"<<std::endl;
+	std::cout<<"\t\t --bootstrap B\t\t\t\tReport the support of each cluster over B reclustered resamples of the segments"<<std::endl;
+	std::cout<<"\t\t --perturb sd\t\t\t\tBootstrap by adding noise of the given deviation to the ratios instead of resampling"<<std::endl;
 	std::cout<<"\t\t -e length\t[default=0]\tThe minimal cumulative length of a cluster to be included in the result"<<std::endl;
+	std::cout<<"\t\t -P profile\t[default=default]\tConnection profile of the result database: default or bulk-write"<<std::endl;
+	std::cout<<"\t\t -S backend\t[default=sqlite]\tStorage of the result: sqlite, or file for a binary archive"<<std::endl;
+	std::cout<<"\t\t -k sample\t\t\t\tWrite the result as the given sample of a cohort database"<<std::endl;
 	exit(0);
 }
 
@@ -97,9 +126,25 @@ int main(int argc, char* argv[]) {
 	_threshold = 0.05;
 	_mask_fn=NULL;
 	_min_length = 0;
+	_profile = DBConnection::PROFILE_DEFAULT;
+	_backend_kind = StorageBackend::KIND_SQLITE;
+	_sample = NULL;
+	_engine = EventCluster::CLUSTERING_GREEDY;
+	_cluster_count = 0;
+	_sweep_report = false;
+	_bootstrap_replicates = 0;
+	_bootstrap_noise = 0;
+	_recut = false;
+
+	enum {OPT_BOOTSTRAP = 256, OPT_PERTURB};
+	static struct option longOptions[] = {
+		{"bootstrap", required_argument, NULL, OPT_BOOTSTRAP},
+		{"perturb", required_argument, NULL, OPT_PERTURB},
+		{NULL, 0, NULL, 0}
+	};
 
 	int c;
-	while((c = getopt(argc, argv, "p:q:n:mr:t:e:h")) != -1) {
+	while((c = getopt_long(argc, argv, "p:q:n:mr:t:c:K:WRe:P:S:k:h", longOptions, NULL)) != -1) {
 		switch(c) {
 			case 'p':
 				_purity = atof(optarg); break;
@@ -113,8 +158,39 @@ int main(int argc, char* argv[]) {
 				_mask_fn = strdup(optarg); break;
 			case 't':
 				_threshold = atof(optarg); break;
+			case 'c':
+				if(!EventCluster::clusteringEngineFromName(optarg, _engine)) {
+					std::cerr<<"Unknown clustering engine "<<optarg<<std::endl;
+					usage();
+				}
+				break;
+			case 'K':
+				_cluster_count = atoi(optarg); break;
+			case 'W':
+				_sweep_report = true; break;
+			case 'R':
+				_recut = true; break;
 			case 'e':
 				_min_length = atoi(optarg); break;
+			case 'P':
+				if(!DBConnection::profileFromName(optarg, _profile)) {
+					std::cerr<<"Unknown connection profile "<<optarg<<std::endl;
+					usage();
+				}
+				break;
+			case 'S':
+				// a memory backend would be discarded on exit
+				if(!StorageBackend::kindFromName(optarg, _backend_kind) || _backend_kind == StorageBackend::KIND_MEMORY) {
+					std::cerr<<"Unknown storage backend "<<optarg<<std::endl;
+					usage();
+				}
+				break;
+			case 'k':
+				_sample = optarg; break;
+			case OPT_BOOTSTRAP:
+				_bootstrap_replicates = atoi(optarg); break;
+			case OPT_PERTURB:
+				_bootstrap_noise = atof(optarg); break;
 			default:
 				std::cerr<<"Unrecognized option "<<(char)c<<std::endl;
 				usage();
@@ -124,14 +200,25 @@ int main(int argc, char* argv[]) {
 
 	argc -= optind; argv += optind;
 
+	if(_recut) {
+		if(argc < 1)
+			usage();
+		return recutStoredDendrogram(*argv);
+	}
+
+	// both cut a dendrogram
+	if(_cluster_count > 0 || _sweep_report)
+		_engine = EventCluster::CLUSTERING_HIERARCHICAL;
+
 	if(argc < 2) {
 		usage();
 	}
 
 	RefGenome *refGenome = RefGenome::getInstance();
 
-	// open mask file if supplied
-	SomaticEventPtr_vec maskEvents;
+	// open mask file if supplied; the masked regions are kept sorted by position
+	// so that each segment is checked with a binary search
+	EventStore maskEvents;
 
 	if(_mask_fn != NULL) {
 		std::ifstream in_mask_file;
@@ -146,14 +233,10 @@ int main(int argc, char* argv[]) {
 
 		in_mask_file >> chrom >> startLoc >> endLoc;
 		while(!in_mask_file.eof()) {
-			CNV *cnv = new CNV();
-			cnv->range.chrom = refGenome->queryChromID(chrom);
-			cnv->range.position = startLoc;
-			cnv->range.length = endLoc - startLoc;
-
-			maskEvents.push_back(cnv);
+			maskEvents.append(SomaticEvent::KIND_CNV, refGenome->queryChromID(chrom), startLoc, endLoc - startLoc, 0);
 			in_mask_file >> chrom >> startLoc >> endLoc;
 		}
+		maskEvents.sortByPosition();
 
 		in_mask_file.close();
 	}
@@ -184,24 +267,18 @@ int main(int argc, char* argv[]) {
 			break;
 
 		segMean = pow(2, segMean);
+
+		int chromID = refGenome->queryChromID(chrom);
+		if(maskEvents.overlapsAny(chromID, startLoc, endLoc - startLoc))
+			continue;
 		
 		CNV *cnv = new CNV();
-		cnv->range.chrom = refGenome->queryChromID(chrom);
+		cnv->range.chrom = chromID;
 		cnv->range.position = startLoc;
 		cnv->range.length = endLoc - startLoc;
 		cnv->frequency = segMean;
 
-		bool masked = false;
-		for(size_t i=0; i<maskEvents.size(); i++) {
-			CNV *otherEvent = dynamic_cast<CNV*>(maskEvents[i]);
-			if(otherEvent == NULL) continue;
-			if(otherEvent->range.overlaps(cnv->range)) {
-				masked = true;
-				break;
-			}
-		}
-
-		if(not masked) events.push_back(cnv);
+		events.push_back(cnv);
 	}
 	in_segtxt_file.close();
 
@@ -209,16 +286,64 @@ int main(int argc, char* argv[]) {
 	// Open output database
 	// ********************
 
-	sqlite3 *database;
-	if(sqlite3_open(*argv, &database) != SQLITE_OK) {
+	StorageBackend *backend = StorageBackend::open(*argv, _backend_kind, false, _profile);
+	if(backend == NULL) {
 		std::cerr<<"Unable to open database for writing result"<<std::endl;
 		return(1);
 	}
 
+	if(_sample != NULL) {
+		SQLiteBackend *sqliteBackend = dynamic_cast<SQLiteBackend *>(backend);
+		if(sqliteBackend == NULL || !CohortDB::enterSample(sqliteBackend->database(), _sample)) {
+			std::cerr<<"Unable to write sample "<<_sample<<" into a cohort database"<<std::endl;
+			return(1);
+		}
+	}
+
 	// *******************************
 	// Cluster the CNVs based on ratio
 	// *******************************
-	std::vector<EventCluster *> clusters = EventCluster::clustering(events, _threshold);
+	std::vector<EventCluster *> clusters;
+	Dendrogram dendrogram;
+	if(_engine == EventCluster::CLUSTERING_HIERARCHICAL) {
+		// the dendrogram is built once, and kept in the result for later cuts
+		dendrogram.build(events);
+
+		if(_sweep_report)
+			printSweep(dendrogram);
+
+		if(_cluster_count > 0)
+			clusters = dendrogram.cutToCount(_cluster_count);
+		else
+			clusters = dendrogram.cut(_threshold);
+	}
+	else
+		clusters = EventCluster::clustering(events, _threshold, _engine);
+
+	if(_bootstrap_replicates > 0) {
+		BootstrapStability stability(clusters, _threshold, _engine);
+		// the replicates are cut the way the reference was
+		stability.setClusterCount(_cluster_count);
+		if(_bootstrap_noise > 0)
+			stability.setResampling(BootstrapStability::PERTURB_FREQUENCIES, _bootstrap_noise);
+		stability.run(_bootstrap_replicates);
+
+		std::cout<<"Bootstrap support over "<<stability.replicates()<<" replicates"<<std::endl;
+		std::cout<<"Cluster\tMembers\tSupport"<<std::endl;
+		for(size_t i=0; i<clusters.size(); i++)
+			std::cout<<i<<"\t"<<clusters[i]->memberCount()<<"\t"<<stability.support(i)<<std::endl;
+
+		std::cout<<"Co-clustering";
+		for(size_t j=0; j<clusters.size(); j++)
+			std::cout<<"\t"<<j;
+		std::cout<<std::endl;
+		for(size_t i=0; i<clusters.size(); i++) {
+			std::cout<<i;
+			for(size_t j=0; j<clusters.size(); j++)
+				std::cout<<"\t"<<stability.coClustering(i, j);
+			std::cout<<std::endl;
+		}
+	}
 
 	// ************************************************
 	// Correct the clusters by purity and neutral level
@@ -257,20 +382,106 @@ int main(int argc, char* argv[]) {
 			continue;
 		}
 
-		sqlite3_int64 newClusterID = clusters[i]->archiveObjectToDB(database);
+		sqlite3_int64 newClusterID = clusters[i]->archiveObject(*backend);
 		if(newClusterID == -1) {
 			std::cerr<<"Error occurred while writing cluster "<<i<<" into database"<<std::endl;
 		}
 		for(size_t j=0; j<clusters[i]->members().size(); j++) {
 			clusters[i]->members()[j]->setClusterID(newClusterID);
-			clusters[i]->members()[j]->archiveObjectToDB(database);
+			clusters[i]->members()[j]->archiveObject(*backend);
 		}
 	}
 
-	sqlite3_close(database);
+	// the dendrogram refers to its leaves by id, so the segments dropped above are
+	// kept too, without a cluster; a result holds a single dendrogram
+	if(_engine == EventCluster::CLUSTERING_HIERARCHICAL) {
+		for(size_t i=0; i<events.size(); i++)
+			if(events[i]->getId() == 0)
+				events[i]->archiveObject(*backend);
+
+		DBObjectID_vec storedIDs = dendrogram.vecAllObjectsID(*backend);
+		if(!storedIDs.empty())
+			dendrogram.setId(storedIDs.back());
+		if(dendrogram.archiveObject(*backend) < 0)
+			std::cerr<<"Error occurred while writing the dendrogram into database"<<std::endl;
+	}
+
+	delete backend;
 	return(0);
 }
 
+void printSweep(const Dendrogram& dendrogram) {
+	std::vector<double> thresholds;
+	std::vector<size_t> counts;
+	dendrogram.sweep(thresholds, counts);
+	std::cout<<"Threshold\tClusters"<<std::endl;
+	for(size_t i=0; i<thresholds.size(); i++)
+		std::cout<<thresholds[i]<<"\t"<<counts[i]<<std::endl;
+}
+
+int recutStoredDendrogram(const char *filename) {
+	StorageBackend *backend = StorageBackend::open(filename, _backend_kind, _sample == NULL, _profile);
+	if(backend == NULL) {
+		std::cerr<<"Unable to open database "<<filename<<std::endl;
+		return(1);
+	}
+
+	if(_sample != NULL) {
+		SQLiteBackend *sqliteBackend = dynamic_cast<SQLiteBackend *>(backend);
+		if(sqliteBackend == NULL || !CohortDB::enterSample(sqliteBackend->database(), _sample)) {
+			std::cerr<<"Unable to read sample "<<_sample<<" of a cohort database"<<std::endl;
+			delete backend;
+			return(1);
+		}
+	}
+
+	Dendrogram dendrogram;
+	DBObjectID_vec storedIDs = dendrogram.vecAllObjectsID(*backend);
+	if(storedIDs.empty() || !dendrogram.unarchiveObject(*backend, storedIDs.back())) {
+		std::cerr<<"No hierarchical clustering stored in "<<filename<<std::endl;
+		delete backend;
+		return(1);
+	}
+
+	// the leaves are the segments as stored, clustered or not
+	std::vector<SomaticEvent *> events;
+	const DBObjectID_vec& leafIDs = dendrogram.leafIDs();
+	for(size_t i=0; i<leafIDs.size(); i++) {
+		CNV *cnv = new CNV();
+		if(cnv->unarchiveObject(*backend, leafIDs[i]))
+			events.push_back(cnv);
+		else
+			delete cnv;
+	}
+	delete backend;
+
+	int rc = 0;
+	if(!dendrogram.attachLeaves(events)) {
+		std::cerr<<"The segments of the stored hierarchical clustering are missing from "<<filename<<std::endl;
+		rc = 1;
+	}
+	else {
+		if(_sweep_report)
+			printSweep(dendrogram);
+
+		std::vector<EventCluster *> clusters;
+		if(_cluster_count > 0)
+			clusters = dendrogram.cutToCount(_cluster_count);
+		else
+			clusters = dendrogram.cut(_threshold);
+
+		std::cout<<"Cluster\tMembers\tRatio"<<std::endl;
+		for(size_t i=0; i<clusters.size(); i++) {
+			std::cout<<i<<"\t"<<clusters[i]->memberCount()<<"\t"<<clusters[i]->cellFraction()<<std::endl;
+			delete clusters[i];
+		}
+	}
+
+	for(size_t i=0; i<events.size(); i++)
+		delete events[i];
+	return(rc);
+}
+
 void SegmentalMeanCorrection(std::vector<EventCluster *>& clusters) {
 	// identify the cluster which is copy number neutral
 	size_t closestClusterIdx = 0;
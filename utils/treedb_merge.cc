@@ -0,0 +1,357 @@
+/**
+ * @file treedb_merge.cc
+ * The source file for the utility 'treedb-merge', which concatenates the
+ * output databases of a sharded ssmain run (ssmain --shard i/N) into one
+ * database, identical to the output of a single run.
+ *
+ * @author Yi Qiao
+ */
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2013 Yi Qiao
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "DBConnection.h"
+#include "EventRegionIndex.h"
+#include <sqlite3/sqlite3.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdlib>
+#include <getopt.h>
+
+using namespace SubcloneSeeker;
+
+/**
+ * @brief A column holding the id of a record, in its own or in another table
+ */
+struct IDColumn {
+	const char *table; /**< the table the column belongs to */
+	const char *column; /**< the column name */
+	const char *refers; /**< the table whose ids the column holds */
+};
+
+/**
+ * All id columns of an ssmain output database. Trees.rootID refers to either
+ * Subclones or CompactTrees, depending on its encoding, and is handled apart.
+ */
+static const IDColumn IDColumns[] = {
+	{"Subclones", "id", "Subclones"},
+	{"Subclones", "parentId", "Subclones"},
+	{"Clusters", "id", "Clusters"},
+	{"Clusters", "ofSubcloneID", "Subclones"},
+	{"Events_CNV", "id", "Events_CNV"},
+	{"Events_CNV", "ofClusterID", "Clusters"},
+	{"Events_LOH", "id", "Events_LOH"},
+	{"Events_LOH", "ofClusterID", "Clusters"},
+	{"Events_SNP", "id", "Events_SNP"},
+	{"Events_SNP", "ofClusterID", "Clusters"},
+	{"SubcloneClusters", "subcloneID", "Subclones"},
+	{"SubcloneClusters", "clusterID", "Clusters"},
+	{"CompactTrees", "id", "CompactTrees"},
+	{"Trees", "id", "Trees"}
+};
+
+/**
+ * Whether a table holds clusters or events. In shared mode (ssmain -s, -c or -a)
+ * these are written up front, identically, by every shard.
+ */
+static bool isClusterTable(const std::string& table) {
+	return table == "Clusters" || table.compare(0, 7, "Events_") == 0;
+}
+
+/**
+ * Run a query returning a single integer
+ */
+static sqlite3_int64 queryInteger(sqlite3 *database, const std::string& sql) {
+	sqlite3_stmt *statement;
+	sqlite3_int64 value = 0;
+
+	if(sqlite3_prepare_v2(database, sql.c_str(), -1, &statement, 0) == SQLITE_OK &&
+			sqlite3_step(statement) == SQLITE_ROW)
+		value = sqlite3_column_int64(statement, 0);
+
+	sqlite3_finalize(statement);
+	return value;
+}
+
+/**
+ * Run a query and collect the text of its first column
+ */
+static std::vector<std::string> queryStrings(sqlite3 *database, const std::string& sql) {
+	sqlite3_stmt *statement;
+	std::vector<std::string> values;
+
+	if(sqlite3_prepare_v2(database, sql.c_str(), -1, &statement, 0) == SQLITE_OK) {
+		while(sqlite3_step(statement) == SQLITE_ROW)
+			values.push_back((const char *)sqlite3_column_text(statement, 0));
+	}
+
+	sqlite3_finalize(statement);
+	return values;
+}
+
+/**
+ * The column names of a table of the attached shard
+ */
+static std::vector<std::string> tableColumns(sqlite3 *database, const std::string& table) {
+	sqlite3_stmt *statement;
+	std::vector<std::string> columns;
+
+	std::string sql = "PRAGMA shard.table_info(" + table + ");";
+	if(sqlite3_prepare_v2(database, sql.c_str(), -1, &statement, 0) == SQLITE_OK) {
+		while(sqlite3_step(statement) == SQLITE_ROW)
+			columns.push_back((const char *)sqlite3_column_text(statement, 1));
+	}
+
+	sqlite3_finalize(statement);
+	return columns;
+}
+
+/**
+ * Run a statement, reporting errors
+ */
+static bool execute(sqlite3 *database, const std::string& sql) {
+	char *errmsg = NULL;
+	if(sqlite3_exec(database, sql.c_str(), 0, 0, &errmsg) != SQLITE_OK) {
+		std::cerr<<"Error: "<<(errmsg != NULL ? errmsg : "unknown")<<std::endl;
+		sqlite3_free(errmsg);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * The expression selecting a column of the attached shard, with its ids moved
+ * past those already in the merged database
+ */
+static std::string remappedColumn(const std::string& table, const std::string& column,
+		std::map<std::string, sqlite3_int64>& offsets) {
+	std::ostringstream expr;
+
+	if(table == "Trees" && column == "rootID") {
+		expr<<"CASE WHEN encoding = 1 THEN rootID + "<<offsets["CompactTrees"]
+			<<" ELSE rootID + "<<offsets["Subclones"]<<" END";
+		return expr.str();
+	}
+
+	for(size_t i=0; i<sizeof(IDColumns) / sizeof(IDColumns[0]); i++) {
+		if(table == IDColumns[i].table && column == IDColumns[i].column) {
+			// 0 and NULL stand for no record
+			expr<<"CASE WHEN "<<column<<" IS NULL OR "<<column<<" = 0 THEN "<<column
+				<<" ELSE "<<column<<" + "<<offsets[IDColumns[i].refers]<<" END";
+			return expr.str();
+		}
+	}
+
+	return column;
+}
+
+/**
+ * Append the content of one shard database to the merged database
+ *
+ * @param merged The merged database
+ * @param filename The shard database
+ * @param sharedClusters Receives, for the first shard holding trees, whether clusters are shared; checked against it for the others
+ * @param seenShared Whether sharedClusters has been set by an earlier shard
+ * @param regionIndexed Set if the shard has an event region index, which is rebuilt rather than merged
+ * @return false on error
+ */
+static bool appendShard(sqlite3 *merged, const char *filename, bool& sharedClusters, bool& seenShared, bool& regionIndexed) {
+	// attaching would create a missing file
+	std::ifstream shardFile(filename);
+	if(!shardFile.good()) {
+		std::cerr<<"Unable to open shard database "<<filename<<std::endl;
+		return false;
+	}
+
+	sqlite3_stmt *statement;
+	sqlite3_prepare_v2(merged, "ATTACH DATABASE ? AS shard;", -1, &statement, 0);
+	sqlite3_bind_text(statement, 1, filename, -1, SQLITE_TRANSIENT);
+	int rc = sqlite3_step(statement);
+	sqlite3_finalize(statement);
+	if(rc != SQLITE_DONE) {
+		std::cerr<<"Unable to attach shard database "<<filename<<std::endl;
+		return false;
+	}
+
+	bool success = execute(merged, "BEGIN TRANSACTION;");
+	std::vector<std::string> tables = queryStrings(merged,
+			"SELECT name FROM shard.sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite_%' "
+			"AND name NOT LIKE '%\\_Region%' ESCAPE '\\' ORDER BY rowid;");
+
+	if(queryInteger(merged, "SELECT COUNT(*) FROM shard.sqlite_master WHERE type='table' AND name LIKE '%\\_Region' ESCAPE '\\';") > 0)
+		regionIndexed = true;
+
+	// a shard that found no tree may hold no table at all
+	bool shared = false;
+	for(size_t i=0; i<tables.size(); i++)
+		shared = shared || tables[i] == "SubcloneClusters";
+
+	if(tables.size() > 0) {
+		if(seenShared && shared != sharedClusters) {
+			std::cerr<<"Shard "<<filename<<" was not written in the same mode as the previous ones"<<std::endl;
+			success = false;
+		}
+		sharedClusters = shared;
+		seenShared = true;
+	}
+
+	// create the tables met for the first time, together with their indices
+	for(size_t i=0; success && i<tables.size(); i++) {
+		if(queryInteger(merged, "SELECT COUNT(*) FROM main.sqlite_master WHERE type='table' AND name='" + tables[i] + "';") > 0)
+			continue;
+
+		std::vector<std::string> definitions = queryStrings(merged,
+				"SELECT sql FROM shard.sqlite_master WHERE tbl_name='" + tables[i] + "' AND type IN ('table', 'index') "
+				"AND sql IS NOT NULL ORDER BY type DESC, rowid;");
+		for(size_t j=0; success && j<definitions.size(); j++)
+			success = execute(merged, definitions[j]);
+	}
+
+	// records of this shard are numbered after those already merged, except for
+	// shared clusters, which are kept from the first shard together with their ids
+	std::map<std::string, sqlite3_int64> offsets;
+	std::map<std::string, bool> alreadyMerged;
+	for(size_t i=0; success && i<tables.size(); i++) {
+		if(tables[i] == "SubcloneClusters")
+			continue;
+
+		offsets[tables[i]] = queryInteger(merged, "SELECT IFNULL(MAX(id), 0) FROM main." + tables[i] + ";");
+		if(shared && isClusterTable(tables[i]) && offsets[tables[i]] > 0) {
+			alreadyMerged[tables[i]] = true;
+			offsets[tables[i]] = 0;
+		}
+	}
+
+	for(size_t i=0; success && i<tables.size(); i++) {
+		const std::string& table = tables[i];
+
+		if(alreadyMerged[table]) {
+			if(queryInteger(merged, "SELECT COUNT(*) FROM shard." + table + ";") !=
+					queryInteger(merged, "SELECT COUNT(*) FROM main." + table + ";")) {
+				std::cerr<<"Shard "<<filename<<" holds different clusters than the previous ones"<<std::endl;
+				success = false;
+			}
+			continue;
+		}
+
+		bool known = false;
+		for(size_t j=0; j<sizeof(IDColumns) / sizeof(IDColumns[0]); j++)
+			known = known || table == IDColumns[j].table;
+		if(!known)
+			std::cerr<<"Warning: table "<<table<<" is copied without renumbering"<<std::endl;
+
+		std::vector<std::string> columns = tableColumns(merged, table);
+
+		std::string columnList, selectList;
+		for(size_t j=0; j<columns.size(); j++) {
+			if(j > 0) {
+				columnList += ", ";
+				selectList += ", ";
+			}
+			columnList += columns[j];
+			selectList += remappedColumn(table, columns[j], offsets);
+		}
+
+		success = execute(merged, "INSERT INTO main." + table + " (" + columnList + ") SELECT " + selectList +
+				" FROM shard." + table + " ORDER BY rowid;");
+	}
+
+	execute(merged, success ? "COMMIT;" : "ROLLBACK;");
+	execute(merged, "DETACH DATABASE shard;");
+	return success;
+}
+
+void usage(const char *progName) {
+	std::cout<<"Usage: "<<progName<<" [Options] <merged-db> <shard-0-db> [shard-1-db ...]"<<std::endl;
+	std::cout<<"Merges the output databases of ssmain --shard 0/N .. N-1/N, given in shard order"<<std::endl;
+	std::cout<<"Options:"<<std::endl;
+	std::cout<<"\t-P <profile>\t\tConnection profile: default, bulk-write or read-analysis"<<std::endl;
+	std::cout<<"\t-h\t\t\tPrint this message"<<std::endl;
+	exit(0);
+}
+
+int main(int argc, char* argv[]) {
+	char *progName = argv[0];
+	DBConnection::Profile profile = DBConnection::PROFILE_DEFAULT;
+
+	int c;
+	while((c = getopt(argc, argv, "P:h")) != -1) {
+		switch(c) {
+			case 'P':
+				if(!DBConnection::profileFromName(optarg, profile)) {
+					std::cerr<<"Unknown connection profile "<<optarg<<std::endl;
+					usage(progName);
+				}
+				break;
+			case 'h':
+			default:
+				usage(progName);
+				break;
+		}
+	}
+
+	argc -= optind; argv += optind;
+
+	if(argc < 2) {
+		usage(progName);
+	}
+
+	sqlite3 *merged;
+	if(DBConnection::open(argv[0], &merged, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, profile) != SQLITE_OK) {
+		std::cerr<<"Unable to open database "<<argv[0]<<" for writing"<<std::endl;
+		return(1);
+	}
+
+	// ids are renumbered from those already present, so only start from scratch
+	if(queryInteger(merged, "SELECT COUNT(*) FROM sqlite_master;") > 0) {
+		std::cerr<<"Database "<<argv[0]<<" is not empty"<<std::endl;
+		sqlite3_close(merged);
+		return(1);
+	}
+
+	bool sharedClusters = false, seenShared = false, regionIndexed = false;
+	for(int i=1; i<argc; i++) {
+		if(!appendShard(merged, argv[i], sharedClusters, seenShared, regionIndexed)) {
+			sqlite3_close(merged);
+			return(1);
+		}
+	}
+
+	// the index of the events is built from scratch over the merged tables
+	if(regionIndexed && !EventRegionIndex::create(merged))
+		std::cerr<<"Unable to index the event regions of the merged database"<<std::endl;
+
+	// the same statistics as printed by ssmain
+	sqlite3_stmt *statement;
+	if(sqlite3_prepare_v2(merged, "SELECT COUNT(*), AVG(depth) FROM Trees;", -1, &statement, 0) == SQLITE_OK &&
+			sqlite3_step(statement) == SQLITE_ROW && sqlite3_column_int(statement, 0) > 0)
+		std::cout<<sqlite3_column_int(statement, 0)<<"\t"<<(float)sqlite3_column_double(statement, 1)<<std::endl;
+	sqlite3_finalize(statement);
+
+	sqlite3_close(merged);
+	return 0;
+}
@@ -45,56 +45,157 @@ THE SOFTWARE.
 #include "Subclone.h"
 #include "TreeNode.h"
 #include "treemerge_p.h"
+#include "DBConnection.h"
+#include "TreeSetFile.h"
+#include "ShardSpec.h"
+#include <cstdlib>
+#include <getopt.h>
 
 using namespace SubcloneSeeker;
 
+/**
+ * @brief A tree set, stored either in a subclone database or in a tree-set file
+ */
+struct TreeSetInput {
+	sqlite3 *database; /**< the database connection, NULL for a tree-set file */
+	TreeSetFile *treeSet; /**< the mapped tree-set file, NULL for a database */
+};
+
+/**
+ * Open a tree set, detecting tree-set files by their magic
+ */
+bool openTreeSetInput(const char *filename, TreeSetInput& input, DBConnection::Profile profile) {
+	input.database = NULL;
+	input.treeSet = NULL;
+
+	if(TreeSetFile::isTreeSetFile(filename)) {
+		input.treeSet = new TreeSetFile();
+		return input.treeSet->open(filename);
+	}
+	return DBConnection::open(filename, &input.database, SQLITE_OPEN_READONLY, profile) == SQLITE_OK;
+}
+
+/**
+ * Close a tree set opened by openTreeSetInput
+ */
+void closeTreeSetInput(TreeSetInput& input) {
+	if(input.database != NULL)
+		sqlite3_close(input.database);
+	delete input.treeSet;
+	input.database = NULL;
+	input.treeSet = NULL;
+}
+
+/**
+ * The root ids of all trees in a tree set
+ */
+DBObjectID_vec treeSetRootIDs(TreeSetInput& input) {
+	if(input.treeSet != NULL)
+		return input.treeSet->rootIDs();
+	return SubcloneLoadTreeTraverser::rootNodes(input.database);
+}
+
+/**
+ * Load a whole tree from a tree set, into an arena
+ */
+Subclone *loadTree(TreeSetInput& input, sqlite3_int64 rootID, ObjectArena& arena) {
+	if(input.treeSet != NULL)
+		return input.treeSet->expandTree(rootID, &arena);
+
+	return SubcloneLoadTreeTraverser::loadTree(input.database, rootID, &arena);
+}
+
 void usage(const char *prog_name) {
-	std::cout<<"Usage: "<<prog_name<<" <tree-set 1 database file> <tree-set 2 database file>"<<std::endl;
+	std::cout<<"Usage: "<<prog_name<<" [Options] <tree-set 1 database or tree-set file> <tree-set 2 database or tree-set file>"<<std::endl;
+	std::cout<<"Options:"<<std::endl;
+	std::cout<<"\t-P <profile>\t\tConnection profile: default, bulk-write or read-analysis"<<std::endl;
+	std::cout<<"\t--shard <i/N>\t\tOnly compare the i-th of N slices of the tree pairs (0 <= i < N)"<<std::endl;
+	std::cout<<"\t-h\t\t\tPrint this message"<<std::endl;
 	exit(0);
 }
 
 int main(int argc, char* argv[]) {
-	sqlite3 *ts1_db, *ts2_db;
 	int rc;
+	char *progName = argv[0];
+	DBConnection::Profile profile = DBConnection::PROFILE_DEFAULT;
+	ShardSpec shard;
+
+	enum {OPT_SHARD = 256};
+	static struct option longOptions[] = {
+		{"shard", required_argument, NULL, OPT_SHARD},
+		{NULL, 0, NULL, 0}
+	};
+
+	int c;
+	while((c = getopt_long(argc, argv, "P:h", longOptions, NULL)) != -1) {
+		switch(c) {
+			case 'P':
+				if(!DBConnection::profileFromName(optarg, profile)) {
+					std::cerr<<"Unknown connection profile "<<optarg<<std::endl;
+					usage(progName);
+				}
+				break;
+			case OPT_SHARD:
+				if(!shard.parse(optarg)) {
+					std::cerr<<"Invalid shard "<<optarg<<std::endl;
+					usage(progName);
+				}
+				break;
+			case 'h':
+			default:
+				usage(progName);
+				break;
+		}
+	}
+
+	// keep argv[1] and argv[2] as the two tree-set databases
+	argc -= optind - 1; argv += optind - 1;
 
 	if(argc < 3) {
-		usage(argv[0]);
+		usage(progName);
 	}
 
-	// ******** OPEN TREE-SET 1 DATABASE ********
-	if(sqlite3_open_v2(argv[1], &ts1_db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
+	// ******** OPEN TREE-SET 1 ********
+	TreeSetInput ts1, ts2;
+	if(!openTreeSetInput(argv[1], ts1, profile)) {
 		std::cerr<<"Unable to open tree-set 1 database file "<<argv[1]<<std::endl;
 		return(1);
 	}
-	DBObjectID_vec ts1RootIDs = SubcloneLoadTreeTraverser::rootNodes(ts1_db);
+	DBObjectID_vec ts1RootIDs = treeSetRootIDs(ts1);
 	std::cerr<<ts1RootIDs.size()<<" primary trees found!"<<std::endl;
 
-	// ******** OPEN TREE-SET 2 DATABASE ********
-	if(sqlite3_open_v2(argv[2], &ts2_db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
+	// ******** OPEN TREE-SET 2 ********
+	if(!openTreeSetInput(argv[2], ts2, profile)) {
 		std::cerr<<"Unable to open tree-set 2 database file "<<argv[2]<<std::endl;
 		return(1);
 	}
-	DBObjectID_vec ts2RootIDs = SubcloneLoadTreeTraverser::rootNodes(ts2_db);
+	DBObjectID_vec ts2RootIDs = treeSetRootIDs(ts2);
 	std::cerr<<ts2RootIDs.size()<<" secondary trees found!"<<std::endl;
 
-	SubcloneLoadTreeTraverser pLoadTraverser(ts1_db);
-	SubcloneLoadTreeTraverser sLoadTraverser(ts2_db);
+	// pairs are numbered row by row, so that the output of the shards, concatenated
+	// in order, is the output of a single run
+	uint64_t numPairs = (uint64_t)ts1RootIDs.size() * ts2RootIDs.size();
+
+	// both trees of a pair, and the nodes merging adds to the primary one, only
+	// live for the comparison; they are released together before the next pair
+	ObjectArena pairArena;
 
 	for(size_t i=0; i<ts1RootIDs.size(); i++) {
 		for(size_t j=0; j<ts2RootIDs.size(); j++) {
-			Subclone *pRoot = new Subclone();
-			pRoot->unarchiveObjectFromDB(ts1_db, ts1RootIDs[i]);
-			TreeNode::PreOrderTraverse(pRoot, pLoadTraverser);
+			if(!shard.owns((uint64_t)i * ts2RootIDs.size() + j, numPairs))
+				continue;
 
-			Subclone *sRoot = new Subclone();
-			sRoot->unarchiveObjectFromDB(ts2_db, ts2RootIDs[j]);
-			TreeNode::PreOrderTraverse(sRoot, sLoadTraverser);
+			Subclone *pRoot = loadTree(ts1, ts1RootIDs[i], pairArena);
+			Subclone *sRoot = loadTree(ts2, ts2RootIDs[j], pairArena);
 		
-			if(TreeMerge(pRoot, sRoot)) {
+			if(pRoot != NULL && sRoot != NULL && TreeMerge(pRoot, sRoot, &pairArena)) {
 				std::cout<<"Primary tree "<<pRoot->getId()<<" is compatible with Secondary tree "<<sRoot->getId()<<std::endl;
 			}
+			pairArena.reset();
 		}
 	}
 
+	closeTreeSetInput(ts1);
+	closeTreeSetInput(ts2);
 	return 0;
 }
@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "SomaticEvent.h"
 #include "SegmentalMutation.h"
 #include "EventCluster.h"
+#include "EventVisitor.h"
 #include "Subclone.h"
 
 /**
@@ -61,60 +62,33 @@ SomaticEventPtr_vec nodeEventsList(Subclone * node) {
 	SomaticEventPtr_vec subcloneEvents;
 	Subclone *wp = dynamic_cast<Subclone *>(node);
 	while(wp != NULL) {
-		for(size_t i=0; i<wp->vecEventCluster().size(); i++) {
-			for(size_t j=0; j<wp->vecEventCluster()[i]->members().size(); j++)
-				subcloneEvents.push_back(wp->vecEventCluster()[i]->members()[j]);
-		}
+		wp->appendEvents(subcloneEvents);
 		wp = dynamic_cast<Subclone *>(wp->getParent());
 	}
 	return subcloneEvents;
 }
 
-SomaticEventPtr_vec SomaticEventDifference(const SomaticEventPtr_vec& master, const SomaticEventPtr_vec& unwanted) {
-	SomaticEventPtr_vec differenceSet;
-	for(size_t i=0; i<master.size(); i++) {
-		// if member i is not found in unwanted, append it to result set
-		bool found = false;
-		for(size_t j=0; j<unwanted.size(); j++) {
-			if(master[i]->isEqualTo(unwanted[j], BOUNDRY_RESOLUTION)) {
-				found = true;
-				break;
-			}
-		}
-
-		if(!found) {
-			differenceSet.push_back(master[i]);
-		}
+SomaticEventPtr_vec SomaticEventDifference(const SomaticEventPtr_vec& master, const SomaticEventPtr_vec& unwanted, EventInterner * context) {
+	if(context == NULL) {
+		EventInterner interner(BOUNDRY_RESOLUTION);
+		return interner.difference(master, unwanted);
 	}
-	return differenceSet;
+	return context->difference(master, unwanted);
 }
 
 // Check if a somatic event vector contains all the events found in another vector
-bool eventSetContains(const SomaticEventPtr_vec& v_container, const SomaticEventPtr_vec& v_containee) {
+bool eventSetContains(const SomaticEventPtr_vec& v_container, const SomaticEventPtr_vec& v_containee, EventInterner * context) {
 	
 	// If the container vector is smaller than the containee vector,
 	// there is no way for the check to be true.
 	if(v_container.size() < v_containee.size())
 		return false;
 
-	// Loop through all the events in the containee vector, and check to see if it's contained
-	for(size_t i=0; i<v_containee.size(); i++) {
-		bool elementIsContained = false;
-		for(size_t j=0; j<v_container.size(); j++) {
-			// If the current element is contained, checks the next element
-			if(v_container[j]->isEqualTo(v_containee[i], BOUNDRY_RESOLUTION)) {
-				elementIsContained = true;
-				break;
-			}
-		}
-
-		// If the current element is not contained return false
-		if(!elementIsContained) {
-			return false;
-		}
+	if(context == NULL) {
+		EventInterner interner(BOUNDRY_RESOLUTION);
+		return interner.contains(v_container, v_containee);
 	}
-
-	return true;
+	return context->contains(v_container, v_containee);
 }
 
 // Compare SomaticEvent vectors by size
@@ -123,21 +97,17 @@ bool resultSetComparator(const SomaticEventPtr_vec& v1, const SomaticEventPtr_ve
 }
 
 // Check if a node with certain events can be placed on a subtree
-SomaticEventPtr_vec checkPlacement(Subclone *pnode, SomaticEventPtr_vec somaticEvents, bool * placeableOnSubtree, int * cp) {
+SomaticEventPtr_vec checkPlacement(Subclone *pnode, const SomaticEventPtr_vec& somaticEvents, bool * placeableOnSubtree, int * cp, ObjectArena * arena, EventInterner * context) {
 	SomaticEventPtr_vec pnodeEvents;
 	bool didPassContainment = true;
 
 	// All the events in pnode
-	for(size_t i=0; i<pnode->vecEventCluster().size(); i++) {
-		for(size_t j=0; j<pnode->vecEventCluster()[i]->members().size(); j++) {
-			pnodeEvents.push_back(pnode->vecEventCluster()[i]->members()[j]);
-		}
-	}
+	pnode->appendEvents(pnodeEvents);
 
 	// if pnode is not completely contained by somaticEvent, it cannot be placed under pnode
-	didPassContainment = eventSetContains(somaticEvents, pnodeEvents);
+	didPassContainment = eventSetContains(somaticEvents, pnodeEvents, context);
 	
-	SomaticEventPtr_vec eventDiff = SomaticEventDifference(somaticEvents, pnodeEvents);
+	SomaticEventPtr_vec eventDiff = SomaticEventDifference(somaticEvents, pnodeEvents, context);
 
 	if(pnode->isLeaf()) {
 		if(cp != NULL)
@@ -148,9 +118,9 @@ SomaticEventPtr_vec checkPlacement(Subclone *pnode, SomaticEventPtr_vec somaticE
 			*placeableOnSubtree = true;
 			
 			// Merging the secondary node onto the primary tree
-			Subclone * relExtNode = new Subclone();
+			Subclone * relExtNode = ObjectArena::create<Subclone>(arena);
 			relExtNode->setId(extSubId++);
-			EventCluster * relExtCluster = new EventCluster();
+			EventCluster * relExtCluster = ObjectArena::create<EventCluster>(arena);
 			for(size_t i=0; i<eventDiff.size(); i++) {
 				relExtCluster->addEvent(eventDiff[i]);
 			}
@@ -174,7 +144,7 @@ SomaticEventPtr_vec checkPlacement(Subclone *pnode, SomaticEventPtr_vec somaticE
 
 	for(size_t i=0; i<pnode->getVecChildren().size(); i++) {
 		bool childPlacable = false;
-		SomaticEventPtr_vec childEventDiff = checkPlacement(dynamic_cast<Subclone *>(pnode->getVecChildren()[i]), eventDiff, &childPlacable);
+		SomaticEventPtr_vec childEventDiff = checkPlacement(dynamic_cast<Subclone *>(pnode->getVecChildren()[i]), eventDiff, &childPlacable, NULL, arena, context);
 
 		if(childPlacable) {
 			numChildrenPlaceable++;
@@ -200,7 +170,7 @@ SomaticEventPtr_vec checkPlacement(Subclone *pnode, SomaticEventPtr_vec somaticE
 	// found on different branches, and is automatically a fail
 	size_t minChildEventDiffSetSize = childEventDiffSet[0].size();
 	for(size_t i=1; i<childEventDiffSet.size() && minChildEventDiffSetSize == childEventDiffSet[i].size(); i++) {
-		bool equalVector = eventSetContains(childEventDiffSet[0], childEventDiffSet[i]);
+		bool equalVector = eventSetContains(childEventDiffSet[0], childEventDiffSet[i], context);
 		if(not equalVector) {
 			*placeableOnSubtree = false;
 			return childEventDiffSet[0];
@@ -214,7 +184,7 @@ SomaticEventPtr_vec checkPlacement(Subclone *pnode, SomaticEventPtr_vec somaticE
 			// the returned eventSet of all children after symbol consumption are all the same as eventDiff
 			//
 			for(size_t i=0; i<childEventDiffSet.size(); i++) {
-				if(childEventDiffSet[i].size() != eventDiff.size() || !eventSetContains(eventDiff, childEventDiffSet[i])) {
+				if(childEventDiffSet[i].size() != eventDiff.size() || !eventSetContains(eventDiff, childEventDiffSet[i], context)) {
 					isCheckedOut = false;
 					break;
 				}
@@ -226,9 +196,9 @@ SomaticEventPtr_vec checkPlacement(Subclone *pnode, SomaticEventPtr_vec somaticE
 
 
 				// merge the secondary subclone onto the primary tree
-				Subclone * relExtNode = new Subclone();
+				Subclone * relExtNode = ObjectArena::create<Subclone>(arena);
 				relExtNode->setId(extSubId++);
-				EventCluster * relExtCluster = new EventCluster();
+				EventCluster * relExtCluster = ObjectArena::create<EventCluster>(arena);
 				for(size_t i=0; i<eventDiff.size(); i++) {
 					relExtCluster->addEvent(eventDiff[i]);
 				}
@@ -272,14 +242,14 @@ SomaticEventPtr_vec checkPlacement(Subclone *pnode, SomaticEventPtr_vec somaticE
 				for(size_t p=0; p<pnode->getVecChildren().size(); p++) {
 					Subclone *pExtNode = dynamic_cast<Subclone *>(pnode->getVecChildren()[p]);
 					SomaticEventPtr_vec eventChild = nodeEventsList(dynamic_cast<Subclone *>(pExtNode));
-					SomaticEventPtr_vec thisUniqueEvents = SomaticEventDifference(eventChild, eventDiff);
-					SomaticEventPtr_vec thisExtrudeEvents = SomaticEventDifference(eventChild, thisUniqueEvents);
-					SomaticEventPtr_vec otherUniqueEvents = SomaticEventDifference(eventDiff, eventChild);
+					SomaticEventPtr_vec thisUniqueEvents = SomaticEventDifference(eventChild, eventDiff, context);
+					SomaticEventPtr_vec thisExtrudeEvents = SomaticEventDifference(eventChild, thisUniqueEvents, context);
+					SomaticEventPtr_vec otherUniqueEvents = SomaticEventDifference(eventDiff, eventChild, context);
 
 					// if [eventChild] .intersect. [eventDiff] != []
 					if(thisExtrudeEvents.size() > 0) {
 						// check if [eventChild] - [eventDiff] == childEventDiffSet[0]
-						if(otherUniqueEvents.size() == childEventDiffSet[0].size() && eventSetContains(otherUniqueEvents, childEventDiffSet[0])) {
+						if(otherUniqueEvents.size() == childEventDiffSet[0].size() && eventSetContains(otherUniqueEvents, childEventDiffSet[0], context)) {
 							extrudeEvents = thisExtrudeEvents;
 							uniqueEvents = otherUniqueEvents;
 							extrudeNode = pExtNode;
@@ -291,10 +261,10 @@ SomaticEventPtr_vec checkPlacement(Subclone *pnode, SomaticEventPtr_vec somaticE
 					*placeableOnSubtree = true;
 
 					// Create the extruded subclone
-					Subclone * extrudedSubclone = new Subclone();
+					Subclone * extrudedSubclone = ObjectArena::create<Subclone>(arena);
 					extrudedSubclone->setId(extSubId++);
 					// Aggregate the extruded events into one cluster, and put it into the new subclone
-					EventCluster *extrudedCluster = new EventCluster();
+					EventCluster *extrudedCluster = ObjectArena::create<EventCluster>(arena);
 					for(size_t i=0; i<extrudeEvents.size(); i++) {
 						extrudedCluster->addEvent(extrudeEvents[i], false);
 					}
@@ -311,8 +281,9 @@ SomaticEventPtr_vec checkPlacement(Subclone *pnode, SomaticEventPtr_vec somaticE
 						// look for the cluster that contains extrudeEvents[j]
 						for(size_t j=0; j<extrudeNode->vecEventCluster().size(); j++) {
 							bool found = false;
-							for(size_t k=0; k<extrudeNode->vecEventCluster()[j]->members().size(); k++) {
-								if(extrudeNode->vecEventCluster()[j]->members()[k]->isEqualTo(extrudeEvents[i])) {
+							const SomaticEventPtr_vec& clusterEvents = extrudeNode->vecEventCluster()[j]->members();
+							for(size_t k=0; k<clusterEvents.size(); k++) {
+								if(eventsEqual(clusterEvents[k], extrudeEvents[i], 10000L)) {
 									found = true;
 									break;
 								}
@@ -331,9 +302,9 @@ SomaticEventPtr_vec checkPlacement(Subclone *pnode, SomaticEventPtr_vec somaticE
 					pnode->addChild(extrudedSubclone);
 
 					// Also the merged relapse tree needs to be recorded to prevent future incorrect extrusion
-					Subclone * relExtNode = new Subclone();
+					Subclone * relExtNode = ObjectArena::create<Subclone>(arena);
 					relExtNode->setId(extSubId++);
-					EventCluster * relExtCluster = new EventCluster();
+					EventCluster * relExtCluster = ObjectArena::create<EventCluster>(arena);
 					for(size_t i=0; i<uniqueEvents.size(); i++) {
 						relExtCluster->addEvent(uniqueEvents[i]);
 					}
@@ -351,7 +322,7 @@ SomaticEventPtr_vec checkPlacement(Subclone *pnode, SomaticEventPtr_vec somaticE
 			// moreover, it must yield the most symbol consumption, because other subtrees will not be able to consume
 			// the symbols specifically found in the placeable child node.
 			for(size_t i=1; i<childEventDiffSet.size(); i++) {
-				if(!eventSetContains(childEventDiffSet[i], childEventDiffSet[0])) {
+				if(!eventSetContains(childEventDiffSet[i], childEventDiffSet[0], context)) {
 					isCheckedOut = false;
 					break;
 				}
@@ -377,6 +348,8 @@ SomaticEventPtr_vec checkPlacement(Subclone *pnode, SomaticEventPtr_vec somaticE
 class TreeMergeTraverseSecondary : public TreeTraverseDelegate {
 	protected:
 		Subclone *_proot; /**< The root of the primary tree */
+		ObjectArena *_arena; /**< The arena the nodes added to the primary tree are made in */
+		EventInterner _interner; /**< The dense ids of the events of both trees */
 
 	public:
 		bool isCompatible; /**< Whether two trees are compatible or not. */
@@ -385,8 +358,9 @@ class TreeMergeTraverseSecondary : public TreeTraverseDelegate {
 		 * Constructor of the TreeMergeTraverseSecondary class
 		 *
 		 * @param proot To which primary tree are all the secondary nodes being placed on
+		 * @param arena In which arena are the placed nodes made, NULL for the heap
 		 */
-		TreeMergeTraverseSecondary(Subclone *proot): TreeTraverseDelegate(), _proot(proot), isCompatible(true) {;}
+		TreeMergeTraverseSecondary(Subclone *proot, ObjectArena *arena = NULL): TreeTraverseDelegate(), _proot(proot), _arena(arena), _interner(BOUNDRY_RESOLUTION), isCompatible(true) {;}
 
 		void processNode(TreeNode *node) {
 			bool placeable;
@@ -403,7 +377,7 @@ class TreeMergeTraverseSecondary : public TreeTraverseDelegate {
 
 			SomaticEventPtr_vec subcloneEvents = nodeEventsList(wp);
 
-			SomaticEventPtr_vec diff = checkPlacement(_proot, subcloneEvents, &placeable);
+			SomaticEventPtr_vec diff = checkPlacement(_proot, subcloneEvents, &placeable, NULL, _arena, &_interner);
 			if(!placeable) {
 				isCompatible = false;
 				terminate();
@@ -413,8 +387,8 @@ class TreeMergeTraverseSecondary : public TreeTraverseDelegate {
 
 
 // Check if two trees are compatible
-bool TreeMerge(Subclone *p, Subclone *q) {
-	TreeMergeTraverseSecondary secondaryTraverser(p);
+bool TreeMerge(Subclone *p, Subclone *q, ObjectArena *arena) {
+	TreeMergeTraverseSecondary secondaryTraverser(p, arena);
 	TreeNode::PreOrderTraverse(q, secondaryTraverser);
 
 	return secondaryTraverser.isCompatible;
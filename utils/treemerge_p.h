@@ -38,6 +38,7 @@ THE SOFTWARE.
 
 #include "SomaticEvent.h"
 #include "Subclone.h"
+#include "EventInterner.h"
 
 /**
  * The boundary resolution when comparing SomaticEvents
@@ -62,22 +63,26 @@ SomaticEventPtr_vec nodeEventsList(Subclone * node);
  *
  * @param master The somatic event vector that contains the wanted events
  * @param unwanted The somatic event vector that contains the unwanted events
+ * @param context The interner of the compared trees, a temporary one if NULL
  * @return A somatic event vector that contains all the events in 'master' that are not found in 'unwanted'
  */
 SomaticEventPtr_vec SomaticEventDifference(
 		const SomaticEventPtr_vec& master, 
-		const SomaticEventPtr_vec& unwanted);
+		const SomaticEventPtr_vec& unwanted,
+		EventInterner * context = NULL);
 
 /**
  * Check if a somatic event vector contains all the events found in another vector.
  *
  * @param v_container The container vector
  * @param v_containee The containee vector
+ * @param context The interner of the compared trees, a temporary one if NULL
  * @return True if the container vector contains all the events found in the containee vector, false otherwise
  */
 bool eventSetContains(
 		const SomaticEventPtr_vec& v_container, 
-		const SomaticEventPtr_vec& v_containee);
+		const SomaticEventPtr_vec& v_containee,
+		EventInterner * context = NULL);
 
 /**
  * Compare SomaticEvent vectors by size.
@@ -95,20 +100,25 @@ bool resultSetComparator(const SomaticEventPtr_vec& v1, const SomaticEventPtr_ve
  * @param somaticEvents The somatic events found in the new node, containing all its parents' ones.
  * @param placeableOnSubtree An output boolean variable indicating whether the placement is successful or not.
  * @param cp The number of children nodes that are able to contain the floating node. Used for debugging purpose.
+ * @param arena The arena the nodes and clusters added to the primary tree are made in, NULL for the heap
+ * @param context The interner of the compared trees, a temporary one if NULL
  * @return A vector containing events not found on the subtree to the point the node is placed.
  */
 SomaticEventPtr_vec checkPlacement(
 		Subclone *pnode, 
-		SomaticEventPtr_vec somaticEvents, 
+		const SomaticEventPtr_vec& somaticEvents, 
 		bool * placeableOnSubtree,
-		int * cp = NULL);
+		int * cp = NULL,
+		ObjectArena * arena = NULL,
+		EventInterner * context = NULL);
 
 /**
  * Check if two subclonal trees are compatible.
  *
  * @param p The first subclone tree
  * @param q The second subclone tree
+ * @param arena The arena the nodes and clusters added to the first tree are made in, NULL for the heap
  * @return True if the two trees are compatible, false otherwise
  */
-bool TreeMerge(Subclone *p, Subclone *q);
+bool TreeMerge(Subclone *p, Subclone *q, ObjectArena *arena = NULL);
 #endif
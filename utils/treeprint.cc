@@ -32,6 +32,14 @@ THE SOFTWARE.
 #include "Archivable.h"
 #include "Subclone.h"
 #include "EventCluster.h"
+#include "CompactTree.h"
+#include "TreeSummary.h"
+#include "DBConnection.h"
+#include "TreeSetFile.h"
+#include "MemoryBackend.h"
+#include "EventRegionIndex.h"
+#include "LazyTreeLoader.h"
+#include "CohortDB.h"
 #include <sqlite3/sqlite3.h>
 #include <iostream>
 #include <cstdio>
@@ -42,10 +50,21 @@ THE SOFTWARE.
 
 using namespace SubcloneSeeker;
 
-enum {RUN_MODE_LIST, RUN_MODE_PRINT} runMode;
+enum {RUN_MODE_LIST, RUN_MODE_PRINT, RUN_MODE_REGION} runMode;
 enum {OUT_FORMAT_TEXT, OUT_FORMAT_GVIZ} outputMode;
 int isRootIDSpecified;
 int32_t rootID;
+int isCompactDB;
+TreeSetFile *treeSet;
+StorageBackend *archive;
+int hasTreeSummaries;
+int listSummaries;
+std::string sortKey = "rootID";
+int maxDepth;
+int maxNodeCount;
+DBConnection::Profile profile;
+GenomicRange queryRange;
+const char *sample;
 
 // Traverser borrowed from SubcloneExplore.cc
 /**
@@ -111,15 +130,72 @@ class EdgePrintTraverser: public TreeTraverseDelegate {
  * @param progName the string containing the name of the executable
  */
 void usage(const char* progName) {
-	std::cout<<"Usage: "<<progName<<" [Options] <sqlite-db-file>"<<std::endl;
+	std::cout<<"Usage: "<<progName<<" [Options] <sqlite-db-file, binary archive or tree-set file>"<<std::endl;
 	std::cout<<"Options:"<<std::endl;
 	std::cout<<"\t-l\t\t\tList all root subclone IDs"<<std::endl;
+	std::cout<<"\t-v\t\t\tWith -l, also list node count, depth, leaf count and score"<<std::endl;
+	std::cout<<"\t-o <key>\t\tWith -l, sort by rootID, nodeCount, depth, leafCount or score"<<std::endl;
+	std::cout<<"\t-d <max-depth>\t\tWith -l, only list trees not deeper than the given depth"<<std::endl;
+	std::cout<<"\t-n <max-nodes>\t\tWith -l, only list trees with at most the given number of nodes"<<std::endl;
 	std::cout<<"\t-r <subclone-id>\tOnly output the subclone structure rooted with the given id"<<std::endl;
 	std::cout<<"\t-g\t\t\tOutput in graphviz format"<<std::endl;
+	std::cout<<"\t-q <chrom:start-end>\tList the events overlapping a region, from the index built by ssmain -R"<<std::endl;
+	std::cout<<"\t-P <profile>\t\tConnection profile: default, bulk-write or read-analysis"<<std::endl;
+	std::cout<<"\t-k <sample>\t\tOnly read the given sample of a cohort database"<<std::endl;
 	std::cout<<"\t-h\t\t\tPrint this message"<<std::endl;
 	exit(0);
 }
 
+/**
+ * @brief Find the root of the tree a subclone belongs to
+ *
+ * @param database An live sqlite3 database connection, with a Subclones table
+ * @param subcloneID The id of the subclone
+ * @return the root id, 0 if the subclone is not found
+ */
+sqlite3_int64 rootOfSubclone(sqlite3 *database, sqlite3_int64 subcloneID) {
+	sqlite3_stmt *statement;
+	if(sqlite3_prepare_v2(database, "SELECT parentId FROM Subclones WHERE id=?;", -1, &statement, 0) != SQLITE_OK) {
+		sqlite3_finalize(statement);
+		return 0;
+	}
+
+	sqlite3_int64 rootID = 0;
+	while(subcloneID != 0) {
+		sqlite3_bind_int64(statement, 1, subcloneID);
+		if(sqlite3_step(statement) != SQLITE_ROW) {
+			rootID = 0;
+			break;
+		}
+		rootID = subcloneID;
+		subcloneID = sqlite3_column_int64(statement, 0);
+		sqlite3_reset(statement);
+	}
+
+	sqlite3_finalize(statement);
+	return rootID;
+}
+
+/**
+ * @brief List the events overlapping queryRange, with the subclone and the tree they belong to
+ *
+ * @param database An live sqlite3 database connection, with a region index
+ */
+void listRegionEvents(sqlite3 *database) {
+	std::vector<EventRegionIndex::Hit> hits;
+	if(database == NULL || !EventRegionIndex::overlapping(database, queryRange, hits)) {
+		std::cerr<<"The database has no event region index, see ssmain -R"<<std::endl;
+		return;
+	}
+
+	for(size_t i=0; i<hits.size(); i++) {
+		std::cout<<hits[i].eventTable<<"\t"<<hits[i].eventID<<"\t"<<hits[i].clusterID<<"\t"<<hits[i].subcloneID;
+		if(!isCompactDB)
+			std::cout<<"\t"<<rootOfSubclone(database, hits[i].subcloneID);
+		std::cout<<std::endl;
+	}
+}
+
 /**
  * @brief List all root subclone IDs
  *
@@ -127,27 +203,50 @@ void usage(const char* progName) {
  */
 void listRootIDs(sqlite3* database) {
 
-	DBObjectID_vec rootIDs = SubcloneLoadTreeTraverser::rootNodes(database);
+	// databases with tree summaries are listed by a single query
+	if(hasTreeSummaries) {
+		std::vector<TreeSummary *> summaries = TreeSummary::summariesFromDB(database, sortKey, maxDepth, maxNodeCount);
+		for(size_t i=0; i<summaries.size(); i++) {
+			std::cout<<summaries[i]->rootID();
+			if(listSummaries) {
+				std::cout<<"\t"<<summaries[i]->nodeCount()<<"\t"<<summaries[i]->depth()<<"\t"<<summaries[i]->leafCount()<<"\t";
+				if(summaries[i]->hasScore())
+					std::cout<<summaries[i]->score();
+				else
+					std::cout<<"NA";
+			}
+			std::cout<<std::endl;
+			delete summaries[i];
+		}
+		return;
+	}
+
+	if(listSummaries || sortKey != "rootID" || maxDepth > 0 || maxNodeCount > 0)
+		std::cerr<<"No tree summaries in the database, listing all trees unsorted"<<std::endl;
+
+	DBObjectID_vec rootIDs;
+	if(treeSet != NULL)
+		rootIDs = treeSet->rootIDs();
+	else if(isCompactDB) {
+		CompactTree dummyTree;
+		rootIDs = dummyTree.vecAllObjectsID(database);
+	}
+	else if(archive != NULL)
+		rootIDs = SubcloneLoadTreeTraverser::rootNodes(*archive);
+	else
+		rootIDs = SubcloneLoadTreeTraverser::rootNodes(database);
+
 	for(DBObjectID_vec::iterator it = rootIDs.begin(); it != rootIDs.end(); it++) {
 		std::cout<<*it<<std::endl;
 	}
 }
 
 /**
- * @brief Print details about a subclone structure
- * The structure contains the given root, and all its descendent nodes
+ * @brief Print a subclone structure in the selected output format
  *
- * @param database An live sqlite3 database connection
- * @param rootID The id of the root node for which the structure is printed
+ * @param root The root node of the structure
  */
-void printSubcloneWithID(sqlite3* database, int32_t rootID) {
-	Subclone *root = new Subclone();
-
-	root->unarchiveObjectFromDB(database, rootID);
-
-	SubcloneLoadTreeTraverser loadTr(database);
-	TreeNode::PreOrderTraverse(root, loadTr);
-
+void printTree(Subclone *root) {
 	if(outputMode == OUT_FORMAT_TEXT) {
 		TreePrintTraverser traverser;
 		TreeNode::PreOrderTraverse(root, traverser);
@@ -166,16 +265,103 @@ void printSubcloneWithID(sqlite3* database, int32_t rootID) {
 	std::cout<<std::endl;
 }
 
+/**
+ * @brief Free a printed subclone structure
+ *
+ * @param root The root node of the structure
+ */
+void freeTree(Subclone *root) {
+	// clusters of expanded tree-set trees belong to the tree-set file
+	SubcloneFreeTreeTraverser freeTr(treeSet == NULL);
+	TreeNode::PostOrderTraverse(root, freeTr);
+}
+
+/**
+ * @brief Print details about a subclone structure
+ * The structure contains the given root, and all its descendent nodes
+ *
+ * @param database An live sqlite3 database connection
+ * @param rootID The id of the root node for which the structure is printed
+ */
+void printSubcloneWithID(sqlite3* database, int32_t rootID) {
+	Subclone *root;
+
+	if(treeSet != NULL) {
+		root = treeSet->expandTree(rootID);
+		if(root == NULL)
+			return;
+	}
+	else if(isCompactDB) {
+		// the whole tree is one record, expanded on demand
+		CompactTree compactTree;
+		if(!compactTree.unarchiveObjectFromDB(database, rootID))
+			return;
+		root = compactTree.expandTree(database);
+	}
+	else if(archive != NULL) {
+		root = new Subclone();
+		if(!root->unarchiveObject(*archive, rootID)) {
+			delete root;
+			return;
+		}
+
+		SubcloneLoadTreeTraverser loadTr(*archive);
+		TreeNode::PreOrderTraverse(root, loadTr);
+	}
+	else {
+		// printing reads the nodes only, never their clusters and events
+		LazyTreeLoader loader(database);
+		root = loader.subclone(rootID);
+		if(root != NULL)
+			printTree(root);
+		return;
+	}
+
+	printTree(root);
+	freeTree(root);
+}
+
 /**
  * @brief Print all subclone structures
  *
+ * Trees stored in a database are streamed through a cursor, and freed once
+ * printed, so that only one tree is held in memory at a time.
+ *
  * @param database An live sqlite3 database connection
  */
 void printAllSubclones(sqlite3* database) {
 
-	DBObjectID_vec rootIDs = SubcloneLoadTreeTraverser::rootNodes(database);
-	for(DBObjectID_vec::iterator it = rootIDs.begin(); it != rootIDs.end(); it++) {
-		printSubcloneWithID(database, *it);
+	if(treeSet != NULL || archive != NULL) {
+		DBObjectID_vec rootIDs;
+		if(treeSet != NULL)
+			rootIDs = treeSet->rootIDs();
+		else
+			rootIDs = SubcloneLoadTreeTraverser::rootNodes(*archive);
+
+		for(DBObjectID_vec::iterator it = rootIDs.begin(); it != rootIDs.end(); it++) {
+			printSubcloneWithID(database, *it);
+		}
+	}
+	else if(isCompactDB) {
+		ArchiveCursor<CompactTree> cursor(database);
+		CompactTree compactTree;
+		while(cursor.next(compactTree)) {
+			Subclone *root = compactTree.expandTree(database);
+			if(root == NULL)
+				continue;
+			printTree(root);
+			freeTree(root);
+		}
+	}
+	else {
+		ArchiveCursor<Subclone> cursor(database, "parentId IS NULL");
+		Subclone root;
+		while(cursor.next(root)) {
+			LazyTreeLoader loader(database);
+			Subclone *lazyRoot = loader.subclone(root.getId());
+			if(lazyRoot != NULL)
+				printTree(lazyRoot);
+		}
 	}
 }
 
@@ -191,12 +377,28 @@ int main(int argc, char* argv[]) {
 	isRootIDSpecified = 0;
 
 	int c;
-	while((c = getopt(argc, argv, "lgr:h")) != -1) {
+	while((c = getopt(argc, argv, "lvo:d:n:gr:q:P:k:h")) != -1) {
 		switch(c)
 		{
 			case 'l':
 				runMode = RUN_MODE_LIST;
 				break;
+			case 'v':
+				listSummaries = 1;
+				break;
+			case 'o':
+				sortKey = optarg;
+				if(!TreeSummary::isSortKey(sortKey)) {
+					std::cerr<<"Unknown sort key "<<optarg<<std::endl;
+					usage(argv[0]);
+				}
+				break;
+			case 'd':
+				maxDepth = atoi(optarg);
+				break;
+			case 'n':
+				maxNodeCount = atoi(optarg);
+				break;
 			case 'g':
 				outputMode = OUT_FORMAT_GVIZ;
 				break;
@@ -204,6 +406,27 @@ int main(int argc, char* argv[]) {
 				isRootIDSpecified = 1;
 				rootID = atoi(optarg);
 				break;
+			case 'q':
+				{
+					unsigned long start, end;
+					if(sscanf(optarg, "%d:%lu-%lu", &queryRange.chrom, &start, &end) != 3 || end < start) {
+						std::cerr<<"Invalid region "<<optarg<<std::endl;
+						usage(argv[0]);
+					}
+					queryRange.position = start;
+					queryRange.length = end - start;
+					runMode = RUN_MODE_REGION;
+				}
+				break;
+			case 'P':
+				if(!DBConnection::profileFromName(optarg, profile)) {
+					std::cerr<<"Unknown connection profile "<<optarg<<std::endl;
+					usage(argv[0]);
+				}
+				break;
+			case 'k':
+				sample = optarg;
+				break;
 			case 'h':
 				usage(argv[0]);
 				break;
@@ -219,12 +442,40 @@ int main(int argc, char* argv[]) {
 		usage(argv[0]);
 	}
 
-	sqlite3 *database;
+	sqlite3 *database = NULL;
 	int rc;
 
-	if(sqlite3_open_v2(argv[optind], &database, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
-		std::cerr<<"Unable to open database "<<argv[optind]<<std::endl;
-		return(1);
+	// tree-set files are mapped instead of being opened as a database
+	if(TreeSetFile::isTreeSetFile(argv[optind])) {
+		treeSet = new TreeSetFile();
+		if(!treeSet->open(argv[optind])) {
+			std::cerr<<"Unable to open tree-set file "<<argv[optind]<<std::endl;
+			return(1);
+		}
+	}
+	else if(BinaryFileBackend::isBackendFile(argv[optind])) {
+		archive = StorageBackend::open(argv[optind], StorageBackend::KIND_FILE, true);
+		if(archive == NULL) {
+			std::cerr<<"Unable to open archive "<<argv[optind]<<std::endl;
+			return(1);
+		}
+	}
+	else {
+		if(DBConnection::open(argv[optind], &database, SQLITE_OPEN_READONLY, profile) != SQLITE_OK) {
+			std::cerr<<"Unable to open database "<<argv[optind]<<std::endl;
+			return(1);
+		}
+
+		if(sample != NULL && !CohortDB::enterSample(database, sample)) {
+			std::cerr<<"Sample "<<sample<<" not found in "<<argv[optind]<<std::endl;
+			return(1);
+		}
+
+		// databases written in the compact format have no Subclones table
+		isCompactDB = SubcloneLoadTreeTraverser::isCompactDB(database);
+
+		TreeSummary dummySummary;
+		hasTreeSummaries = dummySummary.tableExistsInDB(database);
 	}
 
 	switch(runMode)
@@ -239,9 +490,16 @@ int main(int argc, char* argv[]) {
 			else {
 				printAllSubclones(database);
 			}
+			break;
+		case RUN_MODE_REGION:
+			listRegionEvents(database);
+			break;
 	}
 
-	sqlite3_close(database);
+	if(database != NULL)
+		sqlite3_close(database);
+	delete treeSet;
+	delete archive;
 	
 	return 0;
 }
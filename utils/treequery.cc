@@ -0,0 +1,67 @@
+/**
+ * @file treedb_merge.cc
+ * The source file for the utility 'treedb-merge', which concatenates the
+ * output databases of a sharded ssmain run (ssmain --shard i/N) into one
+ * database, identical to the output of a single run.
+ *
+ * @author Yi Qiao
+ */
+
+#include "ViableTreesTable.h"
+#include <sqlite3/sqlite3.h>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+using namespace SubcloneSeeker;
+
+void usage(const char *progName) {
+	std::cerr<<"Usage: "<<progName<<" <cluster-archive-sqlite-db> <sql>"<<std::endl;
+	std::cerr<<"Run an SQL query over the viable trees of a cluster database, without storing them."<<std::endl;
+	std::cerr<<"The trees are the rows of table viable_trees(tree_id, node, parent, depth, fraction,"<<std::endl;
+	std::cerr<<"tree_fraction, cluster_id, tree_depth), see ViableTreesTable.h. For example,"<<std::endl;
+	std::cerr<<"\t"<<progName<<" c.sqlite 'SELECT tree_depth, COUNT(DISTINCT tree_id) FROM viable_trees GROUP BY 1'"<<std::endl;
+	exit(0);
+}
+
+/**
+ * Print each result row on a line, with tab separated columns
+ */
+static int printRow(void *, int argc, char **argv, char **) {
+	for(int i=0; i<argc; i++) {
+		if(i > 0)
+			std::cout<<"\t";
+		std::cout<<(argv[i] == NULL ? "" : argv[i]);
+	}
+	std::cout<<std::endl;
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc != 3)
+		usage(argv[0]);
+
+	sqlite3 *database;
+	if(sqlite3_open(":memory:", &database) != SQLITE_OK || !ViableTreesTable::registerModule(database)) {
+		std::cerr<<"Unable to set up the query database"<<std::endl;
+		return 1;
+	}
+
+	char *quoted = sqlite3_mprintf("CREATE VIRTUAL TABLE temp.viable_trees USING %s(%Q);",
+			ViableTreesTable::ModuleName, argv[1]);
+	std::string create(quoted);
+	sqlite3_free(quoted);
+
+	char *errMsg = NULL;
+	if(sqlite3_exec(database, create.c_str(), NULL, NULL, &errMsg) != SQLITE_OK ||
+			sqlite3_exec(database, argv[2], printRow, NULL, &errMsg) != SQLITE_OK) {
+		std::cerr<<errMsg<<std::endl;
+		sqlite3_free(errMsg);
+		sqlite3_close(database);
+		return 1;
+	}
+
+	sqlite3_close(database);
+	return 0;
+}